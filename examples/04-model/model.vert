@@ -9,14 +9,14 @@ layout (location = 0) out vec3 outPos;
 layout (location = 1) out vec2 outUv;
 layout (location = 2) out vec3 outNormal;
 
-layout (set = 0, binding = 0) uniform UBO {
+layout (push_constant) uniform Transform {
     mat4 proj;
     mat4 model;
-} ubo;
+} transform;
 
 void main(){
-    gl_Position = ubo.proj * ubo.model * vec4(inPos, 1.0);
-    outPos = vec3(ubo.model * vec4(inPos, 1.0));
+    gl_Position = transform.proj * transform.model * vec4(inPos, 1.0);
+    outPos = vec3(transform.model * vec4(inPos, 1.0));
     outUv = inUv;
-    outNormal = mat3(transpose(inverse(ubo.model))) * inNormal;
+    outNormal = mat3(transpose(inverse(transform.model))) * inNormal;
 }
\ No newline at end of file
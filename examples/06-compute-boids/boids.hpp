@@ -0,0 +1,64 @@
+#pragma once
+
+#include <shard/gfx/gfx.hpp>
+#include <shard/gfx/gpu/spatialHash.hpp>
+#include <shard/job/threadPool.hpp>
+
+struct ComputeData{
+    alignas(4)  float      deltaTime;
+    alignas(4)  float      rotationSpeed;
+    alignas(4)  float      boidSpeed;
+    alignas(4)  float      boidSpeedVariation;
+    alignas(8)  glm::vec2  flockPosition;
+    alignas(4)  float      neighbourDistance;
+    alignas(4)  float      inverseCellSize;
+    alignas(8)  glm::vec2  time;
+};
+// Matches the std140 layout of the shaders' Boid
+struct Boid{
+    alignas(8)  glm::vec2    position;
+    alignas(8)  glm::vec2    direction;
+    alignas(4)  float        noiseOffset;
+    alignas(16) glm::vec3    color;
+};
+static_assert(sizeof(Boid) == 48);
+const uint32_t BOID_STRIDE = sizeof(Boid) / sizeof(float);
+
+// CPU backend of boids.comp for machines without a usable compute queue, and an
+// oracle for the GPU kernel. Boids are kept as a structure of arrays, neighbours
+// come from a SpatialHash::Reference grid and are tested 8 (AVX2, with
+// SHARD_BOIDS_AVX2), 4 (NEON) or 1 at a time, boids are split over a thread pool.
+class CpuBoids{
+    public:
+        // tableSize must match the GPU SpatialHash for identical neighbour buckets
+        CpuBoids(const std::vector<Boid>& boids, uint32_t _tableSize, uint32_t threadCount = 0);
+
+        // Advances one step of boids.comp reading the previous state only. The boids
+        // are also written to out when given, such as a mapped storage Buffer.
+        void step(const ComputeData& data, uint32_t maxNeighbours, Boid* out = nullptr);
+
+        Boid boid(uint32_t i) const;
+        uint32_t count() const { return uint32_t(noiseOffset.size()); }
+
+        static const char* simdName();
+    private:
+        struct State{
+            std::vector<float> x, y;
+            std::vector<float> dirX, dirY;
+        };
+
+        void sortByBucket();
+
+        State current;
+        State next;
+        std::vector<float> noiseOffset;
+
+        // The current state ordered by bucket so candidates are contiguous, padded
+        // by a vector width
+        State sorted;
+        std::vector<uint32_t> sortedPosition;
+
+        uint32_t tableSize;
+        shard::gfx::gpu::SpatialHash::Reference grid;
+        shard::job::ThreadPool pool;
+};
\ No newline at end of file
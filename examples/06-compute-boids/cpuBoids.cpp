@@ -0,0 +1,246 @@
+#include "boids.hpp"
+
+#include <bit>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace simd{
+#if defined(__AVX2__)
+    constexpr uint32_t WIDTH = 8;
+    using Float = __m256;
+
+    inline Float load(const float* p){ return _mm256_loadu_ps(p); }
+    inline Float set(float v){ return _mm256_set1_ps(v); }
+    inline Float add(Float a, Float b){ return _mm256_add_ps(a, b); }
+    inline Float sub(Float a, Float b){ return _mm256_sub_ps(a, b); }
+    inline Float mul(Float a, Float b){ return _mm256_mul_ps(a, b); }
+    inline Float div(Float a, Float b){ return _mm256_div_ps(a, b); }
+    inline Float sqrt(Float a){ return _mm256_sqrt_ps(a); }
+    inline Float clamp01(Float a){ return _mm256_min_ps(_mm256_max_ps(a, set(0.0f)), set(1.0f)); }
+    // Lane i is bit i
+    inline uint32_t lessThan(Float a, Float b){ return uint32_t(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LT_OQ))); }
+    // Zeroes the lanes whose bit is clear
+    inline Float select(uint32_t bits, Float a){
+        const __m256i lanes = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+        __m256i mask = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(int(bits)), lanes), lanes);
+        return _mm256_and_ps(_mm256_castsi256_ps(mask), a);
+    }
+    inline float sum(Float a){
+        __m128 v = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+        v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+        v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+        return _mm_cvtss_f32(v);
+    }
+    constexpr const char* NAME = "AVX2";
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    constexpr uint32_t WIDTH = 4;
+    using Float = float32x4_t;
+
+    inline Float load(const float* p){ return vld1q_f32(p); }
+    inline Float set(float v){ return vdupq_n_f32(v); }
+    inline Float add(Float a, Float b){ return vaddq_f32(a, b); }
+    inline Float sub(Float a, Float b){ return vsubq_f32(a, b); }
+    inline Float mul(Float a, Float b){ return vmulq_f32(a, b); }
+    inline Float div(Float a, Float b){ return vdivq_f32(a, b); }
+    inline Float sqrt(Float a){ return vsqrtq_f32(a); }
+    inline Float clamp01(Float a){ return vminq_f32(vmaxq_f32(a, set(0.0f)), set(1.0f)); }
+    inline uint32_t lessThan(Float a, Float b){
+        const uint32_t laneBits[] = {1, 2, 4, 8};
+        uint32x4_t mask = vandq_u32(vcltq_f32(a, b), vld1q_u32(laneBits));
+        return vaddvq_u32(mask);
+    }
+    inline Float select(uint32_t bits, Float a){
+        const uint32_t laneBits[] = {1, 2, 4, 8};
+        uint32x4_t mask = vtstq_u32(vdupq_n_u32(bits), vld1q_u32(laneBits));
+        return vreinterpretq_f32_u32(vandq_u32(mask, vreinterpretq_u32_f32(a)));
+    }
+    inline float sum(Float a){ return vaddvq_f32(a); }
+    constexpr const char* NAME = "NEON";
+#else
+    constexpr uint32_t WIDTH = 1;
+    using Float = float;
+
+    inline Float load(const float* p){ return *p; }
+    inline Float set(float v){ return v; }
+    inline Float add(Float a, Float b){ return a + b; }
+    inline Float sub(Float a, Float b){ return a - b; }
+    inline Float mul(Float a, Float b){ return a * b; }
+    inline Float div(Float a, Float b){ return a / b; }
+    inline Float sqrt(Float a){ return std::sqrt(a); }
+    inline Float clamp01(Float a){ return std::min(std::max(a, 0.0f), 1.0f); }
+    inline uint32_t lessThan(Float a, Float b){ return a < b ? 1 : 0; }
+    inline Float select(uint32_t bits, Float a){ return bits & 1 ? a : 0.0f; }
+    inline float sum(Float a){ return a; }
+    constexpr const char* NAME = "scalar";
+#endif
+} // namespace simd
+
+namespace{
+    // The noise of boids.comp
+    float fract(float x){
+        return x - std::floor(x);
+    }
+    float hash(float n){
+        return fract(std::sin(n)*43758.5453f);
+    }
+    float noise1(glm::vec2 x){
+        glm::vec2 p = glm::floor(x);
+        glm::vec2 f = x - p;
+
+        f       = f*f*(3.0f - 2.0f*f);
+        float n = p.x + p.y*57.0f + 113.0f;
+
+        return glm::mix(glm::mix(glm::mix(hash(n+0.0f), hash(n+1.0f), f.x),
+                                 glm::mix(hash(n+57.0f), hash(n+58.0f), f.x), f.y),
+                        glm::mix(glm::mix(hash(n+113.0f), hash(n+114.0f), f.x),
+                                 glm::mix(hash(n+170.0f), hash(n+171.0f), f.x), f.y), f.y);
+    }
+}
+
+CpuBoids::CpuBoids(const std::vector<Boid>& boids, uint32_t _tableSize, uint32_t threadCount):
+    tableSize{_tableSize},
+    pool{threadCount}
+{
+    uint32_t n = uint32_t(boids.size());
+    for(State* state : {&current, &next, &sorted}){
+        // Sorted arrays are padded so the last vector of a bucket can be loaded whole
+        size_t size = state == &sorted ? n + simd::WIDTH : n;
+        state->x.assign(size, 0.0f);
+        state->y.assign(size, 0.0f);
+        state->dirX.assign(size, 0.0f);
+        state->dirY.assign(size, 0.0f);
+    }
+    noiseOffset.resize(n);
+    sortedPosition.resize(n);
+
+    for(uint32_t i = 0; i < n; i++){
+        current.x[i] = boids[i].position.x;
+        current.y[i] = boids[i].position.y;
+        current.dirX[i] = boids[i].direction.x;
+        current.dirY[i] = boids[i].direction.y;
+        noiseOffset[i] = boids[i].noiseOffset;
+    }
+}
+
+void CpuBoids::sortByBucket(){
+    pool.parallelFor(count(), 4096, [this](uint32_t begin, uint32_t end){
+        for(uint32_t k = begin; k < end; k++){
+            uint32_t i = grid.indices[k];
+            sorted.x[k] = current.x[i];
+            sorted.y[k] = current.y[i];
+            sorted.dirX[k] = current.dirX[i];
+            sorted.dirY[k] = current.dirY[i];
+            sortedPosition[i] = k;
+        }
+    });
+}
+
+void CpuBoids::step(const ComputeData& data, uint32_t maxNeighbours, Boid* out){
+    grid.build(current.x.data(), current.y.data(), count(), data.neighbourDistance, tableSize);
+    sortByBucket();
+
+    const float radius = data.neighbourDistance;
+    const float inverseRadius = 1.0f / radius;
+    const float ip = std::exp(-data.rotationSpeed * data.deltaTime);
+
+    pool.parallelFor(count(), 256, [&](uint32_t begin, uint32_t end){
+        for(uint32_t i = begin; i < end; i++){
+            glm::vec2 position = {current.x[i], current.y[i]};
+            glm::vec2 direction = {current.dirX[i], current.dirY[i]};
+
+            float noise = std::clamp(noise1(data.time/100.0f + noiseOffset[i]), -1.0f, 1.0f) * 2.0f - 1.0f;
+            float velocity = data.boidSpeed * (1.0f + noise * data.boidSpeedVariation);
+
+            simd::Float px = simd::set(position.x), py = simd::set(position.y);
+            simd::Float sepX = simd::set(0.0f), sepY = simd::set(0.0f);
+            simd::Float aliX = simd::set(0.0f), aliY = simd::set(0.0f);
+            simd::Float cohX = simd::set(0.0f), cohY = simd::set(0.0f);
+            uint32_t nearbyCount = 1;
+
+            uint32_t buckets[9];
+            uint32_t bucketCount = shard::gfx::gpu::SpatialHash::neighbours(
+                position.x, position.y, grid.inverseCellSize, tableSize, buckets
+            );
+            for(uint32_t b = 0; b < bucketCount && nearbyCount <= maxNeighbours; b++){
+                uint32_t start = grid.cellStarts[buckets[b]];
+                uint32_t bucketEnd = start + grid.cellCounts[buckets[b]];
+                for(uint32_t j = start; j < bucketEnd && nearbyCount <= maxNeighbours; j += simd::WIDTH){
+                    simd::Float ox = simd::load(&sorted.x[j]);
+                    simd::Float oy = simd::load(&sorted.y[j]);
+                    simd::Float dx = simd::sub(px, ox);
+                    simd::Float dy = simd::sub(py, oy);
+                    simd::Float distance2 = simd::add(simd::mul(dx, dx), simd::mul(dy, dy));
+
+                    uint32_t lanes = std::min(simd::WIDTH, bucketEnd - j);
+                    uint32_t accepted = simd::lessThan(distance2, simd::set(radius*radius));
+                    accepted &= (1u << lanes) - 1;
+                    if(sortedPosition[i] >= j && sortedPosition[i] < j + lanes){
+                        accepted &= ~(1u << (sortedPosition[i] - j));
+                    }
+                    // Same cap as the GPU, which stops at the first maxNeighbours found
+                    uint32_t room = maxNeighbours + 1 - nearbyCount;
+                    while(uint32_t(std::popcount(accepted)) > room){
+                        accepted &= ~(1u << (31 - std::countl_zero(accepted)));
+                    }
+                    if(accepted == 0) continue;
+
+                    simd::Float length = simd::sqrt(distance2);
+                    simd::Float scalar = simd::clamp01(simd::sub(simd::set(1.0f), simd::mul(length, simd::set(inverseRadius))));
+                    simd::Float weight = simd::select(accepted, simd::div(scalar, length));
+                    sepX = simd::add(sepX, simd::mul(dx, weight));
+                    sepY = simd::add(sepY, simd::mul(dy, weight));
+                    aliX = simd::add(aliX, simd::select(accepted, simd::load(&sorted.dirX[j])));
+                    aliY = simd::add(aliY, simd::select(accepted, simd::load(&sorted.dirY[j])));
+                    cohX = simd::add(cohX, simd::select(accepted, ox));
+                    cohY = simd::add(cohY, simd::select(accepted, oy));
+                    nearbyCount += uint32_t(std::popcount(accepted));
+                }
+            }
+
+            glm::vec2 separation = {simd::sum(sepX), simd::sum(sepY)};
+            glm::vec2 alignment = {simd::sum(aliX), simd::sum(aliY)};
+            glm::vec2 cohesion = data.flockPosition + glm::vec2(simd::sum(cohX), simd::sum(cohY));
+
+            float avg = 1.0f / float(nearbyCount);
+            alignment *= avg;
+            cohesion  *= avg;
+            cohesion  =  glm::normalize(cohesion - position);
+
+            glm::vec2 steering = alignment + separation + cohesion;
+            direction = glm::mix(steering, glm::normalize(direction), ip);
+            position += direction * (velocity * data.deltaTime);
+
+            next.x[i] = position.x;
+            next.y[i] = position.y;
+            next.dirX[i] = direction.x;
+            next.dirY[i] = direction.y;
+            if(out){
+                out[i].position = position;
+                out[i].direction = direction;
+                out[i].noiseOffset = noiseOffset[i];
+                out[i].color = {1.0f, 0.0f, 1.0f};
+            }
+        }
+    });
+
+    std::swap(current, next);
+}
+
+Boid CpuBoids::boid(uint32_t i) const {
+    Boid boid = {};
+    boid.position = {current.x[i], current.y[i]};
+    boid.direction = {current.dirX[i], current.dirY[i]};
+    boid.noiseOffset = noiseOffset[i];
+    boid.color = {1.0f, 0.0f, 1.0f};
+    return boid;
+}
+
+const char* CpuBoids::simdName(){
+    return simd::NAME;
+}
\ No newline at end of file
@@ -1,9 +1,27 @@
-#include <shard/gfx/gfx.hpp>
+#include "boids.hpp"
+
 #include <shard/time/time.hpp>
 #include <shard/random/random.hpp>
 #include <shard/imgui.hpp>
 
-const uint32_t BOID_COUNT = 10000;
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <memory>
+
+// Usage: 06.out [boid count] [--bench | --validate | --cpu]
+// --bench checks the GPU spatial hash against the CPU reference, then reports
+// simulated agents per millisecond instead of opening the render loop
+// --validate compares one GPU step against the CPU backend and exits
+// --cpu renders with the boids simulated by the CPU backend instead of the GPU
+
+const uint32_t DEFAULT_BOID_COUNT = 100000;
+const uint32_t MAX_NEIGHBOURS = 64;
+const uint32_t BENCH_STEPS = 100;
+const uint32_t CPU_BENCH_STEPS = 10;
+// Steering divides by neighbour distances, so a near miss may be tipped either way
+const float VALIDATE_TOLERANCE = 0.05f;
 const int WINDOW_WIDTH  = 800;
 const int WINDOW_HEIGHT = 600;
 
@@ -13,25 +31,9 @@ shard::gfx::Vertex2D boidVertices[] = {
     { { 0.5f,  0.5f}, {}, {} }
 };
 
-struct ComputeData{
-    alignas(4)  float      deltaTime;
-    alignas(4)  float      rotationSpeed;
-    alignas(4)  float      boidSpeed;
-    alignas(4)  float      boidSpeedVariation;
-    alignas(8)  glm::vec2  flockPosition;
-    alignas(4)  float      neighbourDistance;
-    alignas(4)  int        boidCount;
-    alignas(8)  glm::vec2  time;
-};
 struct VertexData{
     glm::mat4 projection;
 };
-struct Boid{
-    glm::vec2    position;
-    glm::vec2    direction;
-    float        noiseOffset;
-    glm::vec3    color;
-};
 
 VkSharingMode getComputeSharingMode(shard::gfx::Graphics& gfx){
     if(gfx.device().getQueueFamilyIndices().graphics.value() != gfx.device().getQueueFamilyIndices().compute.value())
@@ -39,7 +41,50 @@ VkSharingMode getComputeSharingMode(shard::gfx::Graphics& gfx){
     return VK_SHARING_MODE_EXCLUSIVE;
 }
 
-int main(){
+std::vector<uint32_t> download(shard::gfx::Device& device, shard::gfx::Buffer& buffer){
+    shard::gfx::Buffer staging(
+        device, buffer.size(),
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_TO_CPU,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        VK_SHARING_MODE_EXCLUSIVE
+    );
+    VkCommandBuffer commandBuffer = device.beginSingleTimeCommands();
+    VkBufferCopy region = {};
+    region.size = buffer.size();
+    vkCmdCopyBuffer(commandBuffer, buffer.buffer(), staging.buffer(), 1, &region);
+    device.endSingleTimeCommands(commandBuffer);
+
+    std::vector<uint32_t> data(buffer.size() / sizeof(uint32_t));
+    std::memcpy(data.data(), staging.mappedMemory(), buffer.size());
+    return data;
+}
+
+// Buckets may be filled in any order on the GPU, so indices are compared per bucket
+bool matchesReference(
+    shard::gfx::Device& device, shard::gfx::gpu::SpatialHash& hash,
+    const shard::gfx::gpu::SpatialHash::Reference& reference
+){
+    auto starts = download(device, hash.cellStarts());
+    auto counts = download(device, hash.cellCounts());
+    auto indices = download(device, hash.indices());
+    if(starts != reference.cellStarts || counts != reference.cellCounts) return false;
+    for(uint32_t b = 0; b < hash.tableSize(); b++){
+        std::sort(indices.begin() + starts[b], indices.begin() + starts[b] + counts[b]);
+    }
+    indices.resize(reference.indices.size());
+    return indices == reference.indices;
+}
+
+int main(int argc, char** argv){
+    const uint32_t boidCount = argc > 1 ? uint32_t(std::atoi(argv[1])) : DEFAULT_BOID_COUNT;
+    const bool bench = argc > 2 && std::strcmp(argv[2], "--bench") == 0;
+    const bool validate = argc > 2 && std::strcmp(argv[2], "--validate") == 0;
+    const bool cpu = argc > 2 && std::strcmp(argv[2], "--cpu") == 0;
+    const bool headless = bench || validate;
+    // Keeps the number of neighbours per boid roughly constant as the flock grows
+    const float neighbourDistance = std::max(120.0f * std::sqrt(10000.0f / float(boidCount)), 4.0f);
+
     glfwInit();
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
     GLFWwindow* window = glfwCreateWindow(
@@ -48,7 +93,7 @@ int main(){
 
     shard::gfx::Graphics gfx(window, false);
     auto descPool = gfx.createDescriptorPoolBuilder().addPoolSize(
-        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 10
+        VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 32
     ).addPoolSize(
         VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 10
     ).setMaxSets(1000).build();
@@ -72,8 +117,16 @@ int main(){
         shard::gfx::Vertex2D::attributeDescs(), gfx.deafultPipelineConfig()
     );
 
-    std::vector<Boid> boidData(BOID_COUNT);
+    auto extent = shard::getWindowExtent(window);
+    std::vector<Boid> boidData(boidCount);
     for(auto& boid : boidData){
+        // Spread over the view, a flock starting in one cell would fill a single bucket
+        boid.position = {
+            rng.randf() * float(extent.width*2),
+            rng.randf() * float(extent.height*2)
+        };
+        float angle = rng.randf() * 6.2831853f;
+        boid.direction = {std::cos(angle), std::sin(angle)};
         boid.color = {
             rng.randf(),
             rng.randf(),
@@ -83,7 +136,12 @@ int main(){
     }
     
     auto boidBuffer = gfx.createStorageBuffer_GPUonly(
-        sizeof(Boid)*BOID_COUNT, getComputeSharingMode(gfx), boidData.data()
+        sizeof(Boid)*boidCount, getComputeSharingMode(gfx), boidData.data()
+    );
+
+    // Snapshot the compute kernel reads from while it writes boidBuffer
+    auto previousBoidBuffer = gfx.createStorageBuffer_GPUonly(
+        sizeof(Boid)*boidCount, getComputeSharingMode(gfx), boidData.data()
     );
 
     VkMemoryRequirements memReq;
@@ -95,22 +153,82 @@ int main(){
         0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT
     ).addBinding(
         1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT
+    ).addBinding(
+        2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT
+    ).addBinding(
+        3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT
+    ).addBinding(
+        4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT
+    ).addBinding(
+        5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT
     ).build();
     auto boidCompLayout = gfx.createPipelineLayout({}, {&boidCompDescLayout});
+    // Neighbours are found through a uniform grid rebuilt every step
+    shard::gfx::gpu::SpatialHash spatialHash(gfx.device(), boidCount);
+
+    // The workgroup size, boid count and hash table size are baked into the kernel
+    const uint32_t workgroupSize = shard::gfx::Compute::clampWorkgroupSize(gfx.device(), 256);
+    auto boidConstants = shard::gfx::SpecializationConstants()
+        .set(0, workgroupSize)
+        .set(1, int32_t(boidCount))
+        .set(2, spatialHash.tableSize())
+        .set(3, MAX_NEIGHBOURS);
     auto computePipeline = gfx.createCompute(
-        boidCompLayout, "examples/06-compute-boids/boids.comp.spv"
+        boidCompLayout, "examples/06-compute-boids/boids.comp.spv", boidConstants
+    );
+    // The CPU backend only matches the kernel when neither caps the neighbours,
+    // the first MAX_NEIGHBOURS found on the GPU depend on the scatter order
+    auto uncappedConstants = shard::gfx::SpecializationConstants()
+        .set(0, workgroupSize)
+        .set(1, int32_t(boidCount))
+        .set(2, spatialHash.tableSize())
+        .set(3, UINT32_MAX);
+    auto uncappedPipeline = gfx.createCompute(
+        boidCompLayout, "examples/06-compute-boids/boids.comp.spv", uncappedConstants
     );
 
+    // Debug builds recompile and swap the boid shaders when they are saved
+    if(shard::IS_DEBUG){
+        gfx.shaderReloader().watch(
+            boidPipeline, [&gfx](){ return gfx.swapchain().renderPass(); }, boidLayout,
+            "examples/06-compute-boids/boids.vert.spv", "examples/06-compute-boids/boids.frag.spv",
+            {shard::gfx::Vertex2D::bindingDesc(VK_VERTEX_INPUT_RATE_VERTEX)},
+            shard::gfx::Vertex2D::attributeDescs(), gfx.deafultPipelineConfig()
+        );
+        gfx.shaderReloader().watch(
+            computePipeline, boidCompLayout, "examples/06-compute-boids/boids.comp.spv",
+            boidConstants
+        );
+    }
+
     auto computeUniformBuffer = gfx.createUniformBuffer(
         sizeof(ComputeData), VK_SHARING_MODE_EXCLUSIVE, nullptr
     );
     computeUniformBuffer.map();
     auto computeUniformBufferInfo = computeUniformBuffer.descriptorInfo();
     auto boidBufferInfo = boidBuffer.descriptorInfo();
+    auto cellStartsInfo = spatialHash.cellStarts().descriptorInfo();
+    auto cellCountsInfo = spatialHash.cellCounts().descriptorInfo();
+    auto indicesInfo = spatialHash.indices().descriptorInfo();
+    auto previousBoidBufferInfo = previousBoidBuffer.descriptorInfo();
     VkDescriptorSet computeDescSet = VK_NULL_HANDLE;
     shard::gfx::DescriptorWriter(
         boidCompDescLayout, descPool
-    ).writeBuffer(0, &computeUniformBufferInfo).writeBuffer(1, &boidBufferInfo).build(computeDescSet);
+    ).writeBuffer(0, &computeUniformBufferInfo).writeBuffer(1, &boidBufferInfo)
+     .writeBuffer(2, &cellStartsInfo).writeBuffer(3, &cellCountsInfo)
+     .writeBuffer(4, &indicesInfo).writeBuffer(5, &previousBoidBufferInfo).build(computeDescSet);
+
+    // Host visible copies of the boids written by the CPU backend, one per frame in flight
+    std::vector<shard::gfx::Buffer> cpuBoidBuffers = {};
+    std::vector<VkDescriptorBufferInfo> cpuBoidBufferInfos = {};
+    if(cpu){
+        for(uint32_t i = 0; i < shard::gfx::Swapchain::MAX_FRAMES_IN_FLIGHT; i++){
+            cpuBoidBuffers.push_back(
+                gfx.createStorageBuffer(sizeof(Boid)*boidCount, VK_SHARING_MODE_EXCLUSIVE, boidData.data())
+            );
+            cpuBoidBufferInfos.push_back(cpuBoidBuffers[i].descriptorInfo());
+        }
+    }
 
     std::vector<shard::gfx::Buffer> uBuffers = {};
     std::vector<VkDescriptorSet> descSets(shard::gfx::Swapchain::MAX_FRAMES_IN_FLIGHT);
@@ -124,55 +242,148 @@ int main(){
         shard::gfx::DescriptorWriter(boidDescSetLayout, descPool).writeBuffer(
             0, &uBufInfo
         ).writeBuffer(
-            1, &boidBufferInfo
+            1, cpu ? &cpuBoidBufferInfos[idx] : &boidBufferInfo
         ).build(descSet);
         idx++;
     }
 
     VkCommandBuffer computeCommands = gfx.allocateComputeCommandBuffer();
 
-    shard::imgui::init(window, gfx, descPool, VK_SAMPLE_COUNT_1_BIT);
-    
     ComputeData computeData = {};
-    computeData.boidCount = BOID_COUNT;
     computeData.boidSpeed = 2000.0f;
     computeData.boidSpeedVariation = 0.1f;
     computeData.deltaTime = 0.0f;
-    computeData.neighbourDistance = 120.0f;
+    computeData.neighbourDistance = neighbourDistance;
+    computeData.inverseCellSize = 1.0f / neighbourDistance;
     computeData.rotationSpeed = 10.0f;
 
+    auto step = [&](shard::gfx::Compute& pipeline){
+        gfx.beginComputeCommands(computeCommands);
+        VkBufferCopy region = {};
+        region.size = boidBuffer.size();
+        vkCmdCopyBuffer(computeCommands, boidBuffer.buffer(), previousBoidBuffer.buffer(), 1, &region);
+        spatialHash.record(computeCommands, previousBoidBuffer, boidCount, neighbourDistance, BOID_STRIDE);
+
+        pipeline.bind(computeCommands);
+        memcpy(
+            computeUniformBuffer.mappedMemory(), &computeData, sizeof(ComputeData)
+        );
+        vkCmdBindDescriptorSets(
+            computeCommands, VK_PIPELINE_BIND_POINT_COMPUTE,
+            boidCompLayout, 0, 1, &computeDescSet,
+            0, nullptr
+        );
+        pipeline.dispatch(computeCommands, (boidCount + workgroupSize - 1)/workgroupSize, 1);
+        gfx.submitComputeCommands(computeCommands);
+    };
+
+    // Sized like the GPU hash so both see the same buckets
+    std::unique_ptr<CpuBoids> cpuBoids;
+    if(bench || validate || cpu){
+        cpuBoids = std::make_unique<CpuBoids>(boidData, spatialHash.tableSize());
+    }
+    // Mismatches fail the process so CI jobs running --validate or --bench notice
+    bool failed = false;
+
+    if(validate){
+        // The noise hash amplifies sin() differences between the GPU and the CPU
+        computeData.boidSpeedVariation = 0.0f;
+        computeData.deltaTime = 1.0f / 60.0f;
+        computeData.flockPosition = {float(extent.width), float(extent.height)};
+        step(uncappedPipeline);
+        cpuBoids->step(computeData, UINT32_MAX);
+
+        std::vector<Boid> gpuBoids(boidCount);
+        std::memcpy(gpuBoids.data(), download(gfx.device(), boidBuffer).data(), sizeof(Boid)*boidCount);
+        float maxError = 0.0f;
+        uint32_t mismatches = 0;
+        for(uint32_t i = 0; i < boidCount; i++){
+            Boid cpuBoid = cpuBoids->boid(i);
+            float error = std::max(
+                glm::distance(gpuBoids[i].position, cpuBoid.position),
+                glm::distance(gpuBoids[i].direction, cpuBoid.direction)
+            );
+            maxError = std::max(maxError, error);
+            if(!(error <= VALIDATE_TOLERANCE)) mismatches++;
+        }
+        std::cout << "CPU backend (" << CpuBoids::simdName() << ") "
+                  << (mismatches == 0 ? "matches" : "DOES NOT match") << " the GPU kernel, "
+                  << mismatches << " of " << boidCount << " boids differ, max error " << maxError << "\n";
+        if(mismatches > 0) failed = true;
+    }
+
+    if(bench){
+        using Clock = std::chrono::steady_clock;
+
+        spatialHash.build(boidBuffer, boidCount, neighbourDistance, BOID_STRIDE);
+        auto cpuStart = Clock::now();
+        shard::gfx::gpu::SpatialHash::Reference reference;
+        reference.build(
+            &boidData[0].position.x, boidCount, neighbourDistance,
+            spatialHash.tableSize(), BOID_STRIDE
+        );
+        uint64_t neighbours = 0;
+        for(uint32_t i = 0; i < boidCount; i++){
+            glm::vec2 position = boidData[i].position;
+            reference.forEachCandidate(position.x, position.y, [&](uint32_t j){
+                if(j != i && glm::distance(position, boidData[j].position) < neighbourDistance)
+                    neighbours++;
+            });
+        }
+        double cpuMs = std::chrono::duration<double, std::milli>(Clock::now() - cpuStart).count();
+        bool matches = matchesReference(gfx.device(), spatialHash, reference);
+        std::cout << "spatial hash " << (matches ? "matches" : "DOES NOT match") << " the CPU reference, "
+                  << double(neighbours) / boidCount << " neighbours per boid\n";
+        if(!matches) failed = true;
+
+        computeData.deltaTime = 1.0f / 60.0f;
+        auto gpuStart = Clock::now();
+        for(uint32_t i = 0; i < BENCH_STEPS; i++){
+            step(computePipeline);
+        }
+        double gpuMs = std::chrono::duration<double, std::milli>(Clock::now() - gpuStart).count() / BENCH_STEPS;
+
+        auto simdStart = Clock::now();
+        for(uint32_t i = 0; i < CPU_BENCH_STEPS; i++){
+            cpuBoids->step(computeData, MAX_NEIGHBOURS);
+        }
+        double simdMs = std::chrono::duration<double, std::milli>(Clock::now() - simdStart).count() / CPU_BENCH_STEPS;
+
+        std::cout << boidCount << " boids\n"
+                  << "GPU hash + step:  " << gpuMs << " ms, " << boidCount / gpuMs << " agents/ms\n"
+                  << "CPU hash + query: " << cpuMs << " ms, " << boidCount / cpuMs << " agents/ms\n"
+                  << "CPU " << CpuBoids::simdName() << " step:  " << simdMs << " ms, " << boidCount / simdMs << " agents/ms\n";
+    }
+    if(!headless){
+        shard::imgui::init(window, gfx, descPool, VK_SAMPLE_COUNT_1_BIT);
+    }
+
     VertexData vertData = {};
 
     shard::time::addTimer(time, "fpsTimer", 1.0f, [&](shard::Timer& timer){
         std::cout << time.fps << "\n";
     });
 
-    while(!glfwWindowShouldClose(window)){
+    while(!headless && !glfwWindowShouldClose(window)){
         glfwPollEvents();
         shard::time::updateTime(time);
 
-        gfx.beginComputeCommands(computeCommands);
         auto mousePos = shard::getCursorPos(window)*2.0f;
         computeData.flockPosition = mousePos;
-        
-        computeData.flockPosition = mousePos;
-
-        computePipeline.bind(computeCommands);
         computeData.deltaTime = time.dt;
         computeData.time.x = time.elapsed / 20;
         computeData.time.y = time.elapsed;
-        memcpy(
-            computeUniformBuffer.mappedMemory(), &computeData, sizeof(ComputeData)
-        );
-        vkCmdBindDescriptorSets(
-            computeCommands, VK_PIPELINE_BIND_POINT_COMPUTE,
-            boidCompLayout, 0, 1, &computeDescSet,
-            0, nullptr
-        );
-        computePipeline.dispatch(computeCommands, uint32_t((BOID_COUNT/256))+1, 1);
-        gfx.submitComputeCommands(computeCommands);
+        if(!cpu) step(computePipeline);
 
         if(auto commands = gfx.beginRenderPass([&](VkCommandBuffer cmd){
+            // This frame's buffer is no longer read once its fence has been waited on
+            if(cpu){
+                cpuBoids->step(
+                    computeData, MAX_NEIGHBOURS,
+                    static_cast<Boid*>(cpuBoidBuffers[gfx.frameIndex()].mappedMemory())
+                );
+                return;
+            }
             VkBufferMemoryBarrier barrier = {};
             barrier.sType  = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
             barrier.buffer = boidBuffer.buffer();
@@ -201,7 +412,7 @@ int main(){
                 0, nullptr
             );
             vertexBuffer.bindVertex(commands);
-            vkCmdDraw(commands, 3, BOID_COUNT, 0, 0);
+            vkCmdDraw(commands, 3, boidCount, 0, 0);
             gfx.endRenderPass();
         }
     }
@@ -210,7 +421,9 @@ int main(){
     gfx.destroyPipelineLayout(boidLayout);
     gfx.destroyPipelineLayout(boidCompLayout);
     gfx.freeComputeCommandBuffer(computeCommands);
-    shard::imgui::terminate();
+    if(!headless) shard::imgui::terminate();
     glfwDestroyWindow(window);
     glfwTerminate();
+
+    return failed ? 1 : 0;
 }
\ No newline at end of file
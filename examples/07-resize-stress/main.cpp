@@ -0,0 +1,109 @@
+#include <shard/gfx/gfx.hpp>
+#include <shard/time/time.hpp>
+
+#include <algorithm>
+
+// Resizes the window every few frames while rendering and reports frame time
+// percentiles, swapchain recreation should not show up as long frames.
+
+struct Vertex{
+    glm::vec2 pos;
+    glm::vec4 color;
+};
+
+Vertex vertices[] = {
+    { { 0.0f, -0.5f }, {1.0f, 0.0f, 0.0f, 1.0f} },
+    { { 0.5f,  0.5f }, {0.0f, 1.0f, 0.0f, 1.0f} },
+    { {-0.5f,  0.5f }, {0.0f, 0.0f, 1.0f, 1.0f} },
+};
+
+const uint32_t FRAMES_PER_RESIZE = 4;
+const float    TEST_DURATION     = 20.0f;
+
+float percentile(std::vector<float>& sorted, float p){
+    if(sorted.empty()) return 0.0f;
+    size_t i = size_t(p * float(sorted.size() - 1) + 0.5f);
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+int main(){
+    glfwInit();
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    GLFWwindow* window = glfwCreateWindow(800, 600, "07-resize-stress", NULL, NULL);
+
+    VkVertexInputBindingDescription bindingDesc = {};
+    bindingDesc.binding   = 0;
+    bindingDesc.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    bindingDesc.stride    = sizeof(Vertex);
+
+    std::vector<VkVertexInputAttributeDescription> vertexAttrib(2);
+    vertexAttrib[0].binding  = 0;
+    vertexAttrib[0].format   = VK_FORMAT_R32G32_SFLOAT;
+    vertexAttrib[0].location = 0;
+    vertexAttrib[0].offset   = offsetof(Vertex, pos);
+
+    vertexAttrib[1].binding  = 0;
+    vertexAttrib[1].format   = VK_FORMAT_R32G32B32A32_SFLOAT;
+    vertexAttrib[1].location = 1;
+    vertexAttrib[1].offset   = offsetof(Vertex, color);
+
+                                     // vsync
+    shard::gfx::Graphics gfx(window, false);
+    shard::gfx::Buffer   vertexBuffer = gfx.createVertexBuffer(
+        sizeof(vertices), VK_SHARING_MODE_EXCLUSIVE, vertices
+    );
+    shard::gfx::Pipeline pipeline = gfx.createPipeline(
+        gfx.emptyPipelineLayout(),
+        "examples/01-triangle/tri.vert.spv", "examples/01-triangle/tri.frag.spv",
+        {bindingDesc}, vertexAttrib,
+        gfx.deafultPipelineConfig()
+    );
+
+    const VkExtent2D sizes[] = {
+        {800, 600}, {1024, 768}, {640, 480}, {1280, 720}, {720, 1280}, {960, 540}
+    };
+
+    shard::Time time = {};
+    shard::time::updateTime(time);
+    float start = time.elapsed;
+
+    std::vector<float> frameTimes = {};
+    uint32_t frame = 0;
+    uint32_t resizes = 0;
+
+    while(!glfwWindowShouldClose(window) && time.elapsed - start < TEST_DURATION){
+        glfwPollEvents();
+        shard::time::updateTime(time);
+        if(frame > 0) frameTimes.push_back(time.dt*1000.0f);
+
+        if(frame % FRAMES_PER_RESIZE == 0){
+            auto& size = sizes[resizes % (sizeof(sizes)/sizeof(sizes[0]))];
+            glfwSetWindowSize(window, int(size.width), int(size.height));
+            resizes++;
+        }
+
+        if(auto commandBuffer = gfx.beginRenderPass(nullptr, {44.0f})){
+            pipeline.bind(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS);
+            vertexBuffer.bindVertex(commandBuffer);
+            vkCmdDraw(commandBuffer, 3, 1, 0, 0);
+            gfx.endRenderPass();
+        }
+        frame++;
+    }
+    gfx.device().waitIdle();
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+    std::cout << "Frames: " << frameTimes.size() << ", resizes: " << resizes << "\n";
+    std::cout << "Frame time (ms)"
+              << " p50: "   << percentile(frameTimes, 0.50f)
+              << " p90: "   << percentile(frameTimes, 0.90f)
+              << " p99: "   << percentile(frameTimes, 0.99f)
+              << " p99.9: " << percentile(frameTimes, 0.999f)
+              << " max: "   << (frameTimes.empty() ? 0.0f : frameTimes.back())
+              << "\n";
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <shard/gfx/gfx.hpp>
+#include <shard/r2d/r2d.hpp>
+#include <shard/random/random.hpp>
+
+#include <iostream>
+
+// Bounces a lot of sprites around the window, every layer/texture combination is a
+// single instanced draw.
+const uint32_t SPRITE_COUNT = 20000;
+
+struct Bouncer{
+    glm::vec2 position;
+    glm::vec2 velocity;
+};
+
+int main(){
+    glfwInit();
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    GLFWwindow* window = glfwCreateWindow(800, 600, "08-sprites", NULL, NULL);
+
+    shard::gfx::Graphics gfx(window, false);
+    shard::r2d::Renderer renderer(gfx);
+
+    shard::r2d::Atlas atlas(gfx, renderer);
+    shard::r2d::AtlasHandle face = atlas.insert("examples/03-texture/face.jpg");
+
+    shard::randy::Random rng(1234);
+    std::vector<Bouncer> bouncers(SPRITE_COUNT);
+    for(auto& b : bouncers){
+        b.position = {rng.randRangef(0.0f, 800.0f), rng.randRangef(0.0f, 600.0f)};
+        b.velocity = {rng.randRangef(-100.0f, 100.0f), rng.randRangef(-100.0f, 100.0f)};
+    }
+
+    double lastTime = glfwGetTime();
+    double lastReport = lastTime;
+    while(!glfwWindowShouldClose(window)){
+        glfwPollEvents();
+
+        double now = glfwGetTime();
+        float dt = static_cast<float>(now - lastTime);
+        lastTime = now;
+
+        VkExtent2D extent = gfx.swapchain().swapchainExtent();
+        glm::vec2 bounds = {static_cast<float>(extent.width), static_cast<float>(extent.height)};
+        for(size_t i = 0; i < bouncers.size(); i++){
+            auto& b = bouncers[i];
+            b.position += b.velocity * dt;
+            if(b.position.x < 0.0f || b.position.x > bounds.x) b.velocity.x = -b.velocity.x;
+            if(b.position.y < 0.0f || b.position.y > bounds.y) b.velocity.y = -b.velocity.y;
+
+            shard::r2d::Sprite sprite;
+            sprite.position = b.position;
+            sprite.size = {16.0f, 16.0f};
+            sprite.rotation = static_cast<float>(now) + static_cast<float>(i);
+            atlas.apply(face, sprite);
+            renderer.drawSprite(sprite);
+        }
+
+        // HUD
+        shard::r2d::Rect panel;
+        panel.position = {110.0f, 30.0f};
+        panel.size = {200.0f, 40.0f};
+        panel.color = {20.0f, 20.0f, 20.0f, 200.0f};
+        panel.borderColor = {255.0f, 200.0f, 0.0f};
+        panel.borderSize = 2.0f;
+        panel.layer = 1;
+        renderer.drawRect(panel);
+
+        if(auto commandBuffer = gfx.beginRenderPass(
+            [&](VkCommandBuffer cmd){ atlas.recordUploads(cmd); }, {44.0f}
+        )){
+            renderer.flush(commandBuffer);
+            gfx.endRenderPass();
+        }
+
+        if(now - lastReport > 1.0){
+            lastReport = now;
+            std::cout << renderer.instanceCount() << " instances in "
+                      << renderer.drawCallCount() << " draw calls, "
+                      << gfx.framePacer().frameTimeStats().average << "ms\n";
+        }
+    }
+    gfx.device().waitIdle();
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <shard/gfx/modelLoader.hpp>
+#include <shard/gfx/meshFile.hpp>
+#include <shard/gfx/meshOptimizer.hpp>
+
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+
+// Usage: 09.out [model.obj] [iterations]
+int main(int argc, char** argv){
+    const char* filePath = argc > 1 ? argv[1] : "examples/04-model/model.obj";
+    int iterations = std::max(argc > 2 ? std::atoi(argv[2]) : 10, 1);
+
+    using Clock = std::chrono::steady_clock;
+    auto measure = [iterations](auto&& load, double& average, double& best){
+        double total = 0.0;
+        best = 1e30;
+        for(int i = 0; i < iterations; i++){
+            auto start = Clock::now();
+            load();
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            best = std::min(best, seconds);
+            total += seconds;
+        }
+        average = total / iterations;
+    };
+
+    size_t triangles = 0;
+    size_t vertices = 0;
+    double average, best;
+    measure([&](){
+        shard::gfx::ModelLoader loader(filePath);
+        triangles = loader.indices.size() / 3;
+        vertices = loader.vertices.size();
+    }, average, best);
+
+    std::cout << filePath << ": " << triangles << " triangles, " << vertices << " unique vertices\n";
+    std::cout << "OBJ:    average " << average * 1000.0 << " ms, best " << best * 1000.0 << " ms, "
+              << double(triangles) / average / 1e6 << " M triangles/s\n";
+
+    {
+        shard::gfx::ModelLoader loader(filePath);
+        auto start = Clock::now();
+        auto stats = shard::gfx::meshopt::optimizeMesh(loader.vertices, loader.indices);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        std::cout << "optimize: " << seconds * 1000.0 << " ms, ACMR "
+                  << stats.before.acmr << " -> " << stats.after.acmr << ", ATVR "
+                  << stats.before.atvr << " -> " << stats.after.atvr << "\n";
+    }
+
+    {
+        shard::gfx::ModelLoader loader(filePath);
+        auto start = Clock::now();
+        loader.generateLods();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        std::cout << "lods: " << seconds * 1000.0 << " ms\n";
+        for(size_t i = 0; i < loader.lods.size(); i++){
+            std::cout << "  " << i << ": " << loader.lods[i].indexCount / 3
+                      << " triangles, error " << loader.lods[i].error << "\n";
+        }
+    }
+
+    // Builds the cache if needed, then measures mapping it
+    if(!shard::gfx::MeshFile::loadObj(filePath).valid()){
+        std::cout << "Failed to build the .smesh cache\n";
+        return 1;
+    }
+    uint64_t checksum = 0;
+    measure([&](){
+        auto mesh = shard::gfx::MeshFile::loadObj(filePath);
+        // Touch every page, as copying into a staging buffer would
+        for(uint32_t i = 0; i < mesh.indexCount(); i += 1024) checksum += mesh.indices()[i];
+        for(uint32_t i = 0; i < mesh.vertexCount(); i += 64) checksum += uint64_t(mesh.vertices()[i].pos.x);
+    }, average, best);
+
+    std::cout << ".smesh: average " << average * 1000.0 << " ms, best " << best * 1000.0 << " ms, "
+              << double(triangles) / average / 1e6 << " M triangles/s (" << checksum % 10 << ")\n";
+
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <shard/gfx/gfx.hpp>
+#include <shard/gfx/model.hpp>
+#include <shard/gfx/instanceBuffer.hpp>
+#include <shard/time/time.hpp>
+#include <shard/random/random.hpp>
+
+// Usage: 10.out [instance count]
+
+struct Rock{
+    glm::vec4 positionScale;
+    glm::vec4 tint;
+
+    using Layout = shard::gfx::VertexLayout<
+        shard::gfx::attr::Float4, shard::gfx::attr::Float4
+    >;
+};
+
+std::vector<shard::gfx::Vertex3D> cubeVertices(){
+    const glm::vec3 normals[] = {
+        { 1.0f,  0.0f,  0.0f}, {-1.0f,  0.0f,  0.0f},
+        { 0.0f,  1.0f,  0.0f}, { 0.0f, -1.0f,  0.0f},
+        { 0.0f,  0.0f,  1.0f}, { 0.0f,  0.0f, -1.0f}
+    };
+    std::vector<shard::gfx::Vertex3D> vertices;
+    for(const auto& n : normals){
+        // Two axes spanning the face, ordered so the corners wind counter clockwise
+        glm::vec3 u = glm::vec3(n.y, n.z, n.x);
+        glm::vec3 v = glm::cross(n, u);
+        const glm::vec2 corners[] = {{-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f}};
+        for(const auto& c : corners){
+            vertices.push_back(shard::gfx::Vertex3D(
+                (n + u*c.x + v*c.y) * 0.5f, (c + 1.0f) * 0.5f, n, shard::gfx::Color(255.0f)
+            ));
+        }
+    }
+    return vertices;
+}
+std::vector<uint32_t> cubeIndices(){
+    std::vector<uint32_t> indices;
+    for(uint32_t face = 0; face < 6; face++){
+        uint32_t base = face * 4;
+        indices.insert(indices.end(), {base, base + 1, base + 2, base + 2, base + 3, base});
+    }
+    return indices;
+}
+
+int main(int argc, char** argv){
+    uint32_t instanceCount = argc > 1 ? uint32_t(std::atoi(argv[1])) : 100000;
+
+    glfwInit();
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    GLFWwindow* window = glfwCreateWindow(1280, 720, "10-instancing", NULL, NULL);
+    shard::gfx::Graphics gfx(window, false);
+
+    shard::gfx::Model cube(gfx, cubeVertices(), cubeIndices());
+    shard::gfx::InstanceBuffer<Rock> instances(gfx, instanceCount);
+
+    shard::randy::Random rng(1234);
+    std::vector<Rock> rocks(instanceCount);
+    std::vector<float> phases(instanceCount);
+    float fieldSize = std::sqrt(float(instanceCount)) * 1.5f;
+    for(uint32_t i = 0; i < instanceCount; i++){
+        rocks[i].positionScale = glm::vec4(
+            rng.randRangef(-fieldSize, fieldSize), 0.0f,
+            rng.randRangef(-fieldSize, fieldSize),
+            rng.randRangef(0.3f, 1.2f)
+        );
+        float grey = rng.randRangef(0.4f, 0.7f);
+        rocks[i].tint = glm::vec4(grey, grey * 0.9f, grey * 0.8f, 1.0f);
+        phases[i] = rng.randRangef(0.0f, 6.2831853f);
+    }
+
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.size = sizeof(glm::mat4);
+    auto pipelineLayout = gfx.createPipelineLayout({pushConstantRange}, {});
+
+    // Instance attributes follow the vertex attributes, at the binding after the model's streams
+    uint32_t vertexAttributes = shard::gfx::Vertex3D::Layout::attributeCount;
+    auto attributes = shard::gfx::Vertex3D::attributeDescs();
+    auto instanceAttributes = shard::gfx::InstanceBuffer<Rock>::attributeDescs(cube.streamCount(), vertexAttributes);
+    attributes.insert(attributes.end(), instanceAttributes.begin(), instanceAttributes.end());
+
+    shard::gfx::PipelineConfigInfo config = {};
+    config.makeDefault();
+    config.rasterizationInfo.cullMode = VK_CULL_MODE_BACK_BIT;
+    auto pipeline = gfx.createPipeline(
+        pipelineLayout,
+        "examples/10-instancing/rock.vert.spv", "examples/10-instancing/rock.frag.spv",
+        {
+            shard::gfx::Vertex3D::bindingDesc(VK_VERTEX_INPUT_RATE_VERTEX),
+            shard::gfx::InstanceBuffer<Rock>::bindingDesc(cube.streamCount())
+        },
+        attributes,
+        config
+    );
+
+    shard::Time time = {};
+    float reportTimer = 0.0f;
+    while(!glfwWindowShouldClose(window)){
+        glfwPollEvents();
+        shard::time::updateTime(time);
+
+        reportTimer += time.dt;
+        if(reportTimer >= 1.0f){
+            std::cout << instanceCount << " instances, " << time.fps << " fps\n";
+            reportTimer = 0.0f;
+        }
+
+        if(auto commandBuffer = gfx.beginRenderPass(nullptr, {44.0f})){
+            for(uint32_t i = 0; i < instanceCount; i++){
+                rocks[i].positionScale.y = std::sin(time.elapsed + phases[i]) * 0.5f;
+            }
+            uint32_t first = instances.push(rocks);
+
+            VkExtent2D extent = shard::getWindowExtent(window);
+            glm::mat4 proj = glm::perspective(
+                glm::radians(60.0f), float(extent.width)/float(extent.height),
+                0.1f, fieldSize * 4.0f
+            );
+            float angle = time.elapsed * 0.1f;
+            glm::vec3 eye = glm::vec3(std::cos(angle), 0.4f, std::sin(angle)) * fieldSize;
+            glm::mat4 viewProj = proj * glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+
+            pipeline.bind(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS);
+            vkCmdPushConstants(
+                commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
+                0, sizeof(glm::mat4), &viewProj
+            );
+            cube.bind(commandBuffer);
+            cube.drawInstanced(commandBuffer, instances, first, instanceCount);
+
+            gfx.endRenderPass();
+        }
+    }
+    gfx.device().waitIdle();
+    gfx.destroyPipelineLayout(pipelineLayout);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#version 450
+
+layout (location = 0) in vec3 inNormal;
+layout (location = 1) in vec4 inColor;
+
+layout (location = 0) out vec4 fragColor;
+
+const vec3 sunDir = normalize(vec3(0.4, -1.0, 0.3));
+
+void main(){
+    float diffuse = max(dot(normalize(inNormal), -sunDir), 0.0);
+    fragColor = vec4(inColor.rgb * (0.3 + 0.7 * diffuse), 1.0);
+}
\ No newline at end of file
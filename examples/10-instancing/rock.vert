@@ -0,0 +1,24 @@
+#version 450
+
+layout (location = 0) in vec3 inPos;
+layout (location = 1) in vec2 inUv;
+layout (location = 2) in vec3 inNormal;
+layout (location = 3) in vec4 inColor;
+
+// Per instance
+layout (location = 4) in vec4 inPositionScale;
+layout (location = 5) in vec4 inTint;
+
+layout (location = 0) out vec3 outNormal;
+layout (location = 1) out vec4 outColor;
+
+layout (push_constant) uniform Camera {
+    mat4 viewProj;
+} camera;
+
+void main(){
+    vec3 world = inPos * inPositionScale.w + inPositionScale.xyz;
+    gl_Position = camera.viewProj * vec4(world, 1.0);
+    outNormal = inNormal;
+    outColor = inTint;
+}
\ No newline at end of file
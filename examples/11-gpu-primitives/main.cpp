@@ -0,0 +1,134 @@
+#include <shard/gfx/device.hpp>
+#include <shard/gfx/gpu/gpu.hpp>
+#include <shard/random/random.hpp>
+
+#include <iostream>
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+#include <cstdlib>
+
+// Validates the gpu:: primitives against CPU references on a headless device, runs on
+// software implementations such as lavapipe or SwiftShader.
+// Usage: 11.out [element count]
+
+namespace gpu = shard::gfx::gpu;
+
+// Host visible so the results can be read back without staging
+shard::gfx::Buffer hostBuffer(shard::gfx::Device& device, const std::vector<uint32_t>& data){
+    return shard::gfx::Buffer(
+        device,
+        std::max<size_t>(data.size(), 1) * sizeof(uint32_t), data.data(),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT   |
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VMA_MEMORY_USAGE_GPU_TO_CPU,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        VK_SHARING_MODE_EXCLUSIVE
+    );
+}
+std::vector<uint32_t> read(shard::gfx::Buffer& buffer, uint32_t count){
+    std::vector<uint32_t> data(count);
+    std::memcpy(data.data(), buffer.mappedMemory(), count * sizeof(uint32_t));
+    return data;
+}
+
+int main(int argc, char** argv){
+    uint32_t count = argc > 1 ? uint32_t(std::atoi(argv[1])) : 1000003;
+
+    shard::gfx::Device device(nullptr);
+    std::cout << device.properties().deviceName << ", subgroup size " << device.subgroupSize()
+              << (device.subgroupArithmeticSupported() ? ", subgroup arithmetic\n" : "\n");
+
+    shard::randy::Random random(7);
+    std::vector<uint32_t> values(count);
+    for(auto& value : values) value = random.randi() % 1000;
+
+    int failures = 0;
+    auto report = [&failures](const char* name, bool passed){
+        std::cout << name << ": " << (passed ? "passed" : "FAILED") << "\n";
+        if(!passed) failures++;
+    };
+
+    {
+        gpu::Scan scan(device);
+        auto src = hostBuffer(device, values);
+        auto dst = hostBuffer(device, std::vector<uint32_t>(count));
+        scan.run(src, dst, count);
+
+        std::vector<uint32_t> expected(count);
+        std::exclusive_scan(values.begin(), values.end(), expected.begin(), 0u);
+        report("scan", read(dst, count) == expected);
+
+        scan.run(src, src, count);
+        report("scan in place", read(src, count) == expected);
+    }
+
+    {
+        const std::pair<gpu::ReduceOp, const char*> ops[] = {
+            {gpu::ReduceOp::ADD, "reduce add"},
+            {gpu::ReduceOp::MIN, "reduce min"},
+            {gpu::ReduceOp::MAX, "reduce max"},
+        };
+        uint32_t expected[] = {
+            std::accumulate(values.begin(), values.end(), 0u),
+            *std::min_element(values.begin(), values.end()),
+            *std::max_element(values.begin(), values.end()),
+        };
+
+        auto src = hostBuffer(device, values);
+        auto result = hostBuffer(device, {0});
+        for(size_t i = 0; i < 3; i++){
+            gpu::Reduce reduce(device, ops[i].first);
+            reduce.run(src, result, count);
+            report(ops[i].second, read(result, 1)[0] == expected[i]);
+        }
+    }
+
+    {
+        std::vector<uint32_t> flags(count);
+        std::vector<uint32_t> expected;
+        for(uint32_t i = 0; i < count; i++){
+            flags[i] = random.randi() % 3 == 0;
+            if(flags[i]) expected.push_back(values[i]);
+        }
+
+        gpu::Compact compact(device);
+        auto src = hostBuffer(device, values);
+        auto flagBuffer = hostBuffer(device, flags);
+        auto dst = hostBuffer(device, std::vector<uint32_t>(count));
+        auto outCount = hostBuffer(device, {0});
+        compact.run(src, flagBuffer, dst, outCount, count);
+
+        uint32_t kept = read(outCount, 1)[0];
+        report("compact", kept == expected.size() && read(dst, kept) == expected);
+    }
+
+    {
+        gpu::RadixSort sort(device);
+        for(uint32_t keyBits : {32u, 12u}){
+            std::vector<uint32_t> keys(count);
+            for(auto& key : keys) key = keyBits == 32 ? random.randi() : random.randi() % (1u << keyBits);
+
+            // Values hold the original index so stability is checked too
+            std::vector<uint32_t> indices(count);
+            std::iota(indices.begin(), indices.end(), 0u);
+            auto keyBuffer = hostBuffer(device, keys);
+            auto valueBuffer = hostBuffer(device, indices);
+            sort.run(keyBuffer, valueBuffer, count, keyBits);
+
+            std::stable_sort(indices.begin(), indices.end(), [&keys](uint32_t a, uint32_t b){
+                return keys[a] < keys[b];
+            });
+            std::vector<uint32_t> sortedKeys(count);
+            for(uint32_t i = 0; i < count; i++) sortedKeys[i] = keys[indices[i]];
+
+            report(
+                keyBits == 32 ? "radix sort" : "radix sort 12 bit",
+                read(keyBuffer, count) == sortedKeys && read(valueBuffer, count) == indices
+            );
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}
\ No newline at end of file
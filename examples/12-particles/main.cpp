@@ -0,0 +1,105 @@
+#include <shard/gfx/gfx.hpp>
+#include <shard/gfx/particleSystem.hpp>
+#include <shard/time/time.hpp>
+
+#include <cstring>
+#include <cstdlib>
+
+// Usage: 12.out [particle count] [--sorted]
+// A fountain kept close to the given number of particles, --sorted draws them back
+// to front. After the first frame the CPU only sets the camera and emitter.
+
+struct Camera{
+    static constexpr VkShaderStageFlags stages = VK_SHADER_STAGE_VERTEX_BIT;
+    glm::mat4 viewProj;
+    glm::vec4 right;
+    glm::vec4 up;
+};
+using CameraPush = shard::gfx::PushConstants<Camera>;
+
+int main(int argc, char** argv){
+    uint32_t particleCount = argc > 1 ? uint32_t(std::atoi(argv[1])) : 1000000;
+    bool sorted = argc > 2 && std::strcmp(argv[2], "--sorted") == 0;
+
+    glfwInit();
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    GLFWwindow* window = glfwCreateWindow(1280, 720, "12-particles", NULL, NULL);
+    shard::gfx::Graphics gfx(window, false);
+
+    shard::gfx::ParticleSystem particles(gfx, particleCount, sorted);
+    auto& emitter = particles.emitter();
+    // -y is up, as in the other 3D examples
+    emitter.radius = 0.2f;
+    emitter.velocity = {0.0f, -12.0f, 0.0f};
+    emitter.velocitySpread = 3.0f;
+    emitter.acceleration = {0.0f, 9.8f, 0.0f};
+    emitter.drag = 0.1f;
+    emitter.startColor = {0.4f, 0.7f, 1.0f, 0.8f};
+    emitter.endColor = {1.0f, 1.0f, 1.0f, 0.0f};
+    emitter.startSize = 0.08f;
+    emitter.endSize = 0.2f;
+    emitter.lifetime = 3.0f;
+    emitter.lifetimeVariation = 0.5f;
+    // Fills about 90% of the capacity at the average lifetime
+    float averageLifetime = emitter.lifetime * (1.0f - 0.5f * emitter.lifetimeVariation);
+    emitter.rate = 0.9f * float(particleCount) / averageLifetime;
+
+    auto pipelineLayout = gfx.createPipelineLayout({CameraPush::range()}, {});
+
+    // Blended particles test against the depth buffer without writing it
+    shard::gfx::PipelineConfigInfo config = {};
+    config.makeDefault();
+    config.depthStencilInfo.depthWriteEnable = VK_FALSE;
+    auto pipeline = gfx.createPipeline(
+        pipelineLayout,
+        "examples/12-particles/particle.vert.spv", "examples/12-particles/particle.frag.spv",
+        {shard::gfx::ParticleSystem::bindingDesc(0)},
+        shard::gfx::ParticleSystem::attributeDescs(0),
+        config
+    );
+
+    shard::Time time = {};
+    float reportTimer = 0.0f;
+    while(!glfwWindowShouldClose(window)){
+        glfwPollEvents();
+        shard::time::updateTime(time);
+
+        reportTimer += time.dt;
+        if(reportTimer >= 1.0f){
+            std::cout << particleCount << " particles" << (sorted ? " sorted, " : ", ") << time.fps << " fps\n";
+            reportTimer = 0.0f;
+        }
+
+        VkExtent2D extent = shard::getWindowExtent(window);
+        float angle = time.elapsed * 0.2f;
+        glm::vec3 eye = glm::vec3(std::cos(angle) * 14.0f, -4.0f, std::sin(angle) * 14.0f);
+        glm::vec3 target = glm::vec3(0.0f, -5.0f, 0.0f);
+        glm::mat4 view = glm::lookAt(eye, target, glm::vec3(0.0f, -1.0f, 0.0f));
+        glm::mat4 proj = glm::perspective(
+            glm::radians(60.0f), float(extent.width)/float(extent.height), 0.1f, 100.0f
+        );
+
+        Camera camera = {};
+        camera.viewProj = proj * view;
+        camera.right = glm::vec4(view[0][0], view[1][0], view[2][0], 0.0f);
+        camera.up = glm::vec4(view[0][1], view[1][1], view[2][1], 0.0f);
+        particles.setCamera(eye, 40.0f);
+
+        if(auto commandBuffer = gfx.beginRenderPass([&](VkCommandBuffer cmd){
+            particles.update(cmd, time.dt);
+        }, {10.0f})){
+            pipeline.bind(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS);
+            CameraPush::push(commandBuffer, pipelineLayout, camera);
+            particles.draw(commandBuffer, 0);
+
+            gfx.endRenderPass();
+        }
+    }
+    gfx.device().waitIdle();
+    gfx.destroyPipelineLayout(pipelineLayout);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+
+    return 0;
+}
\ No newline at end of file
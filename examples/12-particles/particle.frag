@@ -0,0 +1,12 @@
+#version 450
+
+layout (location = 0) in vec2 inUv;
+layout (location = 1) in vec4 inColor;
+
+layout (location = 0) out vec4 outColor;
+
+void main(){
+    // Soft round sprite
+    float falloff = 1.0 - smoothstep(0.5, 1.0, length(inUv));
+    outColor = vec4(inColor.rgb, inColor.a * falloff);
+}
\ No newline at end of file
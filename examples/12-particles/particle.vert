@@ -0,0 +1,29 @@
+#version 450
+
+// Per instance, ParticleSystem::Instance
+layout (location = 0) in vec4 inPositionSize;
+layout (location = 1) in vec4 inColor;
+
+layout (location = 0) out vec2 outUv;
+layout (location = 1) out vec4 outColor;
+
+layout (push_constant) uniform Camera {
+    mat4 viewProj;
+    vec4 right;
+    vec4 up;
+} camera;
+
+// Two triangles facing the camera
+const vec2 corners[6] = vec2[](
+    vec2(-1.0, -1.0), vec2( 1.0, -1.0), vec2( 1.0,  1.0),
+    vec2( 1.0,  1.0), vec2(-1.0,  1.0), vec2(-1.0, -1.0)
+);
+
+void main(){
+    vec2 corner = corners[gl_VertexIndex];
+    vec3 world = inPositionSize.xyz +
+        (camera.right.xyz * corner.x + camera.up.xyz * corner.y) * inPositionSize.w * 0.5;
+    gl_Position = camera.viewProj * vec4(world, 1.0);
+    outUv = corner;
+    outColor = inColor;
+}
\ No newline at end of file
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <string>
+
+#include "model.hpp"
+#include "meshFile.hpp"
+#include "../job/threadPool.hpp"
+
+namespace shard{
+    namespace gfx{
+        enum class AssetStatus{
+            PENDING,
+            READY,
+            FAILED,
+        };
+
+        struct TextureHandle{ uint32_t index = UINT32_MAX; };
+        struct ModelHandle  { uint32_t index = UINT32_MAX; };
+
+        // Loads textures (KTX2/PNG/JPG/...) and OBJ models in the background.
+        // Files are decoded on a worker pool, decoded data is handed to a single upload
+        // thread which stages as much as fits in the staging budget, records every copy
+        // into one command buffer and submits it with its own command pool.
+        // The loader itself must only be used from the render thread, handles resolve to
+        // placeholders until update() picks up their finished upload.
+        class AssetLoader{
+            public:
+                // workerCount 0 uses every hardware thread except the calling one
+                AssetLoader(
+                    Graphics& _gfx,
+                    uint32_t workerCount = 0,
+                    size_t stagingBudget = 64 * 1024 * 1024
+                );
+                ~AssetLoader();
+
+                shard_delete_copy_constructors(AssetLoader);
+
+                TextureHandle loadTexture(const char* filePath);
+                ModelHandle   loadModel(const char* filePath);
+
+                // Publishes finished uploads, call once per frame.
+                // Returns the number of assets that became ready or failed.
+                uint32_t update();
+                // Blocks until every requested asset is finished, then calls update()
+                void waitIdle();
+
+                AssetStatus status(TextureHandle handle) const;
+                AssetStatus status(ModelHandle handle) const;
+                bool ready(TextureHandle handle) const { return status(handle) == AssetStatus::READY; }
+                bool ready(ModelHandle handle)   const { return status(handle) == AssetStatus::READY; }
+
+                // Resolve to the placeholders while the asset is pending or failed
+                Image& texture(TextureHandle handle);
+                Model& model(ModelHandle handle);
+
+                Image& placeholderTexture() { return *_placeholderTexture; }
+                Model& placeholderModel()   { return *_placeholderModel; }
+                // Assets requested but not yet published by update()
+                uint32_t pendingCount() const { return _pendingCount; }
+            private:
+                enum class AssetKind{ TEXTURE, MODEL };
+
+                struct StbiDeleter{
+                    void operator()(stbi_uc* pixels) const { stbi_image_free(pixels); }
+                };
+                struct Decoded{
+                    AssetKind kind;
+                    uint32_t index;
+                    bool failed = false;
+
+                    // Textures are either a KTX2 file or RGBA8 pixels
+                    bool isKtx2 = false;
+                    ktx2::Texture ktx2;
+                    std::unique_ptr<stbi_uc, StbiDeleter> pixels;
+                    uint32_t width = 0;
+                    uint32_t height = 0;
+
+                    // Models are read from their mapped .smesh cache, or parsed into
+                    // vertices/indices if the cache is unavailable
+                    MeshFile mesh;
+                    std::vector<Vertex3D> vertices;
+                    std::vector<uint32_t> indices;
+
+                    const Vertex3D* vertexData() const { return mesh.valid() ? mesh.vertices() : vertices.data(); }
+                    const uint32_t* indexData()  const { return mesh.valid() ? mesh.indices()  : indices.data(); }
+                    uint32_t vertexCount() const {
+                        return mesh.valid() ? mesh.vertexCount() : static_cast<uint32_t>(vertices.size());
+                    }
+                    uint32_t indexCount() const {
+                        return mesh.valid() ? mesh.indexCount() : static_cast<uint32_t>(indices.size());
+                    }
+                    VkIndexType indexType() const { return selectIndexType(vertexCount()); }
+
+                    size_t stagingSize() const;
+                };
+                struct Uploaded{
+                    AssetKind kind;
+                    uint32_t index;
+                    std::unique_ptr<Image> image;
+                    std::unique_ptr<Model> model;
+                };
+                struct TextureSlot{
+                    AssetStatus status = AssetStatus::PENDING;
+                    std::unique_ptr<Image> image;
+                };
+                struct ModelSlot{
+                    AssetStatus status = AssetStatus::PENDING;
+                    std::unique_ptr<Model> model;
+                };
+
+                void decode(AssetKind kind, uint32_t index, const std::string& filePath);
+                void uploadLoop();
+                void upload(std::vector<Decoded>& batch);
+                void publish(Uploaded&& uploaded);
+
+                void createPlaceholders();
+
+                Graphics& gfx;
+                size_t stagingBudget;
+
+                std::vector<TextureSlot> textures;
+                std::vector<ModelSlot> models;
+                std::unique_ptr<Image> _placeholderTexture;
+                std::unique_ptr<Model> _placeholderModel;
+                uint32_t _pendingCount = 0;
+
+                // Upload thread state
+                VkCommandPool commandPool = VK_NULL_HANDLE;
+                VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+                VkFence uploadFence = VK_NULL_HANDLE;
+                std::thread uploadThread;
+
+                std::mutex uploadMutex;
+                std::condition_variable uploadCondition;
+                std::deque<Decoded> decodedQueue;
+
+                std::mutex completedMutex;
+                std::condition_variable completedCondition;
+                std::vector<Uploaded> completedQueue;
+
+                std::atomic<bool> stopping = false;
+                // Declared last so the workers are joined before anything they touch is destroyed
+                job::ThreadPool pool;
+        };
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
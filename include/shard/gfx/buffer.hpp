@@ -66,6 +66,9 @@ namespace shard{
                     vkCmdBindIndexBuffer(commandBuffer, _buffer, 0, type);
                 }
                 VkResult flush(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+                // Frees the buffer without going through the deletion queue, for buffers
+                // only used by a submit that has already been waited on, such as staging
+                void destroyNow();
 
                 bool valid() const {
                     return
@@ -89,6 +92,7 @@ namespace shard{
                     return instanceSize;
                 }
             private:
+                void destroy();
                 void createBuffer(
                     const void* data,
                     VkBufferUsageFlags usage,
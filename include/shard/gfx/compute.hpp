@@ -1,15 +1,28 @@
 #pragma once
 
+#include <map>
+#include <memory>
+
 #include "shaderModule.hpp"
+#include "specialization.hpp"
 
 namespace shard{
     namespace gfx{
         class Compute{
             public:
                 Compute(Device& device);
-                Compute(Device& device, VkPipelineLayout layout, const char* filePath);
-                Compute(Device& device, VkPipelineLayout layout, const std::vector<char>& shaderSPV);
-                Compute(Device& device, VkPipelineLayout layout, ShaderModule& shader);
+                Compute(
+                    Device& device, VkPipelineLayout layout, const char* filePath,
+                    const SpecializationConstants& constants = {}
+                );
+                Compute(
+                    Device& device, VkPipelineLayout layout, const std::vector<char>& shaderSPV,
+                    const SpecializationConstants& constants = {}
+                );
+                Compute(
+                    Device& device, VkPipelineLayout layout, ShaderModule& shader,
+                    const SpecializationConstants& constants = {}
+                );
                 Compute(Compute&  c);
                 Compute(Compute&& c);
                 ~Compute();
@@ -23,17 +36,47 @@ namespace shard{
                 void dispatch(VkCommandBuffer cmd, uint32_t x, uint32_t y, uint32_t z=1){
                     vkCmdDispatch(cmd, x, y, z);
                 }
+                // The group counts are read from a VkDispatchIndirectCommand in buffer,
+                // which needs VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT
+                void dispatchIndirect(VkCommandBuffer cmd, VkBuffer buffer, VkDeviceSize offset = 0){
+                    vkCmdDispatchIndirect(cmd, buffer, offset);
+                }
 
                 VkPipeline       pipeline()       { return _pipeline; }
                 const VkPipeline pipeline() const { return _pipeline; }
+
+                // preferred clamped to the device's x workgroup size and invocation limits,
+                // pass it to a local_size_x_id constant
+                static uint32_t clampWorkgroupSize(Device& device, uint32_t preferred);
             private:
+                void destroy();
                 void init(
                     VkPipelineLayout layout,
-                    ShaderModule& shader
+                    ShaderModule& shader,
+                    const SpecializationConstants& constants
                 );
 
                 Device& device;
                 VkPipeline _pipeline;
         };
+
+        // One compute shader specialized on demand, the module is loaded once and
+        // every distinct set of constants is compiled once
+        class ComputePermutations{
+            public:
+                ComputePermutations(Device& _device, VkPipelineLayout _layout, const char* filePath);
+
+                shard_delete_copy_constructors(ComputePermutations);
+
+                Compute& get(const SpecializationConstants& constants);
+
+                const ShaderModule& shader() const { return _shader; }
+                size_t size() const { return permutations.size(); }
+            private:
+                Device& device;
+                VkPipelineLayout layout;
+                ShaderModule _shader;
+                std::map<std::vector<uint64_t>, std::unique_ptr<Compute>> permutations;
+        };
     } // namespace gfx
 } // namespace shard
@@ -145,6 +145,8 @@ namespace shard{
 
                 void reset();
             private:
+                void destroy();
+
                 Device& device;
                 VkDescriptorPool _pool;
                 std::map<VkDescriptorType, uint32_t> sizeCounts;
@@ -165,6 +167,10 @@ namespace shard{
                 DescriptorWriter& writeImage(
                     uint32_t binding, VkDescriptorImageInfo* imageInfo
                 );
+                // Writes every element of an array binding
+                DescriptorWriter& writeImages(
+                    uint32_t binding, VkDescriptorImageInfo* imageInfos, uint32_t count
+                );
 
                 void build(VkDescriptorSet& set);
                 void overwrite(VkDescriptorSet& set);
@@ -1,6 +1,10 @@
 #pragma once
 
 #include <optional>
+#include <memory>
+#include <deque>
+#include <mutex>
+#include <functional>
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
@@ -38,8 +42,12 @@ namespace shard{
             }
         };
 
+        class LayoutCache;
+
         class Device{
             public:
+                // A null window creates a headless device for compute work. It has no
+                // surface or swapchain extension and presentQueue() is the graphics queue.
                 Device(GLFWwindow* win);
                 ~Device();
 
@@ -60,11 +68,52 @@ namespace shard{
                 }
                 VmaAllocator allocator() { return _allocator; }
                 GLFWwindow* window() { return _window; }
+                bool headless() const { return _window == nullptr; }
+
+                // VK_KHR_present_id and VK_KHR_present_wait are enabled when available
+                bool presentWaitSupported() const { return _presentWaitSupported; }
+                VkResult waitForPresent(VkSwapchainKHR swapchain, uint64_t presentId, uint64_t timeout);
+                // Indirect draw features, enabled when available
+                bool multiDrawIndirectSupported() const { return _multiDrawIndirectSupported; }
+                bool drawIndirectCountSupported() const { return _drawIndirectCountSupported; }
+                // Subgroup arithmetic in compute shaders (GL_KHR_shader_subgroup_arithmetic)
+                bool subgroupArithmeticSupported() const { return _subgroupArithmeticSupported; }
+                uint32_t subgroupSize() const { return _subgroupSize; }
+
+                // Deduplicated set and pipeline layouts shared by everything built on this
+                // device, see LayoutCache::reflect. Not thread safe, like the rest of the
+                // recording side.
+                LayoutCache& layoutCache();
 
                 void waitIdle(){
+                    std::lock_guard<std::mutex> lock(queueMutex);
                     vkDeviceWaitIdle(_device);
                 }
 
+                // Queues are externally synchronized and may alias each other, every
+                // submission from any thread goes through these.
+                VkResult queueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo* submits, VkFence fence);
+                VkResult queuePresent(const VkPresentInfoKHR* presentInfo);
+                VkResult queueWaitIdle(VkQueue queue);
+
+                // Deferred deletion
+                // Destroying a handle right away would break frames in flight that still
+                // reference it, so resources hand their destruction to deferDestroy.
+                // Every submitted frame is stamped with a frame value. Destroy callbacks
+                // are queued with the value of the frame being recorded and only run
+                // once that frame's fence has signalled. Garbage is collected as frames are
+                // acquired and after every single time submit. Headless devices count each
+                // single time submit as a frame, as does Graphics::submitComputeCommands
+                // while no frame is in flight, so anything deferred before them must not be
+                // used by command buffers that are still to be submitted.
+                uint64_t frameValue();
+                uint64_t completedFrameValue();
+                void deferDestroy(std::function<void()>&& destroy);
+                void advanceFrame();
+                void collectGarbage(uint64_t completedValue);
+                // Runs every queued callback, the device must be idle.
+                void flushDeletionQueue();
+
                 SwapchainSupportDetails getSwapchainSupportDetails(){
                     return SwapchainSupportDetails(_pDevice, _surface);
                 }
@@ -103,6 +152,7 @@ namespace shard{
                 bool checkValidationLayerSupport();
                 bool checkGlfwRequiredExtensionSupport(const std::vector<const char*>& exts);
                 bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+                bool checkOptionalDeviceExtensionSupport(VkPhysicalDevice device, const char* extension);
 
                 VkInstance _instance;
                 VkPhysicalDevice _pDevice = VK_NULL_HANDLE;
@@ -110,13 +160,35 @@ namespace shard{
                 VkCommandPool _commandPool;
 
                 VkDevice _device;
-                VkSurfaceKHR _surface;
+                VkSurfaceKHR _surface = VK_NULL_HANDLE;
                 VkQueue _graphicsQueue;
                 VkQueue _computeQueue;
                 VkQueue _presentQueue;
 
                 VmaAllocator _allocator;
 
+                bool _presentWaitSupported = false;
+                bool _multiDrawIndirectSupported = false;
+                bool _drawIndirectCountSupported = false;
+                bool _subgroupArithmeticSupported = false;
+                uint32_t _subgroupSize = 1;
+            #if defined(VK_KHR_present_wait)
+                PFN_vkWaitForPresentKHR _vkWaitForPresentKHR = nullptr;
+            #endif
+
+                std::unique_ptr<LayoutCache> _layoutCache;
+
+                std::mutex queueMutex;
+
+                struct DeferredDeletion{
+                    uint64_t frameValue;
+                    std::function<void()> destroy;
+                };
+                std::mutex deletionMutex;
+                std::deque<DeferredDeletion> deletionQueue;
+                uint64_t _frameValue = 1;
+                uint64_t _completedFrameValue = 0;
+
                 const std::vector<const char *> validationLayers = {"VK_LAYER_KHRONOS_validation"};
                 const std::vector<const char *> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
         };
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <chrono>
+#include <array>
+#include <vector>
+
+#include "swapchain.hpp"
+
+namespace shard{
+    namespace gfx{
+        // Timings of a single frame in seconds
+        struct FrameTiming{
+            float frameTime   = 0.0f; // beginFrame to beginFrame
+            float cpuTime     = 0.0f; // beginFrame (after pacing) to endFrame
+            float limiterWait = 0.0f; // time spent in the frame limiter
+            float presentWait = 0.0f; // time spent in vkWaitForPresentKHR
+            float fenceWait   = 0.0f; // time acquireNextImage spent waiting on the frame fence
+        };
+        // Frame time statistics in milliseconds
+        struct FrameStats{
+            float average = 0.0f;
+            float p50     = 0.0f;
+            float p95     = 0.0f;
+            float p99     = 0.0f;
+            float max     = 0.0f;
+        };
+
+        // Caps the frame rate by sleeping most of the remaining frame time and spinning
+        // for the rest, which gives sub millisecond accuracy regardless of the OS timer
+        // resolution.
+        class FrameLimiter{
+            public:
+                using Clock = std::chrono::steady_clock;
+
+                FrameLimiter(){}
+
+                // 0 disables the limiter
+                void setTargetFrameRate(float fps);
+                float targetFrameRate() const { return _targetFrameRate; }
+                // Returns the time spent waiting in seconds
+                float wait();
+            private:
+                float _targetFrameRate = 0.0f;
+                Clock::duration period = Clock::duration::zero();
+                Clock::time_point nextFrame = {};
+                // Estimated oversleep of the OS scheduler, the limiter spins for this long
+                Clock::duration sleepSlack = std::chrono::milliseconds(1);
+        };
+
+        class FramePacer{
+            public:
+                using Clock = FrameLimiter::Clock;
+                static constexpr size_t HISTORY_SIZE = 256;
+
+                FramePacer(){}
+
+                void setTargetFrameRate(float fps) { limiter.setTargetFrameRate(fps); }
+                float targetFrameRate() const { return limiter.targetFrameRate(); }
+                // Maximum number of presents that may be queued ahead of the display when
+                // VK_KHR_present_wait is available, lower values reduce input latency.
+                // 0 disables present waiting.
+                void setMaxQueuedPresents(uint32_t count) { maxQueuedPresents = count; }
+                uint32_t maxQueuedPresentCount() const { return maxQueuedPresents; }
+
+                // Called by Graphics around every frame
+                void beginFrame(Swapchain& swapchain);
+                void endFrame(Swapchain& swapchain);
+
+                const FrameTiming& lastFrame() const { return last; }
+                // Timings of the last HISTORY_SIZE frames, oldest first
+                std::vector<FrameTiming> history() const;
+                FrameStats frameTimeStats() const;
+                FrameStats cpuTimeStats() const;
+            private:
+                FrameStats calculateStats(float FrameTiming::* field) const;
+
+                FrameLimiter limiter;
+                uint32_t maxQueuedPresents = 0;
+
+                Clock::time_point frameStart = {};
+                FrameTiming current = {};
+                FrameTiming last = {};
+
+                std::array<FrameTiming, HISTORY_SIZE> timings = {};
+                size_t timingCount = 0;
+                size_t timingHead = 0;
+        };
+    } // namespace gfx
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
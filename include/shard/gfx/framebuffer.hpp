@@ -37,6 +37,7 @@ namespace shard{
                 VkExtent2D extent() const { return _extent; }
                 bool valid() const { return _framebuffer != VK_NULL_HANDLE; }
             private:
+                void destroy();
                 void createFramebuffer(
                     const std::vector<VkImageView>& attachments,
                     VkExtent2D extent_, VkRenderPass renderPass
@@ -10,12 +10,18 @@
 
 #include "device.hpp"
 #include "swapchain.hpp"
+#include "framePacer.hpp"
 #include "pipeline.hpp"
+#include "pushConstants.hpp"
 #include "compute.hpp"
 #include "vertex.hpp"
+#include "modelLoader.hpp"
 #include "buffer.hpp"
 #include "descriptor.hpp"
 #include "image.hpp"
+#include "mipGenerator.hpp"
+#include "layoutCache.hpp"
+#include "shaderReloader.hpp"
 #include "color.hpp"
 
 // Thanks to Brendan Galea for the free init code and for getting me started on vulkan
@@ -29,7 +35,9 @@ namespace shard{
 
         class Graphics{
             public:
+                // vsync selects MAILBOX (falling back to FIFO), otherwise IMMEDIATE
                 Graphics(GLFWwindow* win, bool vsync);
+                Graphics(GLFWwindow* win, PresentPolicy policy);
                 ~Graphics();
 
                 shard_delete_copy_constructors(Graphics);
@@ -38,6 +46,12 @@ namespace shard{
 
                 Device& device() { return *_device; };
                 Swapchain& swapchain() { return *_swapchain; }
+                FramePacer& framePacer() { return _framePacer; }
+                MipGenerator& mipGenerator();
+                // The device's layout cache, see Device::layoutCache
+                LayoutCache& layoutCache();
+                // Enables shader hot reload, rebuilt pipelines are swapped in by beginRenderPass
+                ShaderReloader& shaderReloader();
                 VkPipelineLayout emptyPipelineLayout() { return _emptyPipelineLayout; }
                 PipelineConfigInfo& deafultPipelineConfig() {
                     return _defaultPipelineConfig;
@@ -63,6 +77,8 @@ namespace shard{
                 VkCommandBuffer allocateComputeCommandBuffer();
                 void freeComputeCommandBuffer(VkCommandBuffer cmd);
                 VkResult beginComputeCommands(VkCommandBuffer cmd);
+                // Waits for the commands. Outside of a frame with no frames in flight this
+                // completes the current frame value, like a headless single time submit.
                 void submitComputeCommands(VkCommandBuffer cmd);
                 
                 ShaderModule createShaderModule(const char* filePath);
@@ -70,15 +86,18 @@ namespace shard{
 
                 Compute createCompute(
                     VkPipelineLayout layout,
-                    ShaderModule& shader
+                    ShaderModule& shader,
+                    const SpecializationConstants& constants = {}
                 );
                 Compute createCompute(
                     VkPipelineLayout layout,
-                    const char* filePath
+                    const char* filePath,
+                    const SpecializationConstants& constants = {}
                 );
                 Compute createCompute(
                     VkPipelineLayout layout,
-                    const std::vector<char> shaderSPV
+                    const std::vector<char> shaderSPV,
+                    const SpecializationConstants& constants = {}
                 );
                 Pipeline createPipeline(
                     VkPipelineLayout layout,
@@ -86,7 +105,8 @@ namespace shard{
                     ShaderModule& frag,
                     const std::vector<VkVertexInputBindingDescription>& bindingDescs,
                     const std::vector<VkVertexInputAttributeDescription>& attrDescs,
-                    PipelineConfigInfo& config
+                    PipelineConfigInfo& config,
+                    const SpecializationConstants& constants = {}
                 );
                 Pipeline createPipeline(
                     VkPipelineLayout layout,
@@ -94,7 +114,8 @@ namespace shard{
                     const char* fragFile,
                     const std::vector<VkVertexInputBindingDescription>& bindingDescs,
                     const std::vector<VkVertexInputAttributeDescription>& attrDescs,
-                    PipelineConfigInfo& config
+                    PipelineConfigInfo& config,
+                    const SpecializationConstants& constants = {}
                 );
                 Pipeline createPipeline(
                     VkPipelineLayout layout,
@@ -102,7 +123,8 @@ namespace shard{
                     const std::vector<char>& fragFile,
                     const std::vector<VkVertexInputBindingDescription>& bindingDescs,
                     const std::vector<VkVertexInputAttributeDescription>& attrDescs,
-                    PipelineConfigInfo& config
+                    PipelineConfigInfo& config,
+                    const SpecializationConstants& constants = {}
                 );
                 Buffer createVertexBuffer(size_t size, VkSharingMode sharingMode, const void* data);
                 Buffer createIndexBuffer(size_t size, VkSharingMode sharingMode, const void* data);
@@ -121,6 +143,9 @@ namespace shard{
                 Image createTexture(const char* filePath);
                 // Pixel format must be in VK_FORMAT_R8G8B8A8_BIT
                 Image createTexture(uint32_t w, uint32_t h, const void* pixels);
+                // Generates mip maps with compute instead of blits, see MipGenerator
+                Image createTexture(const char* filePath, MipFilter filter);
+                Image createTexture(uint32_t w, uint32_t h, const void* pixels, MipFilter filter);
                 Image createImage(
                     uint32_t w, uint32_t h, uint32_t mipLevels,
                     VkFormat __format, VkImageTiling tiling,
@@ -159,6 +184,8 @@ namespace shard{
                 DescriptorSetLayout::Builder createDescriptorSetLayoutBuilder();
 
                 void setVsync(bool _vsync);
+                void setPresentPolicy(PresentPolicy policy);
+                PresentPolicy presentPolicy() const { return _presentPolicy; }
 
                 VkCommandBuffer beginRenderPass(
                     std::function<void(VkCommandBuffer)> preRenderPassCommands, const Color& clearColor
@@ -172,11 +199,14 @@ namespace shard{
 
                 void destroyCommandBuffers();
 
-                bool VSYNC;
+                PresentPolicy _presentPolicy;
+                FramePacer _framePacer;
                 GLFWwindow* _window;
                 PipelineConfigInfo _defaultPipelineConfig;
                 std::unique_ptr<Device> _device;
                 std::unique_ptr<Swapchain> _swapchain;
+                std::unique_ptr<MipGenerator> _mipGenerator;
+                std::unique_ptr<ShaderReloader> _shaderReloader;
                 VkCommandPool _computeCommandPool;
 
                 bool isFrameStarted = false;
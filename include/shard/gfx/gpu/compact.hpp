@@ -0,0 +1,54 @@
+#pragma once
+
+#include "scan.hpp"
+
+namespace shard{
+    namespace gfx{
+        namespace gpu{
+            // Stream compaction, keeps the uint32 values whose flag is set in their
+            // original order
+            class Compact{
+                public:
+                    Compact(Device& _device);
+
+                    shard_delete_copy_constructors(Compact);
+
+                    // flags must be 0 or 1, the kept values are written to the front of dst
+                    // and their number to outCount[0]. count must not be 0.
+                    void record(
+                        VkCommandBuffer commandBuffer, Buffer& values, Buffer& flags,
+                        Buffer& dst, Buffer& outCount, uint32_t count
+                    );
+                    // Blocking, records into a single time command buffer
+                    void run(Buffer& values, Buffer& flags, Buffer& dst, Buffer& outCount, uint32_t count);
+                private:
+                    struct Params{
+                        uint32_t count;
+                        uint32_t groupCount;
+                    };
+
+                    Device& device;
+                    Scan scan;
+                    Kernel scatter;
+                    FramePools pools;
+                    Buffer offsets;
+            };
+        } // namespace gpu
+    } // namespace gfx
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "../device.hpp"
+#include "../buffer.hpp"
+#include "../compute.hpp"
+#include "../descriptor.hpp"
+
+namespace shard{
+    namespace gfx{
+        namespace gpu{
+            // One of the shaders/gpu kernels, every binding is a storage buffer. The layouts
+            // come from the device's layout cache. Kernels with a subgroup variant load it
+            // when the device supports subgroup arithmetic.
+            class Kernel{
+                public:
+                    static constexpr uint32_t PREFERRED_WORKGROUP_SIZE = 256;
+                    static constexpr uint32_t MAX_BUFFERS = 5;
+
+                    Kernel(
+                        Device& _device, const char* name, uint32_t _bufferCount,
+                        uint32_t _pushSize, bool subgroupVariant,
+                        const SpecializationConstants& constants = {}
+                    );
+
+                    shard_delete_copy_constructors(Kernel);
+
+                    // groupCount is split over x and y past maxComputeWorkGroupCount[0],
+                    // push must match the kernel's push constant block
+                    void dispatch(
+                        VkCommandBuffer commandBuffer, DescriptorPool& pool,
+                        const std::vector<VkDescriptorBufferInfo>& buffers,
+                        const void* push, uint32_t groupCount
+                    );
+                    // The group count is read from a VkDispatchIndirectCommand in args, which
+                    // needs VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT. The x count alone must fit
+                    // maxComputeWorkGroupCount[0].
+                    void dispatchIndirect(
+                        VkCommandBuffer commandBuffer, DescriptorPool& pool,
+                        const std::vector<VkDescriptorBufferInfo>& buffers,
+                        const void* push, VkBuffer args, VkDeviceSize offset = 0
+                    );
+
+                    uint32_t workgroupSize() const { return _workgroupSize; }
+                    bool usesSubgroups() const { return _usesSubgroups; }
+
+                    // Makes shader and transfer writes visible to the following commands and, once
+                    // the command buffer has completed, to the host
+                    static void barrier(VkCommandBuffer commandBuffer);
+                    // Grows a GPU only storage buffer to at least size bytes, the contents are
+                    // not preserved
+                    static void reserve(Device& device, Buffer& buffer, VkDeviceSize size);
+                private:
+                    void bind(
+                        VkCommandBuffer commandBuffer, DescriptorPool& pool,
+                        const std::vector<VkDescriptorBufferInfo>& buffers, const void* push
+                    );
+
+                    Device& device;
+                    uint32_t bufferCount;
+                    uint32_t pushSize;
+                    uint32_t _workgroupSize;
+                    bool _usesSubgroups;
+
+                    DescriptorSetLayout& setLayout; // owned by the layout cache
+                    VkPipelineLayout layout = VK_NULL_HANDLE;
+                    Compute compute;
+            };
+
+            // Descriptor pools for the kernel dispatches of one object. Pools are tied to the
+            // frame value they were handed out in and reset for reuse once it has completed,
+            // so a steady loop keeps about one pool per frame in flight.
+            class FramePools{
+                public:
+                    static constexpr uint32_t MIN_SETS = 16;
+
+                    FramePools(Device& _device): device{_device} {}
+
+                    shard_delete_copy_constructors(FramePools);
+
+                    // A pool with room for setCount more dispatches in the frame being recorded
+                    DescriptorPool& get(uint32_t setCount);
+                private:
+                    struct Entry{
+                        std::unique_ptr<DescriptorPool> pool;
+                        uint32_t capacity;
+                        uint32_t used;
+                        uint64_t frameValue;
+                    };
+
+                    Device& device;
+                    std::vector<Entry> entries;
+            };
+
+            inline uint32_t divideRoundUp(uint32_t a, uint32_t b){
+                return (a + b - 1) / b;
+            }
+        } // namespace gpu
+    } // namespace gfx
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "scan.hpp"
+
+namespace shard{
+    namespace gfx{
+        namespace gpu{
+            // Stable least significant digit radix sort of uint32 keys with uint32
+            // values, 4 bits per pass. Each pass builds per workgroup digit histograms,
+            // scans them and scatters every block after sorting it in shared memory.
+            class RadixSort{
+                public:
+                    static constexpr uint32_t RADIX_BITS = 4;
+                    static constexpr uint32_t RADIX = 1 << RADIX_BITS;
+
+                    RadixSort(Device& _device);
+
+                    shard_delete_copy_constructors(RadixSort);
+
+                    // Sorts ascending, keys must fit in keyBits bits and every 4 bits less
+                    // saves a pass. keys and values also need VK_BUFFER_USAGE_TRANSFER_DST_BIT
+                    // when the pass count is odd.
+                    void record(
+                        VkCommandBuffer commandBuffer, Buffer& keys, Buffer& values,
+                        uint32_t count, uint32_t keyBits = 32
+                    );
+                    // Sorts the first groups * workgroupSize() elements, capped at maxCount, with
+                    // groups read as a VkDispatchIndirectCommand from args at argsOffset. Keys past
+                    // the real count must sort last, the scans still cover maxCount.
+                    void recordIndirect(
+                        VkCommandBuffer commandBuffer, Buffer& keys, Buffer& values, uint32_t maxCount,
+                        Buffer& args, VkDeviceSize argsOffset, uint32_t keyBits = 32
+                    );
+                    // Blocking, records into a single time command buffer
+                    void run(Buffer& keys, Buffer& values, uint32_t count, uint32_t keyBits = 32);
+
+                    uint32_t workgroupSize() const { return scatter.workgroupSize(); }
+                    bool usesSubgroups() const { return scatter.usesSubgroups(); }
+                private:
+                    struct Params{
+                        uint32_t count;
+                        uint32_t groupCount;
+                        uint32_t shift;
+                    };
+
+                    // args is VK_NULL_HANDLE for direct dispatches of every group
+                    void recordPasses(
+                        VkCommandBuffer commandBuffer, Buffer& keys, Buffer& values,
+                        uint32_t count, uint32_t keyBits, VkBuffer args, VkDeviceSize argsOffset
+                    );
+
+                    Device& device;
+                    Kernel histogram;
+                    Kernel scatter;
+                    Scan scan;
+                    FramePools pools;
+                    Buffer histograms;
+                    // Scanned histograms, kept apart so undispatched groups still count zero
+                    Buffer offsets;
+                    Buffer tmpKeys;
+                    Buffer tmpValues;
+            };
+        } // namespace gpu
+    } // namespace gfx
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
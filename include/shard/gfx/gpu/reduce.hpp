@@ -0,0 +1,61 @@
+#pragma once
+
+#include "kernel.hpp"
+
+namespace shard{
+    namespace gfx{
+        namespace gpu{
+            enum class ReduceOp : uint32_t{
+                ADD,
+                MIN,
+                MAX,
+            };
+
+            // Reduces uint32 values to a single value, each pass shrinks the input by
+            // workgroupSize * ITEMS_PER_THREAD
+            class Reduce{
+                public:
+                    static constexpr uint32_t ITEMS_PER_THREAD = 4;
+
+                    Reduce(Device& _device, ReduceOp _op = ReduceOp::ADD);
+
+                    shard_delete_copy_constructors(Reduce);
+
+                    // Writes the result to result[0], count must not be 0
+                    void record(VkCommandBuffer commandBuffer, Buffer& src, Buffer& result, uint32_t count);
+                    // Blocking, records into a single time command buffer
+                    void run(Buffer& src, Buffer& result, uint32_t count);
+
+                    ReduceOp op() const { return _op; }
+                    bool usesSubgroups() const { return kernel.usesSubgroups(); }
+                private:
+                    struct Params{
+                        uint32_t count;
+                        uint32_t groupCount;
+                    };
+
+                    Device& device;
+                    ReduceOp _op;
+                    Kernel kernel;
+                    FramePools pools;
+                    Buffer partials[2];
+            };
+        } // namespace gpu
+    } // namespace gfx
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
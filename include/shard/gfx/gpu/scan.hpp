@@ -0,0 +1,63 @@
+#pragma once
+
+#include "kernel.hpp"
+
+namespace shard{
+    namespace gfx{
+        namespace gpu{
+            // Exclusive prefix sum of uint32 values. Each workgroup scans a block of
+            // workgroupSize * ITEMS_PER_THREAD values, the block totals are scanned
+            // recursively and added back.
+            class Scan{
+                public:
+                    static constexpr uint32_t ITEMS_PER_THREAD = 4;
+
+                    Scan(Device& _device);
+
+                    shard_delete_copy_constructors(Scan);
+
+                    // src and dst may be the same buffer
+                    void record(VkCommandBuffer commandBuffer, Buffer& src, Buffer& dst, uint32_t count);
+                    // Blocking, records into a single time command buffer
+                    void run(Buffer& src, Buffer& dst, uint32_t count);
+
+                    uint32_t blockSize() const { return scan.workgroupSize() * ITEMS_PER_THREAD; }
+                    bool usesSubgroups() const { return scan.usesSubgroups(); }
+                private:
+                    struct Params{
+                        uint32_t count;
+                        uint32_t groupCount;
+                    };
+
+                    void recordLevel(
+                        VkCommandBuffer commandBuffer, DescriptorPool& pool,
+                        VkDescriptorBufferInfo src, VkDescriptorBufferInfo dst,
+                        uint32_t count, uint32_t level
+                    );
+
+                    Device& device;
+                    Kernel scan;
+                    Kernel add;
+                    FramePools pools;
+                    // Block totals of every level
+                    std::vector<Buffer> blockSums;
+            };
+        } // namespace gpu
+    } // namespace gfx
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cmath>
+
+#include "scan.hpp"
+
+namespace shard{
+    namespace gfx{
+        namespace gpu{
+            // Uniform grid over 2D points hashed into a power of two table, rebuilt with a
+            // count, scan and scatter pass. A bucket's point indices are
+            // indices[cellStarts[b], cellStarts[b] + cellCounts[b]). With cells as wide as
+            // the search radius a query only visits the 3x3 cells around a point, see
+            // shaders/gpu/spatialHash.glsl. Buckets can hold points of several cells, so
+            // queries must still test the distance.
+            class SpatialHash{
+                public:
+                    // The same grid built on the CPU, indices within a bucket are ascending
+                    struct Reference{
+                        std::vector<uint32_t> cellStarts;
+                        std::vector<uint32_t> cellCounts;
+                        std::vector<uint32_t> indices;
+                        float inverseCellSize = 1.0f;
+
+                        void build(
+                            const float* positions, uint32_t count, float cellSize,
+                            uint32_t tableSize, uint32_t stride = 2, uint32_t offset = 0
+                        );
+                        // Positions split into x and y arrays, as in a structure of arrays
+                        void build(
+                            const float* x, const float* y, uint32_t count, float cellSize,
+                            uint32_t tableSize, uint32_t stride = 1
+                        );
+
+                        // Calls f with every point index in the buckets around (x, y)
+                        template<typename F>
+                        void forEachCandidate(float x, float y, F&& f) const {
+                            uint32_t buckets[9];
+                            uint32_t count = neighbours(x, y, inverseCellSize, tableSize(), buckets);
+                            for(uint32_t i = 0; i < count; i++){
+                                uint32_t start = cellStarts[buckets[i]];
+                                for(uint32_t j = start; j < start + cellCounts[buckets[i]]; j++){
+                                    f(indices[j]);
+                                }
+                            }
+                        }
+
+                        uint32_t tableSize() const { return uint32_t(cellCounts.size()); }
+                    };
+
+                    // tableSize 0 picks the next power of two of capacity
+                    SpatialHash(Device& _device, uint32_t capacity, uint32_t tableSize = 0);
+
+                    shard_delete_copy_constructors(SpatialHash);
+
+                    // positions holds count points, the i-th at float index i * stride + offset,
+                    // so it can be an array of structs
+                    void record(
+                        VkCommandBuffer commandBuffer, Buffer& positions, uint32_t count,
+                        float cellSize, uint32_t stride = 2, uint32_t offset = 0
+                    );
+                    // Blocking, records into a single time command buffer
+                    void build(
+                        Buffer& positions, uint32_t count,
+                        float cellSize, uint32_t stride = 2, uint32_t offset = 0
+                    );
+
+                    Buffer& cellStarts() { return _cellStarts; }
+                    Buffer& cellCounts() { return _cellCounts; }
+                    Buffer& indices() { return _indices; }
+                    uint32_t capacity() const { return _capacity; }
+                    uint32_t tableSize() const { return _tableSize; }
+
+                    static uint32_t bucket(float x, float y, float inverseCellSize, uint32_t tableSize){
+                        int32_t cx = int32_t(std::floor(x * inverseCellSize));
+                        int32_t cy = int32_t(std::floor(y * inverseCellSize));
+                        return bucket(cx, cy, tableSize);
+                    }
+                    static uint32_t bucket(int32_t cx, int32_t cy, uint32_t tableSize){
+                        return ((uint32_t(cx) * 73856093u) ^ (uint32_t(cy) * 19349663u)) & (tableSize - 1);
+                    }
+                    // The distinct buckets around (x, y), returns their count
+                    static uint32_t neighbours(
+                        float x, float y, float inverseCellSize, uint32_t tableSize, uint32_t buckets[9]
+                    );
+                private:
+                    struct Params{
+                        uint32_t count;
+                        uint32_t groupCount;
+                        uint32_t tableSize;
+                        uint32_t stride;
+                        uint32_t offset;
+                        float    inverseCellSize;
+                    };
+
+                    Device& device;
+                    uint32_t _capacity;
+                    uint32_t _tableSize;
+
+                    Kernel histogram;
+                    Kernel scatter;
+                    Scan scan;
+                    FramePools pools;
+
+                    Buffer _cellStarts;
+                    Buffer _cellCounts;
+                    Buffer _indices;
+                    // Each point's position within its bucket
+                    Buffer slots;
+            };
+        } // namespace gpu
+    } // namespace gfx
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 #include "device.hpp"
 #include "buffer.hpp"
+#include "ktx2.hpp"
 #include "../def.hpp"
 #include "../utils.hpp"
 
@@ -40,7 +41,10 @@ namespace shard{
         class Image{
             public:
                 Image(Device& _device): device{_device} {}
+                // KTX2 files are uploaded as is, other formats are decoded into RGBA8
                 Image(Device& _device, const char* filePath);
+                // Uploads every level of the (possibly block compressed) texture
+                Image(Device& _device, const ktx2::Texture& texture);
                 // Pixel data must be 8bit RGBA
                 Image(Device& _device, uint32_t w, uint32_t h, const void* pixels);
                 Image(Device& _device,
@@ -97,7 +101,14 @@ namespace shard{
                     oldLayout = newLayout;
                 }
 
+                VkImageLayout layout() const { return oldLayout; }
+                // For layout transitions recorded outside of transition()
+                void setLayout(VkImageLayout layout) { oldLayout = layout; }
+
                 void genMipMaps();
+                // Blits the mip chain from level 0, which must be in TRANSFER_DST_OPTIMAL.
+                // Every level ends up in SHADER_READ_ONLY_OPTIMAL.
+                void recordMipMaps(VkCommandBuffer commandBuffer);
             private:
                 void cleanup();
 
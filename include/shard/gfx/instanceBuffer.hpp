@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstring>
+#include <algorithm>
+
+#include "gfx.hpp"
+
+namespace shard{
+    namespace gfx{
+        // Per-instance vertex data streamed every frame. T describes itself with a
+        // VertexLayout, like the vertex types:
+        //
+        //     struct Rock{
+        //         glm::vec4 positionScale;
+        //         glm::vec4 rotation;
+        //         using Layout = VertexLayout<attr::Float4, attr::Float4>;
+        //     };
+        //
+        // Each frame in flight writes its own persistently mapped buffer, so pushing never
+        // waits on the GPU. A buffer that runs out of space is replaced by a bigger one;
+        // draws recorded earlier keep the old one alive through the deletion queue.
+        template<typename T>
+        class InstanceBuffer{
+            public:
+                using Layout = typename T::Layout;
+                static_assert(sizeof(T) == Layout::stride, "T must match its Layout!");
+
+                static constexpr size_t MIN_CAPACITY = 256;
+
+                InstanceBuffer(Graphics& _gfx, size_t initialCapacity = MIN_CAPACITY):
+                    gfx{_gfx}
+                {
+                    frames.reserve(Swapchain::MAX_FRAMES_IN_FLIGHT);
+                    for(uint32_t i = 0; i < Swapchain::MAX_FRAMES_IN_FLIGHT; i++){
+                        frames.emplace_back(gfx.device());
+                        reserve(frames.back(), initialCapacity);
+                    }
+                }
+
+                shard_delete_copy_constructors(InstanceBuffer);
+
+                // The instance attributes at binding, locations start at firstLocation
+                // (usually the vertex type's attributeCount)
+                static VkVertexInputBindingDescription bindingDesc(uint32_t binding){
+                    return Layout::bindingDesc(VK_VERTEX_INPUT_RATE_INSTANCE, binding);
+                }
+                static std::vector<VkVertexInputAttributeDescription> attributeDescs(
+                    uint32_t binding, uint32_t firstLocation
+                ){
+                    return Layout::attributeDescs(binding, firstLocation);
+                }
+
+                // Copies instances into the current frame's buffer and returns the index of
+                // the first one, valid until the frame ends. Must be called inside a frame.
+                uint32_t push(const T* instances, size_t count){
+                    FrameBuffer& frame = currentFrame();
+                    if(frame.cursor + count > frame.capacity) reserve(frame, frame.cursor + count);
+
+                    uint32_t first = static_cast<uint32_t>(frame.cursor);
+                    memcpy(static_cast<T*>(frame.buffer.mappedMemory()) + first, instances, count*sizeof(T));
+                    frame.cursor += count;
+                    return first;
+                }
+                uint32_t push(const std::vector<T>& instances){
+                    return push(instances.data(), instances.size());
+                }
+
+                // Binds the current frame's buffer, draws address it with firstInstance
+                void bind(VkCommandBuffer commandBuffer, uint32_t binding){
+                    currentFrame().buffer.bindVertex(commandBuffer, binding);
+                }
+
+                // Instances pushed this frame
+                size_t size(){ return currentFrame().cursor; }
+            private:
+                struct FrameBuffer{
+                    FrameBuffer(Device& device): buffer{device} {}
+
+                    Buffer buffer;
+                    size_t capacity = 0;
+                    size_t cursor = 0;
+                    uint64_t frameValue = 0;
+                };
+
+                FrameBuffer& currentFrame(){
+                    FrameBuffer& frame = frames[gfx.frameIndex()];
+                    uint64_t frameValue = gfx.device().frameValue();
+                    if(frame.frameValue != frameValue){
+                        frame.frameValue = frameValue;
+                        frame.cursor = 0;
+                    }
+                    return frame;
+                }
+                // Instances pushed earlier this frame are carried over, their indices stay valid
+                void reserve(FrameBuffer& frame, size_t count){
+                    size_t capacity = std::max({frame.capacity * 2, count, MIN_CAPACITY});
+                    Buffer buffer = gfx.createBuffer(
+                        capacity * sizeof(T),
+                        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                        VMA_MEMORY_USAGE_CPU_TO_GPU,
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                        VK_SHARING_MODE_EXCLUSIVE
+                    );
+                    buffer.map();
+                    if(frame.cursor > 0){
+                        memcpy(buffer.mappedMemory(), frame.buffer.mappedMemory(), frame.cursor*sizeof(T));
+                    }
+                    frame.buffer = buffer;
+                    frame.capacity = capacity;
+                }
+
+                Graphics& gfx;
+                std::vector<FrameBuffer> frames; // one per frame in flight
+        };
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
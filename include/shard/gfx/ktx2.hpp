@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+
+#include "../utils.hpp"
+
+namespace shard{
+    namespace gfx{
+        // Size of a texel block, 1x1 for uncompressed formats
+        struct FormatBlockInfo{
+            uint32_t blockWidth  = 1;
+            uint32_t blockHeight = 1;
+            uint32_t blockSize   = 0; // in bytes, 0 for unknown formats
+
+            bool compressed() const { return blockWidth > 1 || blockHeight > 1; }
+        };
+        FormatBlockInfo getFormatBlockInfo(VkFormat format);
+
+        // Khronos KTX2 container (https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html),
+        // only single layer, single face 2D textures without supercompression
+        namespace ktx2{
+            inline constexpr uint8_t IDENTIFIER[12] = {
+                0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+            };
+
+            struct Header{
+                uint8_t  identifier[12];
+                uint32_t vkFormat;
+                uint32_t typeSize;
+                uint32_t pixelWidth;
+                uint32_t pixelHeight;
+                uint32_t pixelDepth;
+                uint32_t layerCount;
+                uint32_t faceCount;
+                uint32_t levelCount;
+                uint32_t supercompressionScheme;
+
+                uint32_t dfdByteOffset;
+                uint32_t dfdByteLength;
+                uint32_t kvdByteOffset;
+                uint32_t kvdByteLength;
+                uint64_t sgdByteOffset;
+                uint64_t sgdByteLength;
+            };
+            static_assert(sizeof(Header) == 80);
+
+            struct LevelIndex{
+                uint64_t byteOffset;
+                uint64_t byteLength;
+                uint64_t uncompressedByteLength;
+            };
+            static_assert(sizeof(LevelIndex) == 24);
+
+            struct Texture{
+                VkFormat format = VK_FORMAT_UNDEFINED;
+                uint32_t width = 0;
+                uint32_t height = 0;
+                // Level 0 is the largest, offsets point into data
+                std::vector<LevelIndex> levels;
+                std::vector<uint8_t> data;
+            };
+
+            // Checks the file identifier
+            bool isKtx2File(const char* filePath);
+            // Returns false if the file can't be read or uses unsupported features
+            bool load(const char* filePath, Texture& texture);
+        } // namespace ktx2
+    } // namespace gfx
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
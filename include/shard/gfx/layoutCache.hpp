@@ -0,0 +1,64 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "device.hpp"
+#include "descriptor.hpp"
+#include "shaderModule.hpp"
+
+namespace shard{
+    namespace gfx{
+        // Descriptor set and pipeline layouts built from shader reflection. Identical
+        // layouts share one handle, everything is owned by the cache and lives as long
+        // as it does.
+        class LayoutCache{
+            public:
+                struct Layout{
+                    VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+                    // Indexed by set, sets no stage uses get an empty layout
+                    std::vector<DescriptorSetLayout*> setLayouts;
+                    // Size 0 if no stage uses push constants
+                    VkPushConstantRange pushConstants = {};
+                };
+
+                LayoutCache(Device& _device);
+                ~LayoutCache();
+
+                shard_delete_copy_constructors(LayoutCache);
+
+                DescriptorSetLayout& descriptorSetLayout(
+                    const std::map<uint32_t, VkDescriptorSetLayoutBinding>& bindings
+                );
+                VkPipelineLayout pipelineLayout(
+                    const std::vector<DescriptorSetLayout*>& setLayouts,
+                    const std::vector<VkPushConstantRange>& ranges
+                );
+                // Merges the bindings and push constants of every stage, a binding used
+                // by several stages must have the same descriptor type in all of them.
+                // Aborts on runtime sized descriptor arrays.
+                Layout reflect(const std::vector<const ShaderModule*>& shaders);
+            private:
+                Device& device;
+
+                std::map<std::vector<uint32_t>, std::unique_ptr<DescriptorSetLayout>> setLayouts;
+                std::map<std::vector<uint64_t>, VkPipelineLayout> pipelineLayouts;
+        };
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
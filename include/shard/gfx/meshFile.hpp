@@ -0,0 +1,145 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../mappedFile.hpp"
+#include "modelLoader.hpp"
+#include "meshlet.hpp"
+
+namespace shard{
+    namespace gfx{
+        // .smesh: shard's binary mesh format. A header and a section table are followed by
+        // the section blobs, every blob is stored ready to be copied into a GPU buffer.
+        namespace smesh{
+            inline constexpr uint8_t MAGIC[4] = {'S', 'M', 'S', 'H'};
+            inline constexpr uint32_t VERSION = 3;
+            inline constexpr uint64_t SECTION_ALIGNMENT = 16;
+
+            enum class SectionType : uint32_t{
+                VERTICES = 1, // Vertex3D
+                INDICES  = 2, // uint32_t
+                // Optional, see MeshletMesh
+                MESHLETS          = 3, // Meshlet
+                MESHLET_BOUNDS    = 4, // MeshletBounds
+                MESHLET_VERTICES  = 5, // uint32_t
+                MESHLET_TRIANGLES = 6, // uint8_t
+            };
+
+            // Identifies the source file a cache was built from
+            struct SourceStamp{
+                uint64_t size = 0;
+                int64_t  modifiedTime = 0;
+                uint64_t hash = 0;
+            };
+
+            struct Header{
+                uint8_t  magic[4];
+                uint32_t version;
+                uint64_t sourceSize;
+                int64_t  sourceModifiedTime;
+                uint64_t sourceHash;
+                uint32_t vertexStride;
+                uint32_t sectionCount;
+                float    boundsMin[3];
+                float    boundsMax[3];
+            };
+            static_assert(sizeof(Header) == 64);
+
+            struct Section{
+                SectionType type;
+                uint32_t    elementCount;
+                uint64_t    byteOffset;
+                uint64_t    byteLength;
+            };
+            static_assert(sizeof(Section) == 24);
+
+            uint64_t hashBytes(const void* data, size_t size);
+            // The content hash is only computed when hash is true
+            bool stampFile(const char* filePath, SourceStamp& stamp, bool hash);
+            inline std::string cachePath(const char* sourcePath){
+                return std::string(sourcePath) + ".smesh";
+            }
+
+            // Writes through a temporary file, so readers never map a partial cache.
+            // The meshlet sections are only written if meshlets isn't null.
+            bool write(
+                const char* filePath, const SourceStamp& source,
+                const std::vector<Vertex3D>& vertices,
+                const std::vector<uint32_t>& indices,
+                const MeshletMesh* meshlets = nullptr
+            );
+        } // namespace smesh
+
+        // Memory mapped .smesh file. Vertex and index data point straight into the
+        // mapping, so uploading is a single copy into the staging buffer.
+        class MeshFile{
+            public:
+                MeshFile() = default;
+                // Maps and validates a .smesh file, check valid()
+                MeshFile(const char* filePath);
+                MeshFile(MeshFile&& m);
+
+                shard_delete_copy_constructors(MeshFile);
+
+                MeshFile& operator = (MeshFile&& m);
+
+                // Loads an OBJ through its cache file next to it (see smesh::cachePath).
+                // A cache is reused while the source's size and modification time match,
+                // or its content hash if only the modification time changed. Otherwise the
+                // OBJ is parsed and the cache rebuilt with meshlets. Invalid if the cache
+                // can't be written.
+                static MeshFile loadObj(const char* objPath);
+
+                bool valid() const { return _header != nullptr; }
+                const smesh::Header& header() const { return *_header; }
+
+                // Raw section data, nullptr if the file has no such section
+                const void* section(
+                    smesh::SectionType type,
+                    uint32_t* elementCount = nullptr,
+                    uint64_t* byteLength = nullptr
+                ) const;
+
+                const Vertex3D* vertices() const { return _vertices; }
+                const uint32_t* indices()  const { return _indices; }
+                uint32_t vertexCount() const { return _vertexCount; }
+                uint32_t indexCount()  const { return _indexCount; }
+                // nullptr if the file holds no meshlets
+                const Meshlet*       meshlets()      const { return _meshlets; }
+                const MeshletBounds* meshletBounds() const { return _meshletBounds; }
+                uint32_t meshletCount() const { return _meshletCount; }
+                glm::vec3 boundsMin() const {
+                    return {_header->boundsMin[0], _header->boundsMin[1], _header->boundsMin[2]};
+                }
+                glm::vec3 boundsMax() const {
+                    return {_header->boundsMax[0], _header->boundsMax[1], _header->boundsMax[2]};
+                }
+            private:
+                MappedFile file;
+                const smesh::Header* _header = nullptr;
+                const Vertex3D* _vertices = nullptr;
+                const uint32_t* _indices = nullptr;
+                uint32_t _vertexCount = 0;
+                uint32_t _indexCount = 0;
+                const Meshlet* _meshlets = nullptr;
+                const MeshletBounds* _meshletBounds = nullptr;
+                uint32_t _meshletCount = 0;
+        };
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include "vertex.hpp"
+
+namespace shard{
+    namespace gfx{
+        // One level of detail, a range of an index buffer shared by all levels
+        struct MeshLod{
+            uint32_t firstIndex;
+            uint32_t indexCount;
+            float    error; // geometric error against level 0, in model units
+        };
+
+        // Appends simplified copies of indices (see meshopt::simplify) to indices, each
+        // keeping about reduction of the previous level's triangles. Level 0 is the original
+        // indices. Stops after maxLevels levels, or once a level can't be reduced further
+        // or its error would exceed maxError.
+        std::vector<MeshLod> buildLodChain(
+            std::vector<uint32_t>& indices, const std::vector<Vertex3D>& vertices,
+            uint32_t maxLevels = 6, float reduction = 0.5f, float maxError = INFINITY
+        );
+
+        // Pixels per model unit at distance 1 for a perspective projection
+        inline float lodPixelScale(float fovY, float viewportHeight){
+            return viewportHeight / (2.0f * std::tan(fovY * 0.5f));
+        }
+        // Coarsest level whose error projects to at most maxPixelError pixels. distance is
+        // from the camera to the closest point of the instance, scale is the instance's
+        // uniform scale.
+        uint32_t selectLod(
+            const MeshLod* lods, uint32_t lodCount,
+            float distance, float pixelScale,
+            float maxPixelError = 1.0f, float scale = 1.0f
+        );
+        inline uint32_t selectLod(
+            const std::vector<MeshLod>& lods,
+            float distance, float pixelScale,
+            float maxPixelError = 1.0f, float scale = 1.0f
+        ){
+            return selectLod(
+                lods.data(), static_cast<uint32_t>(lods.size()),
+                distance, pixelScale, maxPixelError, scale
+            );
+        }
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
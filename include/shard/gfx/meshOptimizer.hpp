@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+#include "vertex.hpp"
+
+namespace shard{
+    namespace gfx{
+        // Optional passes over loaded triangle lists, run before the mesh is uploaded
+        // (or written to a .smesh cache). Index buffers are triangle lists.
+        namespace meshopt{
+            struct VertexCacheStats{
+                uint32_t transformedVertices = 0;
+                float acmr = 0.0f; // transformed vertices per triangle, 0.5 is ideal
+                float atvr = 0.0f; // transformed vertices per vertex, 1.0 is ideal
+            };
+            struct OptimizeStats{
+                VertexCacheStats before;
+                VertexCacheStats after;
+            };
+
+            // Simulates a FIFO post-transform cache of cacheSize entries
+            VertexCacheStats analyzeVertexCache(
+                const uint32_t* indices, size_t indexCount, size_t vertexCount,
+                uint32_t cacheSize = 16
+            );
+
+            // Reorders triangles for the post-transform cache (Forsyth's linear-speed algorithm)
+            void optimizeVertexCache(
+                uint32_t* dst, const uint32_t* indices, size_t indexCount, size_t vertexCount
+            );
+            // Splits cache optimized indices into clusters and orders them front to back
+            // from the mesh center (Sander et al.), trading up to threshold times the
+            // ACMR for less overdraw. Must run after optimizeVertexCache.
+            void optimizeOverdraw(
+                uint32_t* dst, const uint32_t* indices, size_t indexCount,
+                const Vertex3D* vertices, size_t vertexCount,
+                float threshold = 1.05f
+            );
+            // Reorders vertices by first use in the index buffer and drops unused ones.
+            // Returns the new vertex count.
+            size_t optimizeVertexFetch(std::vector<Vertex3D>& vertices, std::vector<uint32_t>& indices);
+
+            // Runs all passes above in place
+            OptimizeStats optimizeMesh(
+                std::vector<Vertex3D>& vertices, std::vector<uint32_t>& indices,
+                float overdrawThreshold = 1.05f
+            );
+
+            // Quadric error edge collapse (Garland-Heckbert) onto existing vertices, so the
+            // result indexes the same vertex buffer. Stops at targetIndexCount or when the next
+            // collapse would exceed targetError (in model units). UV/normal seams and open
+            // borders are kept. Returns the new index count, resultError receives the largest
+            // error introduced. dst may alias indices.
+            size_t simplify(
+                uint32_t* dst, const uint32_t* indices, size_t indexCount,
+                const Vertex3D* vertices, size_t vertexCount,
+                size_t targetIndexCount, float targetError = INFINITY,
+                float* resultError = nullptr
+            );
+        } // namespace meshopt
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
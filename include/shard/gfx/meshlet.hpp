@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+
+#include "vertex.hpp"
+
+namespace shard{
+    namespace gfx{
+        inline constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+        inline constexpr uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+        // A cluster of triangles that are culled together. Laid out for std430 buffers.
+        struct Meshlet{
+            uint32_t vertexOffset;   // into MeshletMesh::vertices
+            // First triangle, both into MeshletMesh::triangles (3 bytes each) and into the
+            // source index buffer, so firstIndex = triangleOffset*3 draws the meshlet
+            uint32_t triangleOffset;
+            uint32_t vertexCount;
+            uint32_t triangleCount;
+        };
+        static_assert(sizeof(Meshlet) == 16);
+
+        // Bounding sphere and normal cone in model space. Laid out for std430 buffers.
+        // The meshlet is back facing for every camera with
+        // dot(normalize(coneApex - camera), coneAxis) >= coneCutoff,
+        // coneCutoff is 2 when the normals spread too far for a cone.
+        struct MeshletBounds{
+            glm::vec3 center;
+            float     radius;
+            glm::vec3 coneApex;
+            float     coneCutoff;
+            glm::vec3 coneAxis;
+            float     padding;
+        };
+        static_assert(sizeof(MeshletBounds) == 48);
+
+        struct MeshletMesh{
+            std::vector<Meshlet>       meshlets;
+            std::vector<MeshletBounds> bounds;
+            std::vector<uint32_t>      vertices;  // meshlet local vertex -> mesh vertex
+            std::vector<uint8_t>       triangles; // 3 meshlet local vertices per triangle
+        };
+
+        // Splits a triangle list into meshlets in index order, so the index buffer stays
+        // valid for drawing meshlet ranges. Run meshopt::optimizeVertexCache first, it keeps
+        // neighbouring triangles together which makes meshlets smaller and bounds tighter.
+        MeshletMesh buildMeshlets(
+            const Vertex3D* vertices, size_t vertexCount,
+            const uint32_t* indices,  size_t indexCount,
+            uint32_t maxVertices = MESHLET_MAX_VERTICES,
+            uint32_t maxTriangles = MESHLET_MAX_TRIANGLES
+        );
+        MeshletBounds computeMeshletBounds(
+            const MeshletMesh& mesh, const Meshlet& meshlet, const Vertex3D* vertices
+        );
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
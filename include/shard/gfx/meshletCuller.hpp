@@ -0,0 +1,76 @@
+#pragma once
+
+#include "gfx.hpp"
+#include "meshlet.hpp"
+#include "meshFile.hpp"
+
+namespace shard{
+    namespace gfx{
+        // Culls the meshlets of one mesh on the GPU against the view frustum and their
+        // normal cones, and draws the survivors with indirect indexed draws over the
+        // mesh's own index buffer, so the vertex work follows what is visible.
+        //
+        // Uses vkCmdDrawIndexedIndirectCount when drawIndirectCount is supported, otherwise
+        // the command buffer is cleared first and all meshletCount() commands are issued.
+        class MeshletCuller{
+            public:
+                MeshletCuller(
+                    Graphics& _gfx,
+                    const Meshlet* meshlets, const MeshletBounds* bounds, uint32_t meshletCount
+                );
+                MeshletCuller(Graphics& _gfx, const MeshletMesh& mesh);
+                // The file must hold meshlets
+                MeshletCuller(Graphics& _gfx, const MeshFile& mesh);
+                ~MeshletCuller();
+
+                shard_delete_copy_constructors(MeshletCuller);
+
+                // Records the culling dispatch, outside of a render pass. modelViewProj maps
+                // model space to clip space, cameraPosition is in model space.
+                void cull(
+                    VkCommandBuffer commandBuffer,
+                    const glm::mat4& modelViewProj, const glm::vec3& cameraPosition
+                );
+                // Draws the meshlets that survived the last cull(), the mesh's vertex and
+                // index buffers (Model::bind) and a graphics pipeline must be bound
+                void draw(VkCommandBuffer commandBuffer);
+
+                uint32_t meshletCount() const { return _meshletCount; }
+            private:
+                struct CullParams{
+                    glm::vec4 planes[6];
+                    glm::vec3 cameraPosition;
+                    uint32_t  meshletCount;
+                };
+
+                Graphics& gfx;
+                uint32_t _meshletCount;
+
+                Buffer meshletBuffer;
+                Buffer boundsBuffer;
+                Buffer drawBuffer;
+                Buffer countBuffer;
+
+                DescriptorSetLayout setLayout;
+                DescriptorPool descriptorPool;
+                VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+                VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+                Compute pipeline;
+        };
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
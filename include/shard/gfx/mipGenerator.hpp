@@ -0,0 +1,91 @@
+#pragma once
+
+#include "device.hpp"
+#include "buffer.hpp"
+#include "image.hpp"
+#include "compute.hpp"
+#include "descriptor.hpp"
+
+namespace shard{
+    namespace gfx{
+        enum class MipFilter{
+            BOX,    // 2x2 average, all levels in a single dispatch
+            KAISER, // 4x4 Kaiser windowed sinc, one dispatch per level
+        };
+
+        // Generates mip chains with compute shaders instead of linear blits. Supports
+        // R8G8B8A8 images, sRGB images are filtered in linear space.
+        //
+        // Images need VK_IMAGE_USAGE_STORAGE_BIT, sRGB images additionally need
+        // VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT | VK_IMAGE_CREATE_EXTENDED_USAGE_BIT so
+        // their levels can be written through UNORM views.
+        class MipGenerator{
+            public:
+                static constexpr uint32_t MAX_LEVELS_PER_DISPATCH = 12;
+
+                MipGenerator(Device& _device);
+                ~MipGenerator();
+
+                shard_delete_copy_constructors(MipGenerator);
+
+                static bool supportsFormat(VkFormat format);
+
+                // Level 0 must hold the image data, the image is left in
+                // VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+                void record(VkCommandBuffer commandBuffer, Image& image, MipFilter filter);
+                // Blocking, records into a single time command buffer
+                void generate(Image& image, MipFilter filter);
+            private:
+                struct SpdParams{
+                    int32_t  srcWidth, srcHeight;
+                    int32_t  levelCount;
+                    int32_t  srgb;
+                    uint32_t workgroupCount;
+                };
+                struct KaiserParams{
+                    int32_t srcWidth, srcHeight;
+                    int32_t dstWidth, dstHeight;
+                    int32_t srgb;
+                };
+
+                static VkFormat storageFormat(VkFormat format);
+
+                void recordSpd(
+                    VkCommandBuffer commandBuffer, Image& image,
+                    const std::vector<VkImageView>& views, DescriptorPool& pool, bool srgb
+                );
+                void recordKaiser(
+                    VkCommandBuffer commandBuffer, Image& image,
+                    const std::vector<VkImageView>& views, DescriptorPool& pool, bool srgb
+                );
+
+                Device& device;
+
+                DescriptorSetLayout spdSetLayout;
+                DescriptorSetLayout kaiserSetLayout;
+                VkPipelineLayout spdLayout = VK_NULL_HANDLE;
+                VkPipelineLayout kaiserLayout = VK_NULL_HANDLE;
+                Compute spd;
+                Compute kaiser;
+
+                // Workgroup counter of the single pass downsampler, cleared before every dispatch
+                Buffer counter;
+        };
+    } // namespace gfx
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
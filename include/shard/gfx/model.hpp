@@ -1,11 +1,27 @@
 #pragma once
 
 #include "gfx.hpp"
+#include "meshFile.hpp"
+#include "instanceBuffer.hpp"
 
 namespace shard{
     namespace gfx{
+        // One vertex buffer binding worth of tightly packed data
+        struct VertexStream{
+            const void* data;
+            size_t      stride;
+        };
+
+        enum class VertexStreamLayout{
+            INTERLEAVED,     // a single Vertex3D buffer
+            SPLIT_POSITIONS  // Vertex3D::Streams, positions at binding 0 and the rest at binding 1
+        };
+
+        // Indices are given as uint32_t and stored as uint16_t whenever the vertex count allows it
         class Model{
             public:
+                static constexpr uint32_t MAX_STREAMS = 8;
+
                 Model(Graphics& _gfx);
                 Model(
                     Graphics& _gfx,
@@ -27,6 +43,47 @@ namespace shard{
                     const Vertex3D* vertices, size_t vcount,
                     const uint32_t* indices,  size_t icount
                 );
+                // Any vertex type, e.g. CompactVertex3D, the pipeline decides the layout
+                Model(
+                    Graphics& _gfx,
+                    const void* vertices, size_t vertexStride, size_t vcount,
+                    const uint32_t* indices, size_t icount
+                );
+                template<typename V>
+                Model(
+                    Graphics& _gfx,
+                    const std::vector<V>& vertices,
+                    const std::vector<uint32_t>& indices
+                ):
+                    Model(
+                        _gfx,
+                        vertices.data(), sizeof(V), vertices.size(),
+                        indices.data(), indices.size()
+                    )
+                {}
+                // Stream i is bound at binding i, every stream holds vcount vertices
+                Model(
+                    Graphics& _gfx,
+                    const std::vector<VertexStream>& streams, size_t vcount,
+                    const uint32_t* indices, size_t icount
+                );
+                Model(
+                    Graphics& _gfx,
+                    const std::vector<Vertex3D>& vertices,
+                    const std::vector<uint32_t>& indices,
+                    VertexStreamLayout layout
+                );
+                // Uploads every level of detail the loader generated
+                Model(Graphics& _gfx, const ModelLoader& loader);
+                // Stages straight from the file mapping
+                Model(Graphics& _gfx, const MeshFile& mesh);
+                // Takes ownership of already uploaded buffers, the index buffer may be null
+                Model(
+                    Graphics& _gfx,
+                    Buffer&& vertexBuffer, uint32_t vertexCount,
+                    Buffer&& indexBuffer,  uint32_t indexCount,
+                    VkIndexType indexType = VK_INDEX_TYPE_UINT32
+                );
                 Model(Model&  m);
                 Model(Model&& m);
                 
@@ -35,8 +92,35 @@ namespace shard{
                 Model& operator = (Model&  m);
                 Model& operator = (Model&& m);
 
+                // Binds every stream starting at binding 0
                 void bind(VkCommandBuffer commandBuffer);
+                // Binds only stream 0, for depth and shadow passes on split models
+                void bindPositions(VkCommandBuffer commandBuffer);
+                // Draws level 0 if the model has levels of detail
                 void draw(VkCommandBuffer commandBuffer);
+                // level is clamped to the coarsest level, see selectLod
+                void drawLod(VkCommandBuffer commandBuffer, uint32_t level);
+                // Pushes per-draw data such as the model matrix before drawing level,
+                // P is a PushConstants the layout was created with
+                template<typename P>
+                void draw(
+                    VkCommandBuffer commandBuffer, VkPipelineLayout layout,
+                    const typename P::Type& value, uint32_t level = 0
+                ){
+                    P::push(commandBuffer, layout, value);
+                    drawLod(commandBuffer, level);
+                }
+                // Draws count instances starting at first (see InstanceBuffer::push) in a single
+                // call. The instance attributes go to the binding after the vertex streams,
+                // streamCount(). bind() must have been called.
+                template<typename T>
+                void drawInstanced(
+                    VkCommandBuffer commandBuffer, InstanceBuffer<T>& instances,
+                    uint32_t first, uint32_t count, uint32_t level = 0
+                ){
+                    instances.bind(commandBuffer, streamCount());
+                    record(commandBuffer, level, count, first);
+                }
                 
                 Buffer& vertexBuffer(){ return vBuffer; }
                 Buffer& indexBuffer() { return iBuffer; }
@@ -44,14 +128,34 @@ namespace shard{
                 const Buffer& indexBuffer()  const { return iBuffer; }
                 uint32_t vertexCount() const { return vertCount; }
                 uint32_t indexCount()  const { return _indexCount; }
+                // UINT16 whenever the vertex count allows it, see selectIndexType
+                VkIndexType indexType() const { return _indexType; }
+                // Ranges of the index buffer, empty if the model has a single level
+                const std::vector<MeshLod>& lods() const { return _lods; }
+                void setLods(const std::vector<MeshLod>& lods);
+                uint32_t lodCount() const { return _lods.empty() ? 1 : uint32_t(_lods.size()); }
+                uint32_t streamCount() const { return 1 + uint32_t(extraStreams.size()); }
+                // Stream 0 is vertexBuffer()
+                Buffer& streamBuffer(uint32_t stream){
+                    assert(stream < streamCount());
+                    return stream == 0 ? vBuffer : extraStreams[stream - 1];
+                }
 
                 bool valid(){ return vBuffer.valid(); }
             private:
+                void record(
+                    VkCommandBuffer commandBuffer, uint32_t level,
+                    uint32_t instanceCount, uint32_t firstInstance
+                );
+
                 Graphics& gfx;
                 Buffer    vBuffer;
                 Buffer    iBuffer;
+                std::vector<Buffer> extraStreams;
                 uint32_t  vertCount;
                 uint32_t  _indexCount;
+                VkIndexType _indexType;
+                std::vector<MeshLod> _lods;
         };
     }
 }
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+#include "vertex.hpp"
+#include "meshLod.hpp"
+
+namespace shard{
+    namespace gfx{
+        // Loads a Wavefront OBJ into an indexed triangle list.
+        // Vertices are deduplicated on their (position, normal, texcoord) index triplet.
+        class ModelLoader{
+            public:
+                std::vector<Vertex3D> vertices;
+                std::vector<uint32_t> indices;
+                // Empty unless generateLods() ran, level 0 is the loaded mesh
+                std::vector<MeshLod> lods;
+
+                ModelLoader(const char* filePath);
+
+                // Appends simplified levels to indices, see buildLodChain. Draw through
+                // the lods ranges afterwards, indices holds every level back to back.
+                void generateLods(uint32_t maxLevels = 6, float reduction = 0.5f, float maxError = INFINITY);
+
+                // Index type a Model built from this mesh uses
+                VkIndexType indexType() const { return selectIndexType(vertices.size()); }
+                // indices in indexType() storage, indexTypeSize(indexType()) bytes per index
+                std::vector<uint8_t> packedIndices() const;
+
+                // The loaded vertices in the compact layouts, indices are unchanged
+                std::vector<CompactVertex3D> compactVertices() const;
+                // quantization receives the mesh bounds the positions are relative to
+                std::vector<QuantizedVertex3D> quantizedVertices(VertexQuantization& quantization) const;
+        };
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
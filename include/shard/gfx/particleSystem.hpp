@@ -0,0 +1,168 @@
+#pragma once
+
+#include <memory>
+
+#include "gfx.hpp"
+#include "vertexLayout.hpp"
+#include "gpu/radixSort.hpp"
+
+namespace shard{
+    namespace gfx{
+        // Particles simulated entirely on the GPU. Free slots are kept on a dead list
+        // and the particles to simulate on an alive list, so the work follows the alive
+        // count without the CPU ever reading it: each update emits from the dead list,
+        // simulates the alive list into the next one, optionally sorts it back to front
+        // and compacts it into an instance buffer drawn with one indirect draw.
+        //
+        // Draw with a pipeline taking Instance at the binding passed to draw(), the
+        // vertex shader builds each particle's verticesPerParticle vertices from
+        // gl_VertexIndex. Sorting runs a 16 bit gpu::RadixSort over the survivors' workgroups.
+        class ParticleSystem{
+            public:
+                struct Instance{
+                    glm::vec4 positionSize;
+                    glm::vec4 color;
+
+                    using Layout = VertexLayout<attr::Float4, attr::Float4>;
+                };
+                // Read on every update(), changes apply to the next one
+                struct Emitter{
+                    glm::vec3 position = glm::vec3(0.0f);
+                    float     radius = 0.0f;
+                    glm::vec3 velocity = glm::vec3(0.0f);
+                    // Radius of the random offset added to velocity
+                    float     velocitySpread = 0.0f;
+                    glm::vec3 acceleration = glm::vec3(0.0f);
+                    // Fraction of the velocity lost per second, exponentially
+                    float     drag = 0.0f;
+                    // Particles fade from start to end over their lifetime
+                    glm::vec4 startColor = glm::vec4(1.0f);
+                    glm::vec4 endColor = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+                    float     startSize = 1.0f;
+                    float     endSize = 1.0f;
+                    // Seconds, shortened by up to lifetimeVariation * lifetime at random
+                    float     lifetime = 1.0f;
+                    float     lifetimeVariation = 0.0f;
+                    // Particles per second
+                    float     rate = 0.0f;
+                };
+
+                ParticleSystem(
+                    Graphics& _gfx, uint32_t capacity,
+                    bool sorted = false, uint32_t verticesPerParticle = 6
+                );
+
+                shard_delete_copy_constructors(ParticleSystem);
+
+                // Records emission, simulation and compaction outside of a render pass, such
+                // as in the beginRenderPass callback
+                void update(VkCommandBuffer commandBuffer, float deltaTime);
+                // Draws every alive particle as of the last update()
+                void draw(VkCommandBuffer commandBuffer, uint32_t instanceBinding = 0);
+
+                // count particles are emitted on the next update() on top of the rate
+                void burst(uint32_t count){ pendingBurst += count; }
+                // Sort keys map distances from position to [0, farDistance]
+                void setCamera(const glm::vec3& position, float farDistance){
+                    assert(farDistance > 0.0f);
+                    camera = glm::vec4(position, farDistance);
+                }
+
+                Emitter& emitter(){ return _emitter; }
+                const Emitter& emitter() const { return _emitter; }
+                uint32_t capacity() const { return _capacity; }
+                bool sorted() const { return _sorted; }
+
+                static VkVertexInputBindingDescription bindingDesc(uint32_t binding){
+                    return Instance::Layout::bindingDesc(VK_VERTEX_INPUT_RATE_INSTANCE, binding);
+                }
+                static std::vector<VkVertexInputAttributeDescription> attributeDescs(
+                    uint32_t binding, uint32_t firstLocation = 0
+                ){
+                    return Instance::Layout::attributeDescs(binding, firstLocation);
+                }
+            private:
+                // Matches shaders/particles/common.glsl
+                struct Particle{
+                    glm::vec4 positionLifetime;
+                    glm::vec4 velocityLife;
+                };
+                struct Counters{
+                    uint32_t aliveCount;
+                    uint32_t deadCount;
+                    uint32_t emitCount;
+                    uint32_t nextAliveCount;
+                    VkDispatchIndirectCommand emitGroups;
+                    VkDispatchIndirectCommand simulateGroups;
+                    VkDispatchIndirectCommand compactGroups;
+                    VkDrawIndirectCommand draw;
+                    float emitRemainder;
+                };
+                struct Params{
+                    glm::vec4 position;
+                    glm::vec4 velocity;
+                    glm::vec4 acceleration;
+                    glm::vec4 startColor;
+                    glm::vec4 endColor;
+                    glm::vec4 camera;
+                    float     lifetime;
+                    float     lifetimeVariation;
+                    float     startSize;
+                    float     endSize;
+                    float     deltaTime;
+                    float     rate;
+                    uint32_t  burst;
+                    uint32_t  seed;
+                };
+                static_assert(sizeof(Params) <= 128, "Params must fit the guaranteed push constant size!");
+
+                void bind(VkCommandBuffer commandBuffer, Compute& kernel, const Params& params);
+
+                Graphics& gfx;
+                uint32_t _capacity;
+                bool _sorted;
+                uint32_t workgroupSize;
+
+                Emitter _emitter = {};
+                glm::vec4 camera = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+                uint32_t pendingBurst = 0;
+                uint32_t seed = 0;
+                // Which alive list is simulated, the other receives the survivors
+                uint32_t parity = 0;
+
+                Buffer particleBuffer;
+                Buffer deadBuffer;
+                Buffer aliveBuffers[2];
+                Buffer counterBuffer;
+                Buffer sortKeyBuffer;
+                Buffer instanceBuffer;
+
+                DescriptorSetLayout& setLayout; // owned by the layout cache
+                DescriptorPool descriptorPool;
+                VkDescriptorSet descriptorSets[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+                VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+                Compute beginKernel;
+                Compute emitKernel;
+                Compute simulateKernel;
+                Compute endKernel;
+                Compute compactKernel;
+                std::unique_ptr<gpu::RadixSort> sorter;
+        };
+    } // namespace gfx
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -12,6 +12,7 @@
 #include "device.hpp"
 #include "swapchain.hpp"
 #include "shaderModule.hpp"
+#include "specialization.hpp"
 
 namespace shard{
     namespace gfx{
@@ -49,7 +50,8 @@ namespace shard{
                     const std::vector<char>& fragSPV,
                     const std::vector<VkVertexInputBindingDescription>& bindingDescs,
                     const std::vector<VkVertexInputAttributeDescription>& attrDescs,
-                    PipelineConfigInfo& config
+                    PipelineConfigInfo& config,
+                    const SpecializationConstants& constants = {}
                 );
                 Pipeline(
                     Device& _device,
@@ -59,7 +61,8 @@ namespace shard{
                     const char* fragFile,
                     const std::vector<VkVertexInputBindingDescription>& bindingDescs,
                     const std::vector<VkVertexInputAttributeDescription>& attrDescs,
-                    PipelineConfigInfo& config
+                    PipelineConfigInfo& config,
+                    const SpecializationConstants& constants = {}
                 );
                 Pipeline(
                     Device& _device,
@@ -69,7 +72,8 @@ namespace shard{
                     ShaderModule& frag,
                     const std::vector<VkVertexInputBindingDescription>& bindingDescs,
                     const std::vector<VkVertexInputAttributeDescription>& attrDescs,
-                    PipelineConfigInfo& config
+                    PipelineConfigInfo& config,
+                    const SpecializationConstants& constants = {}
                 );
 
                 Pipeline(Pipeline& p);
@@ -81,14 +85,14 @@ namespace shard{
 
                 Pipeline& operator = (Pipeline& p){
                     assert(&device == &p.device);
-                    vkDestroyPipeline(device.device(), _pipeline, nullptr);
+                    destroy();
                     _pipeline = p._pipeline;
                     p._pipeline = VK_NULL_HANDLE;
                     return *this;
                 }
                 Pipeline& operator = (Pipeline&& p){
                     assert(&device == &p.device);
-                    vkDestroyPipeline(device.device(), _pipeline, nullptr);
+                    destroy();
                     _pipeline = p._pipeline;
                     p._pipeline = VK_NULL_HANDLE;
                     return *this;
@@ -105,6 +109,7 @@ namespace shard{
                     vkCmdBindPipeline(commandBuffer, bindPoint, _pipeline);
                 }
             private:
+                void destroy();
                 void init(
                     VkRenderPass renderPass,
                     VkPipelineLayout layout,
@@ -112,7 +117,8 @@ namespace shard{
                     ShaderModule& frag,
                     const std::vector<VkVertexInputBindingDescription>& bindingDescs,
                     const std::vector<VkVertexInputAttributeDescription>& attrDescs,
-                    PipelineConfigInfo& config
+                    PipelineConfigInfo& config,
+                    const SpecializationConstants& constants
                 );
                 Device& device;
                 VkPipeline _pipeline=VK_NULL_HANDLE;
@@ -0,0 +1,83 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <cstdint>
+#include <type_traits>
+
+#include "device.hpp"
+
+namespace shard{
+    namespace gfx{
+        // maxPushConstantsSize every Vulkan implementation guarantees
+        constexpr uint32_t MIN_MAX_PUSH_CONSTANTS_SIZE = 128;
+
+        namespace detail{
+            template<typename T, typename = void>
+            struct PushConstantStages{
+                static constexpr VkShaderStageFlags value = VK_SHADER_STAGE_ALL_GRAPHICS;
+            };
+            template<typename T>
+            struct PushConstantStages<T, std::void_t<decltype(T::stages)>>{
+                static constexpr VkShaderStageFlags value = T::stages;
+            };
+        } // namespace detail
+
+        // A typed push constant block. The stages default to T::stages when T declares
+        // it, otherwise every graphics stage. The layout must be created with range().
+        //
+        // struct Transform{
+        //     static constexpr VkShaderStageFlags stages = VK_SHADER_STAGE_VERTEX_BIT;
+        //     glm::mat4 model;
+        // };
+        // using TransformPush = PushConstants<Transform>;
+        // layout = gfx.createPipelineLayout({TransformPush::range()}, {...});
+        // TransformPush::push(commandBuffer, layout, transform);
+        template<
+            typename T,
+            VkShaderStageFlags Stages = detail::PushConstantStages<T>::value,
+            uint32_t Offset = 0
+        >
+        struct PushConstants{
+            using Type = T;
+            static constexpr VkShaderStageFlags stages = Stages;
+            static constexpr uint32_t offset = Offset;
+            static constexpr uint32_t size = sizeof(T);
+
+            static_assert(std::is_trivially_copyable_v<T>, "Push constants are copied as raw bytes!");
+            static_assert(Stages != 0, "Push constants need at least one stage!");
+            static_assert(Offset % 4 == 0 && size % 4 == 0, "Push constant offset and size must be multiples of 4!");
+            static_assert(alignof(T) <= 16, "Push constant blocks use at most 16 byte alignment!");
+            static_assert(
+                Offset + size <= MIN_MAX_PUSH_CONSTANTS_SIZE,
+                "Push constant block exceeds the 128 bytes every device supports!"
+            );
+
+            static constexpr VkPushConstantRange range(){
+                return {Stages, Offset, size};
+            }
+
+            static void push(VkCommandBuffer commandBuffer, VkPipelineLayout layout, const T& value){
+                assert(commandBuffer != VK_NULL_HANDLE);
+                assert(layout != VK_NULL_HANDLE);
+                vkCmdPushConstants(commandBuffer, layout, Stages, Offset, size, &value);
+            }
+        };
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "device.hpp"
+#include "shaderReflection.hpp"
 
 namespace shard{
     namespace gfx{
@@ -17,15 +18,17 @@ namespace shard{
 
                 ShaderModule& operator = (ShaderModule& sm){
                     assert(&device == &sm.device);
-                    vkDestroyShaderModule(device.device(), _shaderModule, nullptr);
+                    destroy();
                     _shaderModule = sm._shaderModule;
+                    _reflection = std::move(sm._reflection);
                     sm._shaderModule = VK_NULL_HANDLE;
                     return *this;
                 }
                 ShaderModule& operator = (ShaderModule&& sm){
                     assert(&device == &sm.device);
-                    vkDestroyShaderModule(device.device(), _shaderModule, nullptr);
+                    destroy();
                     _shaderModule = sm._shaderModule;
+                    _reflection = std::move(sm._reflection);
                     sm._shaderModule = VK_NULL_HANDLE;
                     return *this;
                 }
@@ -34,11 +37,16 @@ namespace shard{
 
                 VkShaderModule shaderModule() { return _shaderModule; }
                 const VkShaderModule shaderModule() const { return _shaderModule; }
+                // Interface of the module, parsed from the SPIR-V when it was loaded
+                const ShaderReflection& reflection() const { return _reflection; }
+                VkShaderStageFlagBits stage() const { return _reflection.stage; }
             private:
+                void destroy();
                 void init(const std::vector<char>& spv);
                 
                 Device& device;
                 VkShaderModule _shaderModule=VK_NULL_HANDLE;
+                ShaderReflection _reflection;
         };
     } // namespace gfx
 } // namespace shard
@@ -0,0 +1,53 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace shard{
+    namespace gfx{
+        // What a pipeline needs to know about a SPIR-V module's interface
+        struct ShaderReflection{
+            struct DescriptorBinding{
+                uint32_t set;
+                uint32_t binding;
+                VkDescriptorType type;
+                uint32_t count; // 0 for runtime sized arrays
+            };
+            struct VertexInput{
+                uint32_t location;
+                VkFormat format;
+            };
+
+            VkShaderStageFlagBits stage = VkShaderStageFlagBits(0);
+            std::vector<DescriptorBinding> bindings; // sorted by set and binding
+            // Size 0 if the module has no push constant block
+            VkPushConstantRange pushConstants = {};
+            std::vector<VertexInput> vertexInputs;   // sorted by location, vertex shaders only
+            uint32_t localSize[3] = {0, 0, 0};       // compute shaders only
+
+            // Parses the module, invalid modules give an empty reflection with stage 0
+            static ShaderReflection reflect(const uint32_t* code, size_t wordCount);
+
+            bool valid() const { return stage != VkShaderStageFlagBits(0); }
+        };
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+
+#include "device.hpp"
+#include "pipeline.hpp"
+#include "compute.hpp"
+
+namespace shard{
+    namespace gfx{
+        // Development mode shader hot reload. Watched pipelines take the same SPIR-V
+        // paths the pipeline was created with, the GLSL source is the path without
+        // ".spv" (matching the shaders target in CMakeLists.txt).
+        //
+        // A background thread watches the sources (inotify on Linux, polling
+        // elsewhere), recompiles changed ones with glslc and loads them. swap() builds
+        // the replacement pipelines and moves them in, old pipelines are retired
+        // through Device::deferDestroy. Graphics calls swap() at the start of every
+        // frame once Graphics::shaderReloader() has been used.
+        class ShaderReloader{
+            public:
+                ShaderReloader(Device& _device, const char* compiler = "glslc");
+                ~ShaderReloader();
+
+                shard_delete_copy_constructors(ShaderReloader);
+
+                // The pipeline and config must outlive the watch. renderPass is asked for
+                // the current render pass when the pipeline is rebuilt, since swapchain
+                // render passes are replaced on resize:
+                //     [&gfx](){ return gfx.swapchain().renderPass(); }
+                void watch(
+                    Pipeline& pipeline,
+                    std::function<VkRenderPass()> renderPass,
+                    VkPipelineLayout layout,
+                    const char* vertFile,
+                    const char* fragFile,
+                    const std::vector<VkVertexInputBindingDescription>& bindingDescs,
+                    const std::vector<VkVertexInputAttributeDescription>& attrDescs,
+                    PipelineConfigInfo& config,
+                    const SpecializationConstants& constants = {}
+                );
+                void watch(
+                    Compute& compute, VkPipelineLayout layout, const char* filePath,
+                    const SpecializationConstants& constants = {}
+                );
+                void unwatch(Pipeline& pipeline) { unwatch(static_cast<void*>(&pipeline)); }
+                void unwatch(Compute& compute) { unwatch(static_cast<void*>(&compute)); }
+
+                // Call between frames, returns the number of pipelines replaced
+                uint32_t swap();
+            private:
+                struct Target{
+                    Pipeline* pipeline = nullptr;
+                    Compute* compute = nullptr;
+                    std::function<VkRenderPass()> renderPass;
+                    VkPipelineLayout layout = VK_NULL_HANDLE;
+                    std::vector<std::string> spvFiles; // vert, frag or comp
+                    std::vector<VkVertexInputBindingDescription> bindingDescs;
+                    std::vector<VkVertexInputAttributeDescription> attrDescs;
+                    PipelineConfigInfo* config = nullptr;
+                    SpecializationConstants constants;
+                };
+                // Graphics pipelines are created by swap() against the current render pass
+                struct Rebuilt{
+                    void* target;
+                    std::unique_ptr<ShaderModule> vert;
+                    std::unique_ptr<ShaderModule> frag;
+                    std::unique_ptr<Compute> compute;
+                };
+
+                void unwatch(void* target);
+                void addSource(const std::string& spvFile);
+                void worker();
+                std::vector<std::string> pollChanges();
+                bool compile(const std::string& source);
+                void rebuild(void* key, const Target& target);
+
+                Device& device;
+                std::string compiler;
+
+                std::mutex mutex;
+                std::map<void*, Target> targets;
+                std::deque<Rebuilt> rebuilt;
+                // Source path -> last seen write time, used by the polling fallback
+                std::map<std::string, int64_t> sources;
+
+                int notifyFd = -1;
+                std::map<int, std::string> watchedDirs;
+
+                std::atomic<bool> stopping = false;
+                std::thread thread;
+        };
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <type_traits>
+
+namespace shard{
+    namespace gfx{
+        // Typed values for a shader's constant_id constants. Ids a stage does not
+        // declare are ignored, so one set can be shared by every stage of a pipeline.
+        class SpecializationConstants{
+            public:
+                SpecializationConstants() = default;
+
+                // bool is stored as VkBool32, setting an id twice replaces its value
+                template<typename T>
+                SpecializationConstants& set(uint32_t constantID, T value){
+                    static_assert(std::is_arithmetic_v<T>, "Specialization constants must be scalars!");
+                    if constexpr(std::is_same_v<T, bool>){
+                        return set(constantID, VkBool32(value ? VK_TRUE : VK_FALSE));
+                    } else{
+                        static_assert(
+                            sizeof(T) == 4 || sizeof(T) == 8,
+                            "Specialization constants must be 32 or 64 bit!"
+                        );
+                        for(auto& entry : entries){
+                            if(entry.constantID != constantID) continue;
+                            assert(entry.size == sizeof(T) && "Constant was set with a different type!");
+                            std::memcpy(data.data() + entry.offset, &value, sizeof(T));
+                            return *this;
+                        }
+
+                        VkSpecializationMapEntry entry = {};
+                        entry.constantID = constantID;
+                        entry.offset = uint32_t(data.size());
+                        entry.size = sizeof(T);
+                        entries.push_back(entry);
+                        data.resize(data.size() + sizeof(T));
+                        std::memcpy(data.data() + entry.offset, &value, sizeof(T));
+                        return *this;
+                    }
+                }
+
+                bool empty() const { return entries.empty(); }
+
+                // nullptr when empty, valid until the constants are modified or destroyed
+                const VkSpecializationInfo* info() const {
+                    if(empty()) return nullptr;
+                    _info.mapEntryCount = uint32_t(entries.size());
+                    _info.pMapEntries = entries.data();
+                    _info.dataSize = data.size();
+                    _info.pData = data.data();
+                    return &_info;
+                }
+
+                // Ids and values sorted by id, identical for equal sets of constants
+                std::vector<uint64_t> key() const {
+                    std::vector<uint64_t> k;
+                    k.reserve(entries.size() * 2);
+                    std::vector<const VkSpecializationMapEntry*> sorted;
+                    for(auto& entry : entries) sorted.push_back(&entry);
+                    std::sort(sorted.begin(), sorted.end(), [](auto a, auto b){
+                        return a->constantID < b->constantID;
+                    });
+                    for(auto entry : sorted){
+                        uint64_t value = 0;
+                        std::memcpy(&value, data.data() + entry->offset, entry->size);
+                        k.push_back(entry->constantID);
+                        k.push_back(value);
+                    }
+                    return k;
+                }
+            private:
+                std::vector<VkSpecializationMapEntry> entries;
+                std::vector<uint8_t> data;
+                mutable VkSpecializationInfo _info = {};
+        };
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
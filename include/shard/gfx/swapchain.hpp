@@ -6,16 +6,30 @@
 #include "../utils.hpp"
 
 #include <memory>
+#include <array>
+#include <limits>
 
 namespace shard{
     namespace gfx{
+        // Preferred present mode, falls back to FIFO (always supported) when unavailable
+        enum class PresentPolicy{
+            FIFO,         // vsync, never tears, highest latency
+            FIFO_RELAXED, // vsync, tears instead of waiting when a frame is late
+            MAILBOX,      // vsync without blocking, the newest frame replaces queued ones
+            IMMEDIATE     // no vsync, falls back to MAILBOX then FIFO
+        };
+
         class Swapchain{
             public:
                 static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 2;
+                const PresentPolicy PRESENT_POLICY;
                 const bool VSYNC;
 
-                Swapchain(Device& refDevice, VkExtent2D winExtent, bool vsync);
-                Swapchain(Device& refDevice, VkExtent2D winExtent, bool vsync, std::shared_ptr<Swapchain> previous);
+                Swapchain(Device& refDevice, VkExtent2D winExtent, PresentPolicy policy);
+                Swapchain(
+                    Device& refDevice, VkExtent2D winExtent, PresentPolicy policy,
+                    std::shared_ptr<Swapchain> previous
+                );
                 ~Swapchain();
 
                 shard_delete_copy_constructors(Swapchain);
@@ -33,10 +47,21 @@ namespace shard{
                     return static_cast<float>(_swapchainExtent.width) /
                            static_cast<float>(_swapchainExtent.height);
                 }
+                VkPresentModeKHR presentMode() { return _presentMode; }
                 VkFormat findDepthFormat();
 
-                VkResult acquireNextImage(uint32_t *imageIndex);
+                VkResult acquireNextImage(
+                    uint32_t *imageIndex, uint64_t timeout = std::numeric_limits<uint64_t>::max()
+                );
                 VkResult submitCommandBuffers(const VkCommandBuffer *buffers, uint32_t *imageIndex);
+
+                // Id of the last present, 0 when VK_KHR_present_id is not available
+                uint64_t lastPresentId() { return presentId; }
+                // Blocks until the present with presentId is visible, returns VK_SUCCESS straight away
+                // when VK_KHR_present_wait is not available
+                VkResult waitForPresent(uint64_t presentId, uint64_t timeout);
+                // Seconds spent waiting on the frame fence in the last acquireNextImage
+                float lastFenceWaitTime() { return fenceWaitTime; }
             private:
                 void init();
                 void createSwapchain();
@@ -58,6 +83,7 @@ namespace shard{
                 VkFormat _swapchainImageFormat;
                 VkFormat swapchainDepthFormat;
                 VkExtent2D _swapchainExtent;
+                VkPresentModeKHR _presentMode = VK_PRESENT_MODE_FIFO_KHR;
 
                 std::vector<Framebuffer> swapchainFramebuffers;
                 VkRenderPass _renderPass;
@@ -75,7 +101,11 @@ namespace shard{
                 std::vector<VkSemaphore> renderFinishedSemaphores;
                 std::vector<VkFence> inFlightFences;
                 std::vector<VkFence> imagesInFlight;
+                // Device frame value last submitted with each in flight fence
+                std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> fenceFrameValues = {};
                 size_t currentFrame = 0;
+                uint64_t presentId = 0;
+                float fenceWaitTime = 0.0f;
         };
     } // namespace gfx
 } // namespace shard
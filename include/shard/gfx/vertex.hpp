@@ -9,6 +9,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <array>
+#include <cstddef>
 #include <vector>
 #include <unordered_map>
 #include <memory.h>
@@ -16,8 +17,7 @@
 #include "../utils.hpp"
 #include "../def.hpp"
 #include "color.hpp"
-
-#include <tiny_obj_loader.h>
+#include "vertexLayout.hpp"
 
 namespace shard{
     namespace gfx{
@@ -47,35 +47,15 @@ namespace shard{
                        color == v.color;
             }
 
+            using Layout = VertexLayout<attr::Float2, attr::Float2, attr::Float4>;
+
             static VkVertexInputBindingDescription bindingDesc(
                 VkVertexInputRate inputRate
             ){
-                VkVertexInputBindingDescription binding = {};
-                binding.binding = 0;
-                binding.stride = sizeof(Vertex2D);
-                binding.inputRate = inputRate;
-                return binding;
+                return Layout::bindingDesc(inputRate);
             }
-
             static std::vector<VkVertexInputAttributeDescription> attributeDescs(){
-                std::vector<VkVertexInputAttributeDescription> attrs(3);
-
-                attrs[0].binding = 0;
-                attrs[0].location = 0;
-                attrs[0].format = VK_FORMAT_R32G32_SFLOAT;
-                attrs[0].offset = offsetof(Vertex2D, pos);
-                
-                attrs[1].binding = 0;
-                attrs[1].location = 1;
-                attrs[1].format = VK_FORMAT_R32G32_SFLOAT;
-                attrs[1].offset = offsetof(Vertex2D, uv);
-
-                attrs[2].binding = 0;
-                attrs[2].location = 2;
-                attrs[2].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-                attrs[2].offset = offsetof(Vertex2D, color);
-
-                return attrs;
+                return Layout::attributeDescs();
             }
         };
         struct Vertex3D{
@@ -109,42 +89,174 @@ namespace shard{
                        color  == v.color;
             }
 
+            using Layout = VertexLayout<attr::Float3, attr::Float2, attr::Float3, attr::Float4>;
+            // Split layout: positions at binding 0, everything else at binding 1
+            using Streams = VertexStreams<
+                VertexLayout<attr::Float3>,
+                VertexLayout<attr::Float2, attr::Float3, attr::Float4>
+            >;
+
+            static VkVertexInputBindingDescription bindingDesc(
+                VkVertexInputRate inputRate
+            ){
+                return Layout::bindingDesc(inputRate);
+            }
+            static std::vector<VkVertexInputAttributeDescription> attributeDescs(){
+                return Layout::attributeDescs();
+            }
+        };
+
+        // Second stream of Vertex3D::Streams
+        struct Vertex3DAttributes{
+            glm::vec2 uv;
+            glm::vec3 normal;
+            Color     color;
+        };
+
+        inline void splitVertexStreams(
+            const std::vector<Vertex3D>& vertices,
+            std::vector<glm::vec3>& positions,
+            std::vector<Vertex3DAttributes>& attributes
+        ){
+            positions.resize(vertices.size());
+            attributes.resize(vertices.size());
+            for(size_t i = 0; i < vertices.size(); i++){
+                positions[i] = vertices[i].pos;
+                attributes[i] = {vertices[i].uv, vertices[i].normal, vertices[i].color};
+            }
+        }
+
+        // 24 bytes: half float uv, octahedral normal, RGBA8 color.
+        // Same locations as Vertex3D, shaders decode the normal and read the color
+        // in the 0-1 range rather than Vertex3D's 0-255.
+        struct CompactVertex3D{
+            glm::vec3               pos;
+            std::array<uint16_t, 2> uv;
+            std::array<int16_t,  2> normal;
+            std::array<uint8_t,  4> color;
+
+            using Layout = VertexLayout<attr::Float3, attr::Half2, attr::Snorm16x2, attr::Unorm8x4>;
+
+            static CompactVertex3D from(const Vertex3D& v);
+
             static VkVertexInputBindingDescription bindingDesc(
                 VkVertexInputRate inputRate
             ){
-                VkVertexInputBindingDescription binding = {};
-                binding.binding = 0;
-                binding.stride = sizeof(Vertex3D);
-                binding.inputRate = inputRate;
-                return binding;
+                return Layout::bindingDesc(inputRate);
+            }
+            static std::vector<VkVertexInputAttributeDescription> attributeDescs(){
+                return Layout::attributeDescs();
+            }
+        };
+
+        // Positions of QuantizedVertex3D are stored relative to the mesh bounds,
+        // decode with pos = offset + scale * inPos.xyz
+        struct VertexQuantization{
+            glm::vec3 offset = glm::vec3(0.0f);
+            glm::vec3 scale  = glm::vec3(1.0f);
+
+            static VertexQuantization fromBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax){
+                VertexQuantization q;
+                q.offset = (boundsMin + boundsMax) * 0.5f;
+                q.scale = glm::max((boundsMax - boundsMin) * 0.5f, glm::vec3(1e-6f));
+                return q;
             }
+        };
+
+        // 20 bytes: CompactVertex3D with SNORM16 positions
+        struct QuantizedVertex3D{
+            std::array<int16_t,  4> pos; // w is unused
+            std::array<uint16_t, 2> uv;
+            std::array<int16_t,  2> normal;
+            std::array<uint8_t,  4> color;
 
+            using Layout = VertexLayout<attr::Snorm16x4, attr::Half2, attr::Snorm16x2, attr::Unorm8x4>;
+
+            static QuantizedVertex3D from(const Vertex3D& v, const VertexQuantization& quantization);
+
+            static VkVertexInputBindingDescription bindingDesc(
+                VkVertexInputRate inputRate
+            ){
+                return Layout::bindingDesc(inputRate);
+            }
             static std::vector<VkVertexInputAttributeDescription> attributeDescs(){
-                std::vector<VkVertexInputAttributeDescription> attrs(4);
-
-                attrs[0].binding = 0;
-                attrs[0].location = 0;
-                attrs[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-                attrs[0].offset = offsetof(Vertex3D, pos);
-                
-                attrs[1].binding = 0;
-                attrs[1].location = 1;
-                attrs[1].format = VK_FORMAT_R32G32_SFLOAT;
-                attrs[1].offset = offsetof(Vertex3D, uv);
-
-                attrs[2].binding = 0;
-                attrs[2].location = 2;
-                attrs[2].format = VK_FORMAT_R32G32B32_SFLOAT;
-                attrs[2].offset = offsetof(Vertex3D, normal);
-
-                attrs[3].binding = 0;
-                attrs[3].location = 3;
-                attrs[3].format = VK_FORMAT_R32G32B32A32_SFLOAT;
-                attrs[3].offset = offsetof(Vertex3D, color);
-
-                return attrs;
+                return Layout::attributeDescs();
             }
         };
+
+        static_assert(sizeof(Vertex2D) == Vertex2D::Layout::stride);
+        static_assert(offsetof(Vertex2D, pos)   == Vertex2D::Layout::offsets[0]);
+        static_assert(offsetof(Vertex2D, uv)    == Vertex2D::Layout::offsets[1]);
+        static_assert(offsetof(Vertex2D, color) == Vertex2D::Layout::offsets[2]);
+
+        static_assert(sizeof(Vertex3D) == Vertex3D::Layout::stride);
+        static_assert(offsetof(Vertex3D, pos)    == Vertex3D::Layout::offsets[0]);
+        static_assert(offsetof(Vertex3D, uv)     == Vertex3D::Layout::offsets[1]);
+        static_assert(offsetof(Vertex3D, normal) == Vertex3D::Layout::offsets[2]);
+        static_assert(offsetof(Vertex3D, color)  == Vertex3D::Layout::offsets[3]);
+
+        static_assert(sizeof(glm::vec3) == Vertex3D::Streams::strides[0]);
+        static_assert(sizeof(Vertex3DAttributes) == Vertex3D::Streams::strides[1]);
+        static_assert(offsetof(Vertex3DAttributes, normal) == 8);
+        static_assert(offsetof(Vertex3DAttributes, color) == 20);
+
+        static_assert(sizeof(CompactVertex3D) == CompactVertex3D::Layout::stride);
+        static_assert(sizeof(CompactVertex3D) == 24);
+        static_assert(offsetof(CompactVertex3D, pos)    == CompactVertex3D::Layout::offsets[0]);
+        static_assert(offsetof(CompactVertex3D, uv)     == CompactVertex3D::Layout::offsets[1]);
+        static_assert(offsetof(CompactVertex3D, normal) == CompactVertex3D::Layout::offsets[2]);
+        static_assert(offsetof(CompactVertex3D, color)  == CompactVertex3D::Layout::offsets[3]);
+
+        static_assert(sizeof(QuantizedVertex3D) == QuantizedVertex3D::Layout::stride);
+        static_assert(sizeof(QuantizedVertex3D) == 20);
+        static_assert(offsetof(QuantizedVertex3D, pos)    == QuantizedVertex3D::Layout::offsets[0]);
+        static_assert(offsetof(QuantizedVertex3D, uv)     == QuantizedVertex3D::Layout::offsets[1]);
+        static_assert(offsetof(QuantizedVertex3D, normal) == QuantizedVertex3D::Layout::offsets[2]);
+        static_assert(offsetof(QuantizedVertex3D, color)  == QuantizedVertex3D::Layout::offsets[3]);
+
+        // Color channels are in the 0-255 range
+        inline std::array<uint8_t, 4> packColor(const Color& color){
+            auto q = [](float c){ return static_cast<uint8_t>(std::clamp(c, 0.0f, 255.0f) + 0.5f); };
+            return {q(color.r), q(color.g), q(color.b), q(color.a)};
+        }
+
+        inline CompactVertex3D CompactVertex3D::from(const Vertex3D& v){
+            CompactVertex3D c;
+            c.pos = v.pos;
+            c.uv = {floatToHalf(v.uv.x), floatToHalf(v.uv.y)};
+            c.normal = octEncode(v.normal);
+            c.color = packColor(v.color);
+            return c;
+        }
+        inline QuantizedVertex3D QuantizedVertex3D::from(const Vertex3D& v, const VertexQuantization& quantization){
+            glm::vec3 p = (v.pos - quantization.offset) / quantization.scale;
+            QuantizedVertex3D q;
+            q.pos = {floatToSnorm16(p.x), floatToSnorm16(p.y), floatToSnorm16(p.z), 32767};
+            q.uv = {floatToHalf(v.uv.x), floatToHalf(v.uv.y)};
+            q.normal = octEncode(v.normal);
+            q.color = packColor(v.color);
+            return q;
+        }
+
+        // 16 bit indices up to 0xFFFF vertices, so 0xFFFF stays free as the primitive restart index
+        inline VkIndexType selectIndexType(size_t vertexCount){
+            return vertexCount <= 0xFFFF ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+        }
+        inline size_t indexTypeSize(VkIndexType type){
+            return type == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+        }
+        // Writes count indices as type into dst, which holds count*indexTypeSize(type) bytes
+        inline void packIndices(void* dst, const uint32_t* indices, size_t count, VkIndexType type){
+            if(type == VK_INDEX_TYPE_UINT32){
+                memcpy(dst, indices, count*sizeof(uint32_t));
+                return;
+            }
+            uint16_t* dst16 = static_cast<uint16_t*>(dst);
+            for(size_t i = 0; i < count; i++){
+                assert(indices[i] <= 0xFFFF);
+                dst16[i] = static_cast<uint16_t>(indices[i]);
+            }
+        }
     } // namespace gfx
 } // namespace shard
 
@@ -178,72 +290,6 @@ namespace std {
     };
 }  // namespace std
 
-namespace shard{
-    namespace gfx{
-        class ModelLoader{
-            public:
-                std::vector<Vertex3D> vertices;
-                std::vector<uint32_t> indices;
-
-                ModelLoader(const char* filePath){
-                    tinyobj::attrib_t attrib;
-                    std::vector<tinyobj::shape_t> shapes;
-                    std::vector<tinyobj::material_t> materials;
-                    std::string warn, err;
-
-                    shard_abort_ifnot(tinyobj::LoadObj(
-                            &attrib, &shapes, &materials, &warn, &err, filePath
-                    ));
-
-                    vertices.clear();
-                    indices.clear();
-
-                    std::unordered_map<Vertex3D, uint32_t> uniqueVertices = {};
-                    for (const auto &shape : shapes) {
-                        for (const auto &index : shape.mesh.indices) {
-                        Vertex3D vertex{};
-
-                        if (index.vertex_index >= 0) {
-                            vertex.pos = {
-                                attrib.vertices[3 * index.vertex_index + 0],
-                                attrib.vertices[3 * index.vertex_index + 1],
-                                attrib.vertices[3 * index.vertex_index + 2],
-                            };
-
-                            vertex.color = {
-                                attrib.colors[3 * index.vertex_index + 0],
-                                attrib.colors[3 * index.vertex_index + 1],
-                                attrib.colors[3 * index.vertex_index + 2],
-                            };
-                        }
-
-                        if (index.normal_index >= 0) {
-                            vertex.normal = {
-                                attrib.normals[3 * index.normal_index + 0],
-                                attrib.normals[3 * index.normal_index + 1],
-                                attrib.normals[3 * index.normal_index + 2],
-                            };
-                        }
-
-                        if (index.texcoord_index >= 0) {
-                            vertex.uv = {
-                                attrib.texcoords[2 * index.texcoord_index + 0],
-                                attrib.texcoords[2 * index.texcoord_index + 1],
-                            };
-                        }
-
-                        if (uniqueVertices.count(vertex) == 0) {
-                            uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-                            vertices.push_back(vertex);
-                        }
-                            indices.push_back(uniqueVertices[vertex]);
-                        }
-                    }
-                }
-            };
-    } // namespace gfx
-} // namespace shard
-
 /**
     Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
     
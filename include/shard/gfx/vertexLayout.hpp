@@ -0,0 +1,239 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <array>
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+namespace shard{
+    namespace gfx{
+        // A vertex attribute is its storage type plus the format the input assembler reads
+        template<typename T, VkFormat Format>
+        struct VertexAttribute{
+            using Type = T;
+            static constexpr VkFormat format = Format;
+            static constexpr uint32_t size = sizeof(T);
+            static constexpr uint32_t alignment = alignof(T);
+        };
+
+        namespace attr{
+            using Float2    = VertexAttribute<glm::vec2, VK_FORMAT_R32G32_SFLOAT>;
+            using Float3    = VertexAttribute<glm::vec3, VK_FORMAT_R32G32B32_SFLOAT>;
+            using Float4    = VertexAttribute<glm::vec4, VK_FORMAT_R32G32B32A32_SFLOAT>;
+            using Half2     = VertexAttribute<std::array<uint16_t, 2>, VK_FORMAT_R16G16_SFLOAT>;
+            using Half4     = VertexAttribute<std::array<uint16_t, 4>, VK_FORMAT_R16G16B16A16_SFLOAT>;
+            using Snorm16x2 = VertexAttribute<std::array<int16_t,  2>, VK_FORMAT_R16G16_SNORM>;
+            using Snorm16x4 = VertexAttribute<std::array<int16_t,  4>, VK_FORMAT_R16G16B16A16_SNORM>;
+            using Unorm8x4  = VertexAttribute<std::array<uint8_t,  4>, VK_FORMAT_R8G8B8A8_UNORM>;
+            using Snorm8x4  = VertexAttribute<std::array<int8_t,   4>, VK_FORMAT_R8G8B8A8_SNORM>;
+        } // namespace attr
+
+        // Interleaved layout of Attrs in declaration order, each attribute at its natural
+        // alignment. Locations are assigned in order starting at firstLocation.
+        // Vertex structs static_assert their size and offsets against their layout.
+        template<typename... Attrs>
+        struct VertexLayout{
+            static constexpr uint32_t attributeCount = sizeof...(Attrs);
+            static constexpr std::array<VkFormat, attributeCount> formats = {Attrs::format...};
+            static constexpr std::array<uint32_t, attributeCount> offsets = [](){
+                constexpr uint32_t sizes[] = {Attrs::size...};
+                constexpr uint32_t alignments[] = {Attrs::alignment...};
+                std::array<uint32_t, attributeCount> result = {};
+                uint32_t offset = 0;
+                for(uint32_t i = 0; i < attributeCount; i++){
+                    offset = (offset + alignments[i] - 1) / alignments[i] * alignments[i];
+                    result[i] = offset;
+                    offset += sizes[i];
+                }
+                return result;
+            }();
+            static constexpr uint32_t stride = [](){
+                constexpr uint32_t sizes[] = {Attrs::size...};
+                uint32_t alignment = std::max({Attrs::alignment...});
+                uint32_t end = offsets[attributeCount - 1] + sizes[attributeCount - 1];
+                return (end + alignment - 1) / alignment * alignment;
+            }();
+
+            static VkVertexInputBindingDescription bindingDesc(
+                VkVertexInputRate inputRate, uint32_t binding = 0
+            ){
+                VkVertexInputBindingDescription desc = {};
+                desc.binding = binding;
+                desc.stride = stride;
+                desc.inputRate = inputRate;
+                return desc;
+            }
+
+            static std::vector<VkVertexInputAttributeDescription> attributeDescs(
+                uint32_t binding = 0, uint32_t firstLocation = 0
+            ){
+                std::vector<VkVertexInputAttributeDescription> attrs(attributeCount);
+                for(uint32_t i = 0; i < attributeCount; i++){
+                    attrs[i].binding = binding;
+                    attrs[i].location = firstLocation + i;
+                    attrs[i].format = formats[i];
+                    attrs[i].offset = offsets[i];
+                }
+                return attrs;
+            }
+        };
+
+        // One layout per vertex buffer binding. Locations continue across streams, so
+        // shaders see the same inputs as with the interleaved layout, and passes that
+        // only need the first stream(s) can bind just those.
+        template<typename... Layouts>
+        struct VertexStreams{
+            static constexpr uint32_t streamCount = sizeof...(Layouts);
+            static constexpr std::array<uint32_t, streamCount> strides = {Layouts::stride...};
+
+            static std::vector<VkVertexInputBindingDescription> bindingDescs(
+                VkVertexInputRate inputRate, uint32_t firstBinding = 0
+            ){
+                std::vector<VkVertexInputBindingDescription> bindings(streamCount);
+                for(uint32_t i = 0; i < streamCount; i++){
+                    bindings[i].binding = firstBinding + i;
+                    bindings[i].stride = strides[i];
+                    bindings[i].inputRate = inputRate;
+                }
+                return bindings;
+            }
+
+            static std::vector<VkVertexInputAttributeDescription> attributeDescs(
+                uint32_t firstBinding = 0, uint32_t firstLocation = 0
+            ){
+                std::vector<VkVertexInputAttributeDescription> attrs;
+                uint32_t binding = firstBinding;
+                uint32_t location = firstLocation;
+                auto append = [&](std::vector<VkVertexInputAttributeDescription>&& stream){
+                    attrs.insert(attrs.end(), stream.begin(), stream.end());
+                    location += static_cast<uint32_t>(stream.size());
+                    binding++;
+                };
+                (append(Layouts::attributeDescs(binding, location)), ...);
+                return attrs;
+            }
+        };
+
+        // IEEE half precision, rounds to nearest even
+        inline uint16_t floatToHalf(float value){
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+
+            uint32_t sign = (bits >> 16) & 0x8000;
+            uint32_t exponent = (bits >> 23) & 0xFF;
+            uint32_t mantissa = bits & 0x7FFFFF;
+
+            if(exponent == 0xFF){
+                return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+            }
+            int32_t halfExponent = int32_t(exponent) - 127 + 15;
+            if(halfExponent >= 0x1F){
+                return static_cast<uint16_t>(sign | 0x7C00);
+            }
+            if(halfExponent <= 0){
+                // Subnormal or zero
+                if(halfExponent < -10) return static_cast<uint16_t>(sign);
+                mantissa |= 0x800000;
+                uint32_t shift = uint32_t(14 - halfExponent);
+                uint32_t half = mantissa >> shift;
+                uint32_t remainder = mantissa & ((1u << shift) - 1);
+                uint32_t halfway = 1u << (shift - 1);
+                if(remainder > halfway || (remainder == halfway && (half & 1))) half++;
+                return static_cast<uint16_t>(sign | half);
+            }
+
+            uint32_t half = sign | uint32_t(halfExponent) << 10 | mantissa >> 13;
+            uint32_t remainder = mantissa & 0x1FFF;
+            // A carry out of the mantissa correctly bumps the exponent
+            if(remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) half++;
+            return static_cast<uint16_t>(half);
+        }
+        inline float halfToFloat(uint16_t half){
+            uint32_t sign = uint32_t(half & 0x8000) << 16;
+            uint32_t exponent = (half >> 10) & 0x1F;
+            uint32_t mantissa = half & 0x3FF;
+
+            uint32_t bits;
+            if(exponent == 0x1F){
+                bits = sign | 0x7F800000 | mantissa << 13;
+            } else if(exponent == 0){
+                if(mantissa == 0){
+                    bits = sign;
+                } else{
+                    // Normalize the subnormal
+                    exponent = 127 - 15 + 1;
+                    while(!(mantissa & 0x400)){
+                        mantissa <<= 1;
+                        exponent--;
+                    }
+                    bits = sign | exponent << 23 | (mantissa & 0x3FF) << 13;
+                }
+            } else{
+                bits = sign | (exponent + 127 - 15) << 23 | mantissa << 13;
+            }
+
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        inline int16_t floatToSnorm16(float value){
+            return static_cast<int16_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+        }
+        inline float snorm16ToFloat(int16_t value){
+            return std::max(float(value) / 32767.0f, -1.0f);
+        }
+
+        // Octahedral normal encoding, decode in GLSL with:
+        //   vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+        //   float t = max(-n.z, 0.0);
+        //   n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+        //   n = normalize(n);
+        inline std::array<int16_t, 2> octEncode(const glm::vec3& normal){
+            float l1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+            if(l1 == 0.0f) return {0, 0};
+
+            float x = normal.x / l1;
+            float y = normal.y / l1;
+            if(normal.z < 0.0f){
+                float ox = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+                float oy = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+                x = ox;
+                y = oy;
+            }
+            return {floatToSnorm16(x), floatToSnorm16(y)};
+        }
+        inline glm::vec3 octDecode(const std::array<int16_t, 2>& encoded){
+            glm::vec3 n(snorm16ToFloat(encoded[0]), snorm16ToFloat(encoded[1]), 0.0f);
+            n.z = 1.0f - std::abs(n.x) - std::abs(n.y);
+            float t = std::max(-n.z, 0.0f);
+            n.x += n.x >= 0.0f ? -t : t;
+            n.y += n.y >= 0.0f ? -t : t;
+            return glm::normalize(n);
+        }
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#include "../utils.hpp"
+
+namespace shard{
+    namespace job{
+        // Fixed set of worker threads pulling jobs from a shared FIFO queue
+        class ThreadPool{
+            public:
+                // 0 uses every hardware thread except the calling one
+                ThreadPool(uint32_t threadCount = 0);
+                ~ThreadPool();
+
+                shard_delete_copy_constructors(ThreadPool);
+
+                void submit(std::function<void()>&& job);
+                // Blocks until the queue is empty and every worker is idle
+                void wait();
+                // Splits [0, count) into batches of batchSize and runs f(begin, end) on the
+                // workers and the calling thread, returns once every batch has finished.
+                // Must not be called from one of the pool's own jobs.
+                void parallelFor(
+                    uint32_t count, uint32_t batchSize,
+                    const std::function<void(uint32_t, uint32_t)>& f
+                );
+
+                uint32_t threadCount() const { return static_cast<uint32_t>(threads.size()); }
+                uint32_t pendingCount();
+            private:
+                void worker();
+
+                std::vector<std::thread> threads;
+                std::deque<std::function<void()>> jobs;
+                std::mutex mutex;
+                std::condition_variable jobCondition;
+                std::condition_variable idleCondition;
+                uint32_t activeCount = 0;
+                bool stopping = false;
+        };
+    } // namespace job
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "utils.hpp"
+
+namespace shard{
+    // Read only memory mapping of a whole file
+    class MappedFile{
+        public:
+            MappedFile() = default;
+            MappedFile(const char* filePath);
+            MappedFile(MappedFile&& f);
+            ~MappedFile();
+
+            shard_delete_copy_constructors(MappedFile);
+
+            MappedFile& operator = (MappedFile&& f);
+
+            const uint8_t* data() const { return _data; }
+            size_t size() const { return _size; }
+            bool valid() const { return _data != nullptr; }
+        private:
+            void close();
+
+            const uint8_t* _data = nullptr;
+            size_t _size = 0;
+        #if defined(_WIN32)
+            void* fileHandle = nullptr;
+            void* mappingHandle = nullptr;
+        #endif
+    };
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <vector>
+
+#include "renderer.hpp"
+
+namespace shard{
+    namespace r2d{
+        // Bottom-left skyline rectangle packer
+        class SkylinePacker{
+            public:
+                SkylinePacker(uint32_t w, uint32_t h);
+
+                // Returns false if the rectangle does not fit
+                bool insert(uint32_t w, uint32_t h, glm::uvec2& pos);
+                void reset();
+
+                uint32_t width() const { return _width; }
+                uint32_t height() const { return _height; }
+                // Fraction of the area covered by inserted rectangles
+                float occupancy() const {
+                    return float(usedArea) / float(uint64_t(_width) * uint64_t(_height));
+                }
+            private:
+                struct Node{
+                    int32_t x, y, width;
+                };
+
+                bool fits(size_t index, int32_t w, int32_t h, int32_t& y) const;
+                void addLevel(size_t index, int32_t x, int32_t y, int32_t w, int32_t h);
+
+                uint32_t _width, _height;
+                uint64_t usedArea = 0;
+                std::vector<Node> skyline;
+        };
+
+        using AtlasHandle = uint64_t;
+
+        struct AtlasRegion{
+            TextureID texture;
+            uint32_t  page;
+            // Normalized source rectangle matching Sprite::srcPos/srcSize
+            glm::vec2 srcPos;
+            glm::vec2 srcSize;
+        };
+
+        // Packs many small RGBA8 images into a few large pages that are registered with
+        // the renderer as regular textures, so sprites from the same page batch together.
+        // Images are staged on insertion and copied into their pages by recordUploads(),
+        // which has to be called outside of a render pass every frame, e.g. from the
+        // preRenderPassCommands of Graphics::beginRenderPass.
+        //
+        // When every page is full and no new page may be created the least recently used
+        // page is evicted, invalidating the handles of every image in it. Pages used in
+        // the frame being recorded are never evicted.
+        class Atlas{
+            public:
+                static constexpr AtlasHandle INVALID_HANDLE = 0;
+                // Gap between packed images to keep linear filtering from bleeding
+                static constexpr uint32_t PADDING = 1;
+
+                Atlas(gfx::Graphics& _gfx, Renderer& _renderer, uint32_t size = 2048, uint32_t maxPageCount = 4);
+                ~Atlas();
+
+                shard_delete_copy_constructors(Atlas);
+
+                // Pixel data must be 8bit RGBA, returns INVALID_HANDLE if the image can't fit
+                AtlasHandle insert(uint32_t w, uint32_t h, const void* pixels);
+                AtlasHandle insert(const char* filePath);
+                // Frees the handle, the space is reclaimed when the page is evicted
+                void remove(AtlasHandle handle);
+                bool contains(AtlasHandle handle) const;
+
+                // Marks the image as used in the current frame
+                bool resolve(AtlasHandle handle, AtlasRegion& region);
+                // Points the sprite at the image, returns false if it has been evicted
+                bool apply(AtlasHandle handle, Sprite& sprite);
+
+                void recordUploads(VkCommandBuffer commandBuffer);
+
+                uint32_t pageSize() const { return _pageSize; }
+                uint32_t pageCount() const { return static_cast<uint32_t>(pages.size()); }
+                uint32_t evictionCount() const { return _evictionCount; }
+            private:
+                struct Page{
+                    Page(gfx::Image&& _image, uint32_t size):
+                        image{std::move(_image)},
+                        packer{size, size}
+                    {}
+
+                    gfx::Image image;
+                    SkylinePacker packer;
+                    TextureID texture = 0;
+                    uint64_t lastUsed = 0;
+                    std::vector<uint32_t> entries;
+                };
+                struct Entry{
+                    uint32_t generation = 0;
+                    bool alive = false;
+                    uint32_t page = 0;
+                    glm::uvec2 pos = {0, 0};
+                    glm::uvec2 size = {0, 0};
+                };
+                struct PendingUpload{
+                    uint32_t page;
+                    glm::uvec2 pos;
+                    glm::uvec2 size;
+                    size_t dataOffset;
+                };
+
+                bool allocate(uint32_t w, uint32_t h, uint32_t& page, glm::uvec2& pos);
+                uint32_t createPage();
+                bool evictPage(uint32_t& page);
+                Entry* lookup(AtlasHandle handle);
+                const Entry* lookup(AtlasHandle handle) const;
+
+                gfx::Graphics& gfx;
+                Renderer& renderer;
+                const uint32_t _pageSize;
+                const uint32_t _maxPages;
+
+                gfx::Sampler sampler;
+                std::vector<Page> pages;
+                std::vector<Entry> entries;
+                std::vector<uint32_t> freeEntries;
+
+                std::vector<PendingUpload> pendingUploads;
+                // Evicted pages, cleared by the next recordUploads()
+                std::vector<uint32_t> pendingClears;
+                std::vector<uint8_t> stagingData;
+
+                uint32_t _evictionCount = 0;
+        };
+    } // namespace r2d
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <vector>
+
+#include "../gfx/gfx.hpp"
+
+namespace shard{
+    namespace r2d{
+        using TextureID = uint32_t;
+
+        struct Sprite{
+            glm::vec2  position = {0.0f, 0.0f}; // center of the sprite
+            glm::vec2  size     = {1.0f, 1.0f};
+            float      rotation = 0.0f;         // radians around the center
+            // Source rectangle in normalized texture coordinates, srcPos is its center
+            glm::vec2  srcPos   = {0.5f, 0.5f};
+            glm::vec2  srcSize  = {1.0f, 1.0f};
+            gfx::Color color    = {255.0f};
+            int32_t    layer    = 0;
+            TextureID  texture  = 0;
+        };
+        struct Rect{
+            glm::vec2  position    = {0.0f, 0.0f}; // center of the rect
+            glm::vec2  size        = {1.0f, 1.0f};
+            float      rotation    = 0.0f;
+            gfx::Color color       = {255.0f};
+            gfx::Color borderColor = {};
+            float      borderSize  = 0.0f;         // in the same units as size, 0 disables the border
+            int32_t    layer       = 0;
+        };
+
+        // Batches sprites and rects into one instance buffer per frame in flight and
+        // draws every run of instances that share a texture with a single instanced draw.
+        // Instances are drawn in ascending layer order, within a layer they are grouped
+        // by texture and otherwise keep their submission order. Use an atlas to keep
+        // sprites on one layer in a single draw.
+        class Renderer{
+            public:
+                // Rects and sprites without a texture sample this 1x1 white texture
+                static constexpr TextureID WHITE_TEXTURE = 0;
+                static constexpr uint32_t MAX_TEXTURES = 256;
+
+                Renderer(gfx::Graphics& _gfx);
+                ~Renderer();
+
+                shard_delete_copy_constructors(Renderer);
+
+                // The image and sampler must outlive the texture registration. The renderer
+                // itself must not be destroyed while frames that used it are in flight.
+                TextureID addTexture(gfx::Image& image, gfx::Sampler& sampler);
+                void removeTexture(TextureID texture);
+
+                void setCamera(const glm::mat4& projection, const glm::mat4& view);
+                // Pixel space with the origin in the top left corner of the swapchain
+                void resetCamera();
+
+                void drawSprite(const Sprite& sprite);
+                void drawRect(const Rect& rect);
+
+                // Records everything queued since the last flush into the current render pass
+                void flush(VkCommandBuffer commandBuffer);
+
+                // Statistics of the last flush
+                uint32_t drawCallCount() const { return _drawCallCount; }
+                uint32_t instanceCount() const { return _instanceCount; }
+            private:
+                struct Instance{
+                    glm::vec2 position;
+                    glm::vec2 size;
+                    glm::vec4 uvRect; // min xy, max xy
+                    uint32_t  color;  // R8G8B8A8_UNORM
+                    uint32_t  borderColor;
+                    float     rotation;
+                    float     borderSize;
+                };
+                struct SortEntry{
+                    uint64_t key; // layer | texture
+                    uint32_t index;
+
+                    bool operator < (const SortEntry& e) const {
+                        return key < e.key || (key == e.key && index < e.index);
+                    }
+                };
+                using CameraPush = gfx::PushConstants<glm::mat4, VK_SHADER_STAGE_VERTEX_BIT>;
+
+                struct FrameBuffer{
+                    FrameBuffer(gfx::Device& device): buffer{device} {}
+
+                    gfx::Buffer buffer;
+                    size_t capacity = 0; // in instances
+                    size_t cursor = 0;
+                    uint64_t frameValue = 0;
+                };
+
+                static uint32_t packColor(const gfx::Color& color);
+                static VkVertexInputBindingDescription bindingDesc();
+                static std::vector<VkVertexInputAttributeDescription> attributeDescs();
+
+                void push(const Instance& instance, int32_t layer, TextureID texture);
+                void reserve(FrameBuffer& frame, size_t count);
+                void createPipeline();
+
+                gfx::Graphics& gfx;
+
+                gfx::DescriptorPool descriptorPool;
+                gfx::DescriptorSetLayout descriptorLayout;
+                VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+                gfx::Pipeline pipeline;
+
+                gfx::Image whiteImage;
+                gfx::Sampler whiteSampler;
+                // Removed textures are only reused once the frames that sampled them completed
+                struct RetiredTexture{
+                    TextureID id;
+                    uint64_t frameValue;
+                };
+                std::vector<VkDescriptorSet> textures;
+                std::vector<bool> textureAlive;
+                std::vector<RetiredTexture> retiredTextures;
+
+                glm::mat4 projection = glm::mat4(1.0f);
+                glm::mat4 view = glm::mat4(1.0f);
+                bool pixelCamera = true;
+
+                std::vector<Instance> instances;
+                std::vector<SortEntry> entries;
+                std::vector<FrameBuffer> frames; // one per frame in flight
+
+                uint32_t _drawCallCount = 0;
+                uint32_t _instanceCount = 0;
+        };
+    } // namespace r2d
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,59 @@
+// Shared by the gpu:: kernels, included before any declarations. Kernels built with
+// USE_SUBGROUPS are only loaded when the device supports subgroup arithmetic.
+#ifdef USE_SUBGROUPS
+#extension GL_KHR_shader_subgroup_basic : require
+#extension GL_KHR_shader_subgroup_arithmetic : require
+#endif
+
+layout (local_size_x_id = 0) in;
+
+// Dispatches wider than maxComputeWorkGroupCount[0] are laid out in 2D
+uint groupIndex(){
+    return gl_WorkGroupID.x + gl_WorkGroupID.y * gl_NumWorkGroups.x;
+}
+
+shared uint scratch[gl_WorkGroupSize.x];
+shared uint scratchTotal;
+
+// Exclusive prefix sum over the workgroup, every invocation must call it
+uint workgroupExclusiveAdd(uint value, out uint total){
+#ifdef USE_SUBGROUPS
+    uint prefix = subgroupExclusiveAdd(value);
+    uint subgroupTotal = subgroupAdd(value);
+    if(subgroupElect()) scratch[gl_SubgroupID] = subgroupTotal;
+    barrier();
+
+    // There are few enough subgroups for a serial scan
+    if(gl_LocalInvocationIndex == 0){
+        uint sum = 0;
+        for(uint i = 0; i < gl_NumSubgroups; i++){
+            uint subgroupSum = scratch[i];
+            scratch[i] = sum;
+            sum += subgroupSum;
+        }
+        scratchTotal = sum;
+    }
+    barrier();
+
+    uint result = prefix + scratch[gl_SubgroupID];
+    total = scratchTotal;
+    barrier();
+    return result;
+#else
+    uint index = gl_LocalInvocationIndex;
+    scratch[index] = value;
+    barrier();
+
+    for(uint offset = 1; offset < gl_WorkGroupSize.x; offset <<= 1){
+        uint add = index >= offset ? scratch[index - offset] : 0;
+        barrier();
+        scratch[index] += add;
+        barrier();
+    }
+
+    uint inclusive = scratch[index];
+    total = scratch[gl_WorkGroupSize.x - 1];
+    barrier();
+    return inclusive - value;
+#endif
+}
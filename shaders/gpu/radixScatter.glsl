@@ -0,0 +1,76 @@
+#include "common.glsl"
+
+// Stable scatter of one 4 bit digit. Each block is sorted locally by four 1 bit
+// splits, after which every element's destination is its digit's scanned base
+// plus its rank within the digit.
+layout (std430, set = 0, binding = 0) readonly buffer KeysIn{
+    uint values[];
+} keysIn;
+layout (std430, set = 0, binding = 1) readonly buffer ValuesIn{
+    uint values[];
+} valuesIn;
+layout (std430, set = 0, binding = 2) readonly buffer Histograms{
+    uint values[];
+} histograms;
+layout (std430, set = 0, binding = 3) writeonly buffer KeysOut{
+    uint values[];
+} keysOut;
+layout (std430, set = 0, binding = 4) writeonly buffer ValuesOut{
+    uint values[];
+} valuesOut;
+
+layout (push_constant) uniform Params{
+    uint count;
+    uint groupCount;
+    uint shift;
+} params;
+
+const uint RADIX = 16;
+const uint RADIX_BITS = 4;
+
+shared uint localKeys[gl_WorkGroupSize.x];
+shared uint localValues[gl_WorkGroupSize.x];
+shared uint digitStart[RADIX];
+
+void main(){
+    uint group = groupIndex();
+    if(group >= params.groupCount) return;
+
+    uint local = gl_LocalInvocationIndex;
+    uint blockStart = group * gl_WorkGroupSize.x;
+    uint validCount = min(gl_WorkGroupSize.x, params.count - blockStart);
+
+    // Out of range elements sort after every valid one and are never written
+    uint key = 0xFFFFFFFFu;
+    uint value = 0;
+    if(local < validCount){
+        key = keysIn.values[blockStart + local];
+        value = valuesIn.values[blockStart + local];
+    }
+
+    for(uint bit = 0; bit < RADIX_BITS; bit++){
+        uint isZero = 1 - ((key >> (params.shift + bit)) & 1);
+        uint zeroCount;
+        uint zerosBefore = workgroupExclusiveAdd(isZero, zeroCount);
+        uint destination = isZero == 1 ? zerosBefore : zeroCount + (local - zerosBefore);
+
+        localKeys[destination] = key;
+        localValues[destination] = value;
+        barrier();
+        key = localKeys[local];
+        value = localValues[local];
+        barrier();
+    }
+
+    uint digit = (key >> params.shift) & (RADIX - 1);
+    localKeys[local] = digit;
+    barrier();
+    if(local < validCount && (local == 0 || localKeys[local - 1] != digit)) digitStart[digit] = local;
+    barrier();
+
+    if(local < validCount){
+        uint destination = histograms.values[digit * params.groupCount + group] + (local - digitStart[digit]);
+        keysOut.values[destination] = key;
+        valuesOut.values[destination] = value;
+    }
+}
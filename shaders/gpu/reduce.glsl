@@ -0,0 +1,66 @@
+#include "common.glsl"
+
+// Reduces one block per workgroup to a single value, repeated until one value is left
+layout (std430, set = 0, binding = 0) readonly buffer Input{
+    uint values[];
+} src;
+layout (std430, set = 0, binding = 1) writeonly buffer Output{
+    uint values[];
+} dst;
+
+layout (push_constant) uniform Params{
+    uint count;
+    uint groupCount;
+} params;
+
+// gpu::ReduceOp, 0 add, 1 min, 2 max
+layout (constant_id = 1) const uint OP = 0;
+
+const uint ITEMS_PER_THREAD = 4;
+
+uint identity(){
+    return OP == 1 ? 0xFFFFFFFFu : 0u;
+}
+uint combine(uint a, uint b){
+    if(OP == 1) return min(a, b);
+    if(OP == 2) return max(a, b);
+    return a + b;
+}
+
+void main(){
+    uint group = groupIndex();
+    if(group >= params.groupCount) return;
+
+    // Strided so neighbouring invocations read neighbouring values
+    uint blockStart = group * gl_WorkGroupSize.x * ITEMS_PER_THREAD;
+    uint value = identity();
+    for(uint i = 0; i < ITEMS_PER_THREAD; i++){
+        uint index = blockStart + i * gl_WorkGroupSize.x + gl_LocalInvocationIndex;
+        if(index < params.count) value = combine(value, src.values[index]);
+    }
+
+#ifdef USE_SUBGROUPS
+    if(OP == 1)      value = subgroupMin(value);
+    else if(OP == 2) value = subgroupMax(value);
+    else             value = subgroupAdd(value);
+
+    if(subgroupElect()) scratch[gl_SubgroupID] = value;
+    barrier();
+    if(gl_LocalInvocationIndex == 0){
+        uint result = identity();
+        for(uint i = 0; i < gl_NumSubgroups; i++) result = combine(result, scratch[i]);
+        dst.values[group] = result;
+    }
+#else
+    uint index = gl_LocalInvocationIndex;
+    scratch[index] = value;
+    barrier();
+    for(uint stride = 1; stride < gl_WorkGroupSize.x; stride <<= 1){
+        if(index % (stride * 2) == 0 && index + stride < gl_WorkGroupSize.x){
+            scratch[index] = combine(scratch[index], scratch[index + stride]);
+        }
+        barrier();
+    }
+    if(index == 0) dst.values[group] = scratch[0];
+#endif
+}
@@ -0,0 +1,42 @@
+#include "common.glsl"
+
+// Exclusive scan of one block per workgroup, the block totals are scanned by the next
+// level and added back by scanAdd.comp
+layout (std430, set = 0, binding = 0) readonly buffer Input{
+    uint values[];
+} src;
+layout (std430, set = 0, binding = 1) writeonly buffer Output{
+    uint values[];
+} dst;
+layout (std430, set = 0, binding = 2) writeonly buffer BlockSums{
+    uint values[];
+} blockSums;
+
+layout (push_constant) uniform Params{
+    uint count;
+    uint groupCount;
+} params;
+
+const uint ITEMS_PER_THREAD = 4;
+
+void main(){
+    // Uniform across the workgroup, so returning keeps barriers valid
+    uint group = groupIndex();
+    if(group >= params.groupCount) return;
+
+    uint base = (group * gl_WorkGroupSize.x + gl_LocalInvocationIndex) * ITEMS_PER_THREAD;
+    uint items[ITEMS_PER_THREAD];
+    uint sum = 0;
+    for(uint i = 0; i < ITEMS_PER_THREAD; i++){
+        items[i] = base + i < params.count ? src.values[base + i] : 0;
+        sum += items[i];
+    }
+
+    uint total;
+    uint prefix = workgroupExclusiveAdd(sum, total);
+    for(uint i = 0; i < ITEMS_PER_THREAD; i++){
+        if(base + i < params.count) dst.values[base + i] = prefix;
+        prefix += items[i];
+    }
+    if(gl_LocalInvocationIndex == 0) blockSums.values[group] = total;
+}
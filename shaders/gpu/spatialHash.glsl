@@ -0,0 +1,26 @@
+// Cell hashing shared by the gpu::SpatialHash kernels and the shaders querying it,
+// SpatialHash::bucket mirrors it on the CPU. Cells are 1 / inverseCellSize wide and
+// the table size is a power of two.
+ivec2 spatialHashCell(vec2 position, float inverseCellSize){
+    return ivec2(floor(position * inverseCellSize));
+}
+uint spatialHashBucket(ivec2 cell, uint tableSize){
+    return ((uint(cell.x) * 73856093u) ^ (uint(cell.y) * 19349663u)) & (tableSize - 1);
+}
+
+// The distinct buckets of the 3x3 cells around position, which cover every point
+// within one cell size of it. Neighbouring cells can share a bucket, so each bucket
+// is returned once.
+uint spatialHashNeighbours(vec2 position, float inverseCellSize, uint tableSize, out uint buckets[9]){
+    ivec2 cell = spatialHashCell(position, inverseCellSize);
+    uint count = 0;
+    for(int y = -1; y <= 1; y++){
+        for(int x = -1; x <= 1; x++){
+            uint bucket = spatialHashBucket(cell + ivec2(x, y), tableSize);
+            bool seen = false;
+            for(uint i = 0; i < count; i++) seen = seen || buckets[i] == bucket;
+            if(!seen) buckets[count++] = bucket;
+        }
+    }
+    return count;
+}
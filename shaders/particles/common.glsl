@@ -0,0 +1,76 @@
+// Shared by the ParticleSystem kernels, included before any declarations. Every
+// kernel uses the same set and push constants, see src/gfx/particleSystem.cpp.
+
+layout (local_size_x_id = 0) in;
+// Sorted systems write a depth key for every surviving particle
+layout (constant_id = 1) const bool SORTED = false;
+layout (constant_id = 2) const uint VERTICES_PER_PARTICLE = 6;
+
+struct Particle{
+    vec4 positionLifetime;  // xyz, total lifetime
+    vec4 velocityLife;      // xyz, seconds left
+};
+struct Instance{
+    vec4 positionSize;
+    vec4 color;
+};
+
+layout (std430, set = 0, binding = 0) buffer Particles{
+    Particle values[];
+} particles;
+// Free particle slots, a stack
+layout (std430, set = 0, binding = 1) buffer DeadList{
+    uint values[];
+} deadList;
+// Slots simulated this update, emitted particles are appended
+layout (std430, set = 0, binding = 2) buffer AliveList{
+    uint values[];
+} alive;
+// Slots that survived this update, the next update's alive list
+layout (std430, set = 0, binding = 3) buffer NextAliveList{
+    uint values[];
+} nextAlive;
+// Matches ParticleSystem::Counters, the indirect arguments are read from here
+layout (std430, set = 0, binding = 4) buffer Counters{
+    uint aliveCount;
+    uint deadCount;
+    uint emitCount;
+    uint nextAliveCount;
+    uint emitGroups[3];
+    uint simulateGroups[3];
+    uint compactGroups[3];
+    uint drawVertexCount;
+    uint drawInstanceCount;
+    uint drawFirstVertex;
+    uint drawFirstInstance;
+    float emitRemainder;
+} counters;
+// Back to front keys of nextAlive, only written when SORTED
+layout (std430, set = 0, binding = 5) writeonly buffer SortKeys{
+    uint values[];
+} sortKeys;
+layout (std430, set = 0, binding = 6) writeonly buffer Instances{
+    Instance values[];
+} instances;
+
+// Matches ParticleSystem::Params
+layout (push_constant) uniform Params{
+    vec4  position;      // xyz, spawn radius
+    vec4  velocity;      // xyz, random spread
+    vec4  acceleration;  // xyz, drag
+    vec4  startColor;
+    vec4  endColor;
+    vec4  camera;        // xyz, distance mapped to the farthest sort key
+    float lifetime;
+    float lifetimeVariation;
+    float startSize;
+    float endSize;
+    float deltaTime;
+    float rate;
+    uint  burst;
+    uint  seed;
+} params;
+
+uint particleIndex(){
+    return gl_WorkGroupID.x * gl_WorkGroupSize.x + gl_LocalInvocationIndex;
+}
@@ -0,0 +1,22 @@
+#version 450
+
+layout (location = 0) in vec2 inUv;
+layout (location = 1) in vec2 inLocal;
+layout (location = 2) in vec4 inColor;
+layout (location = 3) flat in vec4  inBorderColor;
+layout (location = 4) flat in vec2  inSize;
+layout (location = 5) flat in float inBorderSize;
+
+layout (location = 0) out vec4 fragColor;
+
+layout (set = 0, binding = 0) uniform sampler2D tex;
+
+void main(){
+    vec4 color = inColor;
+    if(inBorderSize > 0.0){
+        if(any(lessThan(inLocal, vec2(inBorderSize))) ||
+           any(greaterThan(inLocal, inSize - inBorderSize)))
+            color = inBorderColor;
+    }
+    fragColor = texture(tex, inUv) * color;
+}
@@ -0,0 +1,43 @@
+#version 450
+
+// Per instance, see shard::r2d::Renderer::Instance
+layout (location = 0) in vec2  inPosition;
+layout (location = 1) in vec2  inSize;
+layout (location = 2) in vec4  inUvRect;
+layout (location = 3) in vec4  inColor;
+layout (location = 4) in vec4  inBorderColor;
+layout (location = 5) in float inRotation;
+layout (location = 6) in float inBorderSize;
+
+layout (location = 0) out vec2 outUv;
+layout (location = 1) out vec2 outLocal;
+layout (location = 2) out vec4 outColor;
+layout (location = 3) flat out vec4  outBorderColor;
+layout (location = 4) flat out vec2  outSize;
+layout (location = 5) flat out float outBorderSize;
+
+layout (push_constant) uniform Camera {
+    mat4 viewProjection;
+} camera;
+
+const vec2 CORNERS[6] = vec2[](
+    vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(0.0, 1.0),
+    vec2(0.0, 1.0), vec2(1.0, 0.0), vec2(1.0, 1.0)
+);
+
+void main(){
+    vec2 corner = CORNERS[gl_VertexIndex];
+    vec2 local  = (corner - 0.5) * inSize;
+
+    float s = sin(inRotation);
+    float c = cos(inRotation);
+    vec2 world = inPosition + vec2(c*local.x - s*local.y, s*local.x + c*local.y);
+
+    gl_Position    = camera.viewProjection * vec4(world, 0.0, 1.0);
+    outUv          = mix(inUvRect.xy, inUvRect.zw, corner);
+    outLocal       = corner * inSize;
+    outColor       = inColor;
+    outBorderColor = inBorderColor;
+    outSize        = inSize;
+    outBorderSize  = inBorderSize;
+}
@@ -0,0 +1,472 @@
+#include <shard/gfx/assetLoader.hpp>
+
+#include <fstream>
+#include <cstring>
+
+namespace shard{
+    namespace gfx{
+        // Satisfies the copy offset alignment of every supported format
+        static constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+        static VkDeviceSize alignStaging(VkDeviceSize offset){
+            return (offset + STAGING_ALIGNMENT - 1) & ~(STAGING_ALIGNMENT - 1);
+        }
+
+        size_t AssetLoader::Decoded::stagingSize() const {
+            if(failed) return 0;
+            if(kind == AssetKind::MODEL){
+                return alignStaging(vertexCount() * sizeof(Vertex3D)) +
+                       alignStaging(indexCount()  * indexTypeSize(indexType()));
+            }
+            if(isKtx2){
+                size_t size = 0;
+                for(const auto& level : ktx2.levels) size += alignStaging(level.byteLength);
+                return size;
+            }
+            return alignStaging(size_t(width) * size_t(height) * 4);
+        }
+
+        AssetLoader::AssetLoader(Graphics& _gfx, uint32_t workerCount, size_t _stagingBudget):
+            gfx{_gfx},
+            stagingBudget{_stagingBudget},
+            pool{workerCount}
+        {
+            createPlaceholders();
+
+            Device& device = gfx.device();
+            VkCommandPoolCreateInfo poolInfo = {};
+            poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            poolInfo.queueFamilyIndex = device.getQueueFamilyIndices().graphics.value();
+            poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT |
+                             VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+            shard_abort_ifnot(
+                vkCreateCommandPool(device.device(), &poolInfo, nullptr, &commandPool) == VK_SUCCESS
+            );
+
+            VkCommandBufferAllocateInfo allocInfo = {};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocInfo.commandPool = commandPool;
+            allocInfo.commandBufferCount = 1;
+            shard_abort_ifnot(
+                vkAllocateCommandBuffers(device.device(), &allocInfo, &commandBuffer) == VK_SUCCESS
+            );
+
+            VkFenceCreateInfo fenceInfo = {};
+            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+            shard_abort_ifnot(
+                vkCreateFence(device.device(), &fenceInfo, nullptr, &uploadFence) == VK_SUCCESS
+            );
+
+            uploadThread = std::thread(&AssetLoader::uploadLoop, this);
+        }
+        AssetLoader::~AssetLoader(){
+            // Queued decodes bail out early, the batch being uploaded is finished.
+            // Set under the lock so the upload thread cannot miss it between checking
+            // its predicate and waiting.
+            {
+                std::lock_guard<std::mutex> lock(uploadMutex);
+                stopping = true;
+            }
+            pool.wait();
+            uploadCondition.notify_all();
+            uploadThread.join();
+
+            VkDevice device = gfx.device().device();
+            vkDestroyFence(device, uploadFence, nullptr);
+            vkDestroyCommandPool(device, commandPool, nullptr);
+        }
+
+        TextureHandle AssetLoader::loadTexture(const char* filePath){
+            uint32_t index = static_cast<uint32_t>(textures.size());
+            textures.emplace_back();
+            _pendingCount++;
+
+            std::string path = filePath;
+            pool.submit([this, index, path](){
+                decode(AssetKind::TEXTURE, index, path);
+            });
+            return TextureHandle{index};
+        }
+        ModelHandle AssetLoader::loadModel(const char* filePath){
+            uint32_t index = static_cast<uint32_t>(models.size());
+            models.emplace_back();
+            _pendingCount++;
+
+            std::string path = filePath;
+            pool.submit([this, index, path](){
+                decode(AssetKind::MODEL, index, path);
+            });
+            return ModelHandle{index};
+        }
+
+        uint32_t AssetLoader::update(){
+            std::vector<Uploaded> completed;
+            {
+                std::lock_guard<std::mutex> lock(completedMutex);
+                completed.swap(completedQueue);
+            }
+
+            for(auto& uploaded : completed){
+                if(uploaded.kind == AssetKind::TEXTURE){
+                    TextureSlot& slot = textures[uploaded.index];
+                    slot.status = uploaded.image ? AssetStatus::READY : AssetStatus::FAILED;
+                    slot.image = std::move(uploaded.image);
+                } else{
+                    ModelSlot& slot = models[uploaded.index];
+                    slot.status = uploaded.model ? AssetStatus::READY : AssetStatus::FAILED;
+                    slot.model = std::move(uploaded.model);
+                }
+            }
+            _pendingCount -= static_cast<uint32_t>(completed.size());
+            return static_cast<uint32_t>(completed.size());
+        }
+        void AssetLoader::waitIdle(){
+            {
+                std::unique_lock<std::mutex> lock(completedMutex);
+                completedCondition.wait(lock, [this](){
+                    return completedQueue.size() >= _pendingCount;
+                });
+            }
+            update();
+        }
+
+        AssetStatus AssetLoader::status(TextureHandle handle) const {
+            assert(handle.index < textures.size());
+            return textures[handle.index].status;
+        }
+        AssetStatus AssetLoader::status(ModelHandle handle) const {
+            assert(handle.index < models.size());
+            return models[handle.index].status;
+        }
+        Image& AssetLoader::texture(TextureHandle handle){
+            assert(handle.index < textures.size());
+            TextureSlot& slot = textures[handle.index];
+            return slot.image ? *slot.image : *_placeholderTexture;
+        }
+        Model& AssetLoader::model(ModelHandle handle){
+            assert(handle.index < models.size());
+            ModelSlot& slot = models[handle.index];
+            return slot.model ? *slot.model : *_placeholderModel;
+        }
+
+        void AssetLoader::decode(AssetKind kind, uint32_t index, const std::string& filePath){
+            Decoded decoded = {};
+            decoded.kind = kind;
+            decoded.index = index;
+            if(stopping) return;
+
+            // Both decoders abort or assert on missing files
+            decoded.failed = !std::ifstream(filePath).good();
+            if(!decoded.failed && kind == AssetKind::TEXTURE){
+                if(ktx2::isKtx2File(filePath.c_str())){
+                    decoded.isKtx2 = true;
+                    decoded.failed = !ktx2::load(filePath.c_str(), decoded.ktx2);
+                } else{
+                    int w, h, channels;
+                    decoded.pixels.reset(stbi_load(filePath.c_str(), &w, &h, &channels, STBI_rgb_alpha));
+                    decoded.failed = decoded.pixels == nullptr;
+                    decoded.width = uint32_t(w);
+                    decoded.height = uint32_t(h);
+                }
+            } else if(!decoded.failed){
+                decoded.mesh = MeshFile::loadObj(filePath.c_str());
+                if(!decoded.mesh.valid()){
+                    ModelLoader loader(filePath.c_str());
+                    decoded.vertices = std::move(loader.vertices);
+                    decoded.indices = std::move(loader.indices);
+                }
+                decoded.failed = decoded.vertexCount() == 0;
+            }
+
+            if(decoded.failed){
+                std::cerr << SHARD_FUNC << ": Failed to load " << filePath << "\n";
+                publish(Uploaded{kind, index, nullptr, nullptr});
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(uploadMutex);
+                decodedQueue.push_back(std::move(decoded));
+            }
+            uploadCondition.notify_one();
+        }
+
+        void AssetLoader::uploadLoop(){
+            while(true){
+                std::vector<Decoded> batch;
+                {
+                    std::unique_lock<std::mutex> lock(uploadMutex);
+                    uploadCondition.wait(lock, [this](){
+                        return stopping || !decodedQueue.empty();
+                    });
+                    if(stopping) return;
+
+                    // Anything larger than the budget is uploaded on its own
+                    size_t batchSize = 0;
+                    while(!decodedQueue.empty()){
+                        size_t size = decodedQueue.front().stagingSize();
+                        if(!batch.empty() && batchSize + size > stagingBudget) break;
+                        batchSize += size;
+                        batch.push_back(std::move(decodedQueue.front()));
+                        decodedQueue.pop_front();
+                    }
+                }
+                upload(batch);
+            }
+        }
+
+        void AssetLoader::upload(std::vector<Decoded>& batch){
+            Device& device = gfx.device();
+
+            size_t stagingSize = 0;
+            for(const auto& decoded : batch) stagingSize += decoded.stagingSize();
+            Buffer stagingBuffer = Buffer(
+                device, stagingSize,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VMA_MEMORY_USAGE_CPU_ONLY,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT  |
+                VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                VK_SHARING_MODE_EXCLUSIVE
+            );
+            uint8_t* staging = static_cast<uint8_t*>(stagingBuffer.mappedMemory());
+            VkDeviceSize offset = 0;
+
+            // Resources are created here, only the copies and barriers go through the queue
+            std::vector<Uploaded> uploaded;
+            uploaded.reserve(batch.size());
+            std::vector<VkImageMemoryBarrier> toTransferDst;
+            for(auto& decoded : batch){
+                if(decoded.kind != AssetKind::TEXTURE) continue;
+
+                uint32_t width  = decoded.isKtx2 ? decoded.ktx2.width  : decoded.width;
+                uint32_t height = decoded.isKtx2 ? decoded.ktx2.height : decoded.height;
+                VkFormat format = decoded.isKtx2 ? decoded.ktx2.format : VK_FORMAT_R8G8B8A8_SRGB;
+                uint32_t mipLevels = decoded.isKtx2 ?
+                    static_cast<uint32_t>(decoded.ktx2.levels.size()) :
+                    calculateMipmapLevels(width, height);
+
+                auto image = std::make_unique<Image>(
+                    device,
+                    width, height, mipLevels,
+                    decoded.isKtx2 ? getFormatBlockInfo(format).blockSize : 4,
+                    format, VK_IMAGE_TILING_OPTIMAL,
+                    VK_SAMPLE_COUNT_1_BIT,
+                    VK_IMAGE_USAGE_TRANSFER_SRC_BIT |
+                    VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                    VK_IMAGE_USAGE_SAMPLED_BIT,
+                    0,
+                    VMA_MEMORY_USAGE_GPU_ONLY,
+                    VK_IMAGE_ASPECT_COLOR_BIT,
+                    VK_SHARING_MODE_EXCLUSIVE
+                );
+
+                VkImageMemoryBarrier barrier = {};
+                barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+                barrier.srcAccessMask = 0;
+                barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+                barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                barrier.image = image->image();
+                barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, 0, 1};
+                toTransferDst.push_back(barrier);
+
+                uploaded.push_back(Uploaded{decoded.kind, decoded.index, std::move(image), nullptr});
+            }
+
+            VkCommandBufferBeginInfo beginInfo = {};
+            beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+            beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+            if(!toTransferDst.empty()){
+                vkCmdPipelineBarrier(commandBuffer,
+                    VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                    0, nullptr,
+                    0, nullptr,
+                    static_cast<uint32_t>(toTransferDst.size()), toTransferDst.data()
+                );
+            }
+
+            std::vector<VkImageMemoryBarrier> toShaderRead;
+            size_t textureIndex = 0;
+            for(auto& decoded : batch){
+                if(decoded.kind == AssetKind::TEXTURE){
+                    Image& image = *uploaded[textureIndex++].image;
+
+                    if(decoded.isKtx2){
+                        const ktx2::Texture& texture = decoded.ktx2;
+                        std::vector<VkBufferImageCopy> regions(texture.levels.size());
+                        for(uint32_t i = 0; i < regions.size(); i++){
+                            const auto& level = texture.levels[i];
+                            memcpy(staging + offset, texture.data.data() + level.byteOffset, level.byteLength);
+
+                            VkBufferImageCopy& region = regions[i];
+                            region = {};
+                            region.bufferOffset = offset;
+                            region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, i, 0, 1};
+                            region.imageExtent = {
+                                std::max(texture.width  >> i, 1u),
+                                std::max(texture.height >> i, 1u),
+                                1
+                            };
+                            offset += alignStaging(level.byteLength);
+                        }
+                        vkCmdCopyBufferToImage(
+                            commandBuffer, stagingBuffer.buffer(), image.image(),
+                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                            static_cast<uint32_t>(regions.size()), regions.data()
+                        );
+
+                        VkImageMemoryBarrier barrier = toTransferDst[textureIndex - 1];
+                        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+                        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                        toShaderRead.push_back(barrier);
+                        image.setLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+                    } else{
+                        size_t size = size_t(decoded.width) * size_t(decoded.height) * 4;
+                        memcpy(staging + offset, decoded.pixels.get(), size);
+
+                        VkBufferImageCopy region = {};
+                        region.bufferOffset = offset;
+                        region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+                        region.imageExtent = {decoded.width, decoded.height, 1};
+                        vkCmdCopyBufferToImage(
+                            commandBuffer, stagingBuffer.buffer(), image.image(),
+                            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                            1, &region
+                        );
+                        offset += alignStaging(size);
+
+                        image.setLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+                        image.recordMipMaps(commandBuffer);
+                    }
+                    continue;
+                }
+
+                size_t vertexSize = decoded.vertexCount() * sizeof(Vertex3D);
+                VkIndexType indexType = decoded.indexType();
+                size_t indexSize  = decoded.indexCount()  * indexTypeSize(indexType);
+                Buffer vertexBuffer = Buffer(
+                    device, vertexSize,
+                    VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                    VMA_MEMORY_USAGE_GPU_ONLY,
+                    0, VK_SHARING_MODE_EXCLUSIVE
+                );
+                Buffer indexBuffer = Buffer(
+                    device, indexSize,
+                    VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                    VMA_MEMORY_USAGE_GPU_ONLY,
+                    0, VK_SHARING_MODE_EXCLUSIVE
+                );
+
+                memcpy(staging + offset, decoded.vertexData(), vertexSize);
+                VkBufferCopy copy = {offset, 0, vertexSize};
+                vkCmdCopyBuffer(commandBuffer, stagingBuffer.buffer(), vertexBuffer.buffer(), 1, &copy);
+                offset += alignStaging(vertexSize);
+
+                if(indexSize > 0){
+                    packIndices(staging + offset, decoded.indexData(), decoded.indexCount(), indexType);
+                    copy = {offset, 0, indexSize};
+                    vkCmdCopyBuffer(commandBuffer, stagingBuffer.buffer(), indexBuffer.buffer(), 1, &copy);
+                    offset += alignStaging(indexSize);
+                }
+
+                uploaded.push_back(Uploaded{
+                    decoded.kind, decoded.index, nullptr,
+                    std::make_unique<Model>(
+                        gfx,
+                        std::move(vertexBuffer), decoded.vertexCount(),
+                        std::move(indexBuffer),  decoded.indexCount(),
+                        indexType
+                    )
+                });
+            }
+
+            VkMemoryBarrier bufferBarrier = {};
+            bufferBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            bufferBarrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+            vkCmdPipelineBarrier(commandBuffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                1, &bufferBarrier,
+                0, nullptr,
+                static_cast<uint32_t>(toShaderRead.size()), toShaderRead.data()
+            );
+
+            vkEndCommandBuffer(commandBuffer);
+
+            VkSubmitInfo submitInfo = {};
+            submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &commandBuffer;
+            shard_abort_ifnot(
+                device.queueSubmit(device.graphicsQueue(), 1, &submitInfo, uploadFence) == VK_SUCCESS
+            );
+            vkWaitForFences(device.device(), 1, &uploadFence, VK_TRUE, UINT64_MAX);
+            vkResetFences(device.device(), 1, &uploadFence);
+            stagingBuffer.destroyNow();
+
+            for(auto& asset : uploaded) publish(std::move(asset));
+        }
+
+        void AssetLoader::publish(Uploaded&& uploaded){
+            {
+                std::lock_guard<std::mutex> lock(completedMutex);
+                completedQueue.push_back(std::move(uploaded));
+            }
+            completedCondition.notify_all();
+        }
+
+        void AssetLoader::createPlaceholders(){
+            // 2x2 magenta and black checker
+            const uint8_t pixels[] = {
+                255, 0, 255, 255,   0, 0, 0, 255,
+                  0, 0, 0,   255, 255, 0, 255, 255,
+            };
+            _placeholderTexture = std::make_unique<Image>(gfx.device(), 2, 2, pixels);
+
+            // Unit cube with flat normals
+            std::vector<Vertex3D> vertices;
+            std::vector<uint32_t> indices;
+            for(uint32_t axis = 0; axis < 3; axis++){
+                for(float side : {-1.0f, 1.0f}){
+                    glm::vec3 normal(0.0f);
+                    normal[axis] = side;
+                    glm::vec3 u(0.0f), v(0.0f);
+                    u[(axis + 1) % 3] = 1.0f;
+                    v[(axis + 2) % 3] = side;
+
+                    uint32_t base = static_cast<uint32_t>(vertices.size());
+                    const glm::vec2 corners[] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+                    for(const auto& corner : corners){
+                        glm::vec3 pos = (normal + (corner.x*2.0f - 1.0f)*u + (corner.y*2.0f - 1.0f)*v) * 0.5f;
+                        vertices.emplace_back(pos, corner, normal, Color(255.0f));
+                    }
+                    for(uint32_t i : {0u, 1u, 2u, 2u, 3u, 0u}) indices.push_back(base + i);
+                }
+            }
+            _placeholderModel = std::make_unique<Model>(gfx, vertices, indices);
+        }
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -55,15 +55,12 @@ namespace shard{
             buf._mapped = nullptr;
         }
         Buffer::~Buffer(){
-            unmap();
-            vmaDestroyBuffer(device.allocator(), _buffer, _allocation);
+            destroy();
         }
 
         Buffer& Buffer::operator = (Buffer& buf){
             assert(&device == &buf.device);
-            device.waitIdle();
-            unmap();
-            vmaDestroyBuffer(device.allocator(), _buffer, _allocation);
+            destroy();
             _allocation = buf._allocation;
             _buffer = buf._buffer;
             _size = buf._size;
@@ -76,9 +73,7 @@ namespace shard{
         }
         Buffer& Buffer::operator = (Buffer&& buf){
             assert(&device == &buf.device);
-            device.waitIdle();
-            unmap();
-            vmaDestroyBuffer(device.allocator(), _buffer, _allocation);
+            destroy();
             _allocation = buf._allocation;
             _buffer = buf._buffer;
             _size = buf._size;
@@ -90,6 +85,29 @@ namespace shard{
             return *this;
         }
 
+        void Buffer::destroy(){
+            unmap();
+            if(_buffer == VK_NULL_HANDLE && _allocation == VK_NULL_HANDLE) return;
+
+            VmaAllocator allocator = device.allocator();
+            VkBuffer buffer = _buffer;
+            VmaAllocation allocation = _allocation;
+            device.deferDestroy([allocator, buffer, allocation](){
+                vmaDestroyBuffer(allocator, buffer, allocation);
+            });
+            _buffer = VK_NULL_HANDLE;
+            _allocation = VK_NULL_HANDLE;
+        }
+
+        void Buffer::destroyNow(){
+            unmap();
+            if(_buffer == VK_NULL_HANDLE && _allocation == VK_NULL_HANDLE) return;
+
+            vmaDestroyBuffer(device.allocator(), _buffer, _allocation);
+            _buffer = VK_NULL_HANDLE;
+            _allocation = VK_NULL_HANDLE;
+        }
+
         VkResult Buffer::flush(VkDeviceSize size, VkDeviceSize offset){
             return vmaFlushAllocation(device.allocator(), _allocation, offset, size);
         }
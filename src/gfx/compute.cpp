@@ -1,5 +1,7 @@
 #include <shard/gfx/compute.hpp>
 
+#include <algorithm>
+
 namespace shard{
     namespace gfx
     {
@@ -7,25 +9,34 @@ namespace shard{
             device{_device},
             _pipeline{VK_NULL_HANDLE}
         {}
-        Compute::Compute(Device& _device, VkPipelineLayout layout, const char* filePath):
+        Compute::Compute(
+            Device& _device, VkPipelineLayout layout, const char* filePath,
+            const SpecializationConstants& constants
+        ):
             device{_device}
         {
             assert(layout != VK_NULL_HANDLE);
             ShaderModule sm = ShaderModule(device, filePath);
-            init(layout, sm);
+            init(layout, sm, constants);
         }
-        Compute::Compute(Device& _device, VkPipelineLayout layout, const std::vector<char>& shaderSPV):
+        Compute::Compute(
+            Device& _device, VkPipelineLayout layout, const std::vector<char>& shaderSPV,
+            const SpecializationConstants& constants
+        ):
             device{_device}
         {
             assert(layout != VK_NULL_HANDLE);
             ShaderModule sm = ShaderModule(device, shaderSPV);
-            init(layout, sm);
+            init(layout, sm, constants);
         }
-        Compute::Compute(Device& _device, VkPipelineLayout layout, ShaderModule& shader):
+        Compute::Compute(
+            Device& _device, VkPipelineLayout layout, ShaderModule& shader,
+            const SpecializationConstants& constants
+        ):
             device{_device}
         {
             assert(layout != VK_NULL_HANDLE);
-            init(layout, shader);
+            init(layout, shader, constants);
         }
         Compute::Compute(Compute&  c):
             device{c.device},
@@ -40,33 +51,55 @@ namespace shard{
             c._pipeline = VK_NULL_HANDLE;
         }
         Compute::~Compute(){
-            vkDestroyPipeline(device.device(), _pipeline, nullptr);
+            destroy();
         }
 
         Compute& Compute::operator = (Compute&  c){
             assert(&device == &c.device);
-            vkDestroyPipeline(device.device(), _pipeline, nullptr);
+            destroy();
             _pipeline = c._pipeline;
             c._pipeline = VK_NULL_HANDLE;
             return *this;
         }
         Compute& Compute::operator = (Compute&& c){
             assert(&device == &c.device);
-            vkDestroyPipeline(device.device(), _pipeline, nullptr);
+            destroy();
             _pipeline = c._pipeline;
             c._pipeline = VK_NULL_HANDLE;
             return *this;
         }
 
+        void Compute::destroy(){
+            if(_pipeline == VK_NULL_HANDLE) return;
+
+            VkDevice vkDevice = device.device();
+            VkPipeline pipeline = _pipeline;
+            device.deferDestroy([vkDevice, pipeline](){
+                vkDestroyPipeline(vkDevice, pipeline, nullptr);
+            });
+            _pipeline = VK_NULL_HANDLE;
+        }
+
+        uint32_t Compute::clampWorkgroupSize(Device& device, uint32_t preferred){
+            VkPhysicalDeviceLimits limits = device.properties().limits;
+            return std::max(1u, std::min({
+                preferred,
+                limits.maxComputeWorkGroupSize[0],
+                limits.maxComputeWorkGroupInvocations
+            }));
+        }
+
         void Compute::init(
             VkPipelineLayout layout,
-            ShaderModule& shader
+            ShaderModule& shader,
+            const SpecializationConstants& constants
         ){
             VkPipelineShaderStageCreateInfo stageInfo = {};
             stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
             stageInfo.module = shader.shaderModule();
             stageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
             stageInfo.pName = "main";
+            stageInfo.pSpecializationInfo = constants.info();
 
             VkComputePipelineCreateInfo createInfo = {};
             createInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
@@ -83,5 +116,25 @@ namespace shard{
                 ) == VK_SUCCESS
             );
         }
+
+        ComputePermutations::ComputePermutations(
+            Device& _device, VkPipelineLayout _layout, const char* filePath
+        ):
+            device{_device},
+            layout{_layout},
+            _shader{_device, filePath}
+        {
+            assert(layout != VK_NULL_HANDLE);
+        }
+        Compute& ComputePermutations::get(const SpecializationConstants& constants){
+            auto key = constants.key();
+            auto it = permutations.find(key);
+            if(it == permutations.end()){
+                it = permutations.emplace(
+                    std::move(key), std::make_unique<Compute>(device, layout, _shader, constants)
+                ).first;
+            }
+            return *it->second;
+        }
     } // namespace gfx
 } // namespace shard
@@ -115,19 +115,19 @@ namespace shard{
             dp._pool = VK_NULL_HANDLE;
         }
         DescriptorPool::~DescriptorPool(){
-            vkDestroyDescriptorPool(device.device(), _pool, nullptr);
+            destroy();
         }
 
         DescriptorPool& DescriptorPool::operator = (DescriptorPool& dp){
             assert(&device == &dp.device);
-            vkDestroyDescriptorPool(device.device(), _pool, nullptr);
+            destroy();
             _pool = dp._pool;
             dp._pool = VK_NULL_HANDLE;
             return *this;
         }
         DescriptorPool& DescriptorPool::operator = (DescriptorPool&& dp){
             assert(&device == &dp.device);
-            vkDestroyDescriptorPool(device.device(), _pool, nullptr);
+            destroy();
             _pool = dp._pool;
             dp._pool = VK_NULL_HANDLE;
             return *this;
@@ -170,6 +170,17 @@ namespace shard{
             );
         }
 
+        void DescriptorPool::destroy(){
+            if(_pool == VK_NULL_HANDLE) return;
+
+            // Destroying the pool frees its sets
+            VkDevice vkDevice = device.device();
+            VkDescriptorPool pool = _pool;
+            device.deferDestroy([vkDevice, pool](){
+                vkDestroyDescriptorPool(vkDevice, pool, nullptr);
+            });
+            _pool = VK_NULL_HANDLE;
+        }
         void DescriptorPool::reset(){
             vkResetDescriptorPool(
                 device.device(),
@@ -222,6 +233,28 @@ namespace shard{
             writes.push_back(write);
             return *this;
         }
+        DescriptorWriter& DescriptorWriter::writeImages(
+            uint32_t binding, VkDescriptorImageInfo* imageInfos, uint32_t count
+        ){
+            assert(setLayout.bindings.contains(binding));
+
+            auto& desc = setLayout.bindings[binding];
+
+            assert(
+                desc.descriptorCount == count &&
+                "Descriptor info count does not match the binding"
+            );
+
+            VkWriteDescriptorSet write = {};
+            write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            write.descriptorType = desc.descriptorType;
+            write.dstBinding = binding;
+            write.pImageInfo = imageInfos;
+            write.descriptorCount = count;
+
+            writes.push_back(write);
+            return *this;
+        }
 
         void DescriptorWriter::build(VkDescriptorSet& set){
             pool.allocateDescriptor(setLayout.layout(), set);
@@ -1,14 +1,15 @@
 #include <shard/gfx/device.hpp>
+#include <shard/gfx/layoutCache.hpp>
 
 #include <cstring>
 #include <set>
+#include <algorithm>
 
 namespace shard{
     namespace gfx{
         QueueFamilyIndices::QueueFamilyIndices(){}
         QueueFamilyIndices::QueueFamilyIndices(VkPhysicalDevice device, VkSurfaceKHR surface){
             assert(device != VK_NULL_HANDLE);
-            assert(surface != VK_NULL_HANDLE);
             uint32_t queueFamilyCount = 0;
             vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
 
@@ -29,8 +30,12 @@ namespace shard{
                     compute = i;
                     computeIndex = 1;
                 }
+                // Headless devices never present, the graphics queue stands in
                 VkBool32 presentSupport = false;
-                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+                if(surface != VK_NULL_HANDLE)
+                    vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+                else
+                    presentSupport = graphics.has_value() && graphics.value() == i;
                 if (queueFamily.queueCount > 0 && presentSupport && !present.has_value())
                     present = i;
                 
@@ -87,7 +92,6 @@ namespace shard{
         Device::Device(GLFWwindow* win):
             _window{win}
         {
-            assert(_window != nullptr);
             init();
         }
         Device::~Device(){
@@ -103,6 +107,11 @@ namespace shard{
             createCommandPool();
         }
         void Device::cleanup(){
+            waitIdle();
+            // Queues the cached layouts for destruction
+            _layoutCache.reset();
+            flushDeletionQueue();
+
             vkDestroyCommandPool(_device, _commandPool, nullptr);
             vmaDestroyAllocator(_allocator);
             vkDestroyDevice(_device, nullptr);
@@ -141,6 +150,7 @@ namespace shard{
             );
         }
         void Device::createSurface(){
+            if(headless()) return;
             shard_abort_ifnot(
                 glfwCreateWindowSurface(
                     _instance,
@@ -202,15 +212,77 @@ namespace shard{
             deviceFeatures.samplerAnisotropy = VK_TRUE;
             deviceFeatures.fillModeNonSolid = VK_TRUE;
 
+            std::vector<const char*> enabledExtensions = {};
+            if(!headless()) enabledExtensions = deviceExtensions;
+            void* featureChain = nullptr;
+
+            VkPhysicalDeviceVulkan12Features supported12 = {};
+            supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+            VkPhysicalDeviceFeatures2 supported = {};
+            supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            supported.pNext = &supported12;
+            vkGetPhysicalDeviceFeatures2(_pDevice, &supported);
+
+            VkPhysicalDeviceSubgroupProperties subgroup = {};
+            subgroup.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+            VkPhysicalDeviceProperties2 properties2 = {};
+            properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+            properties2.pNext = &subgroup;
+            vkGetPhysicalDeviceProperties2(_pDevice, &properties2);
+
+            _subgroupSize = subgroup.subgroupSize;
+            _subgroupArithmeticSupported =
+                (subgroup.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) &&
+                (subgroup.supportedOperations & VK_SUBGROUP_FEATURE_BASIC_BIT) &&
+                (subgroup.supportedOperations & VK_SUBGROUP_FEATURE_ARITHMETIC_BIT);
+
+            _multiDrawIndirectSupported = supported.features.multiDrawIndirect;
+            _drawIndirectCountSupported = supported12.drawIndirectCount;
+            deviceFeatures.multiDrawIndirect = supported.features.multiDrawIndirect;
+
+            VkPhysicalDeviceVulkan12Features features12 = {};
+            features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+            features12.drawIndirectCount = supported12.drawIndirectCount;
+            features12.pNext = featureChain;
+            featureChain = &features12;
+
+        #if defined(VK_KHR_present_wait)
+            VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {};
+            presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+            VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {};
+            presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+
+            if(
+                !headless() &&
+                checkOptionalDeviceExtensionSupport(_pDevice, VK_KHR_PRESENT_ID_EXTENSION_NAME) &&
+                checkOptionalDeviceExtensionSupport(_pDevice, VK_KHR_PRESENT_WAIT_EXTENSION_NAME)
+            ){
+                presentIdFeatures.pNext = &presentWaitFeatures;
+                VkPhysicalDeviceFeatures2 features2 = {};
+                features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+                features2.pNext = &presentIdFeatures;
+                vkGetPhysicalDeviceFeatures2(_pDevice, &features2);
+
+                _presentWaitSupported = presentIdFeatures.presentId && presentWaitFeatures.presentWait;
+                if(_presentWaitSupported){
+                    enabledExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+                    enabledExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+                    presentWaitFeatures.pNext = featureChain;
+                    featureChain = &presentIdFeatures;
+                }
+            }
+        #endif
+
             VkDeviceCreateInfo createInfo = {};
             createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+            createInfo.pNext = featureChain;
 
             createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
             createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
             createInfo.pEnabledFeatures = &deviceFeatures;
-            createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-            createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+            createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+            createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
             // This is a deprecated feature, don't care.
             if(shard::IS_DEBUG){
@@ -223,6 +295,15 @@ namespace shard{
             vkGetDeviceQueue(_device, indices.graphics.value(), 0,                    &_graphicsQueue);
             vkGetDeviceQueue(_device, indices.present.value(),  0,                    &_presentQueue);
             vkGetDeviceQueue(_device, indices.compute.value(),  indices.computeIndex, &_computeQueue);
+
+        #if defined(VK_KHR_present_wait)
+            if(_presentWaitSupported){
+                _vkWaitForPresentKHR = reinterpret_cast<PFN_vkWaitForPresentKHR>(
+                    vkGetDeviceProcAddr(_device, "vkWaitForPresentKHR")
+                );
+                _presentWaitSupported = _vkWaitForPresentKHR != nullptr;
+            }
+        #endif
         }
         void Device::createAllocator(){
             VmaAllocatorCreateInfo allocInfo = {};
@@ -249,10 +330,10 @@ namespace shard{
         bool Device::isDeviceSuitable(VkPhysicalDevice device){
             QueueFamilyIndices indices(device, _surface);
 
-            bool extensionsSupported = checkDeviceExtensionSupport(device);
+            bool extensionsSupported = headless() || checkDeviceExtensionSupport(device);
 
-            bool swapChainAdequate = false;
-            if(extensionsSupported){
+            bool swapChainAdequate = headless();
+            if(extensionsSupported && !headless()){
                 SwapchainSupportDetails swapChainSupport(device, _surface);
                 swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
             }
@@ -278,6 +359,8 @@ namespace shard{
             return score;
         }
         std::vector<const char*> Device::getRequiredExtensions(){
+            if(headless()) return {};
+
             uint32_t glfwExtensionCount = 0;
             const char **glfwExtensions;
             glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
@@ -347,6 +430,99 @@ namespace shard{
             return requiredExtensions.empty();
         }
 
+        LayoutCache& Device::layoutCache(){
+            if(!_layoutCache) _layoutCache = std::make_unique<LayoutCache>(*this);
+            return *_layoutCache;
+        }
+
+        VkResult Device::queueSubmit(
+            VkQueue queue, uint32_t submitCount, const VkSubmitInfo* submits, VkFence fence
+        ){
+            std::lock_guard<std::mutex> lock(queueMutex);
+            return vkQueueSubmit(queue, submitCount, submits, fence);
+        }
+        VkResult Device::queuePresent(const VkPresentInfoKHR* presentInfo){
+            std::lock_guard<std::mutex> lock(queueMutex);
+            return vkQueuePresentKHR(_presentQueue, presentInfo);
+        }
+        VkResult Device::queueWaitIdle(VkQueue queue){
+            std::lock_guard<std::mutex> lock(queueMutex);
+            return vkQueueWaitIdle(queue);
+        }
+
+        uint64_t Device::frameValue(){
+            std::lock_guard<std::mutex> lock(deletionMutex);
+            return _frameValue;
+        }
+        uint64_t Device::completedFrameValue(){
+            std::lock_guard<std::mutex> lock(deletionMutex);
+            return _completedFrameValue;
+        }
+        void Device::deferDestroy(std::function<void()>&& destroy){
+            assert(destroy);
+            std::lock_guard<std::mutex> lock(deletionMutex);
+            deletionQueue.push_back({_frameValue, std::move(destroy)});
+        }
+        void Device::advanceFrame(){
+            std::lock_guard<std::mutex> lock(deletionMutex);
+            _frameValue++;
+        }
+        void Device::collectGarbage(uint64_t completedValue){
+            std::vector<std::function<void()>> ready = {};
+            {
+                std::lock_guard<std::mutex> lock(deletionMutex);
+                _completedFrameValue = std::max(_completedFrameValue, completedValue);
+                while(
+                    !deletionQueue.empty() &&
+                    deletionQueue.front().frameValue <= _completedFrameValue
+                ){
+                    ready.push_back(std::move(deletionQueue.front().destroy));
+                    deletionQueue.pop_front();
+                }
+            }
+            // Callbacks may queue more deletions (e.g. a retired swapchain's images),
+            // so they run outside of the lock.
+            for(auto& destroy : ready) destroy();
+        }
+        void Device::flushDeletionQueue(){
+            while(true){
+                std::deque<DeferredDeletion> pending = {};
+                {
+                    std::lock_guard<std::mutex> lock(deletionMutex);
+                    pending.swap(deletionQueue);
+                    _completedFrameValue = _frameValue;
+                }
+                if(pending.empty()) break;
+                for(auto& deletion : pending) deletion.destroy();
+            }
+        }
+
+        bool Device::checkOptionalDeviceExtensionSupport(VkPhysicalDevice device, const char* extension){
+            uint32_t extensionCount;
+            vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+            std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+            vkEnumerateDeviceExtensionProperties(
+                device,
+                nullptr,
+                &extensionCount,
+                availableExtensions.data()
+            );
+
+            for(const auto& available : availableExtensions){
+                if(strcmp(available.extensionName, extension) == 0) return true;
+            }
+            return false;
+        }
+
+        VkResult Device::waitForPresent(VkSwapchainKHR swapchain, uint64_t presentId, uint64_t timeout){
+        #if defined(VK_KHR_present_wait)
+            if(_presentWaitSupported && presentId > 0){
+                return _vkWaitForPresentKHR(_device, swapchain, presentId, timeout);
+            }
+        #endif
+            return VK_SUCCESS;
+        }
+
         uint32_t Device::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties){
             VkPhysicalDeviceMemoryProperties memProperties;
             vkGetPhysicalDeviceMemoryProperties(_pDevice, &memProperties);
@@ -410,10 +586,25 @@ namespace shard{
             submitInfo.commandBufferCount = 1;
             submitInfo.pCommandBuffers = &commandBuffer;
 
-            vkQueueSubmit(_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-            vkQueueWaitIdle(_graphicsQueue);
+            VkFenceCreateInfo fenceInfo = {};
+            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+            VkFence fence = VK_NULL_HANDLE;
+            shard_abort_ifnot(vkCreateFence(_device, &fenceInfo, nullptr, &fence) == VK_SUCCESS);
+
+            // Headless devices have no frames, each single time submit counts as one
+            uint64_t submittedValue = completedFrameValue();
+            if(headless()){
+                submittedValue = frameValue();
+                advanceFrame();
+            }
+
+            // Only the submit needs the queue, other threads may submit while this waits
+            shard_abort_ifnot(queueSubmit(_graphicsQueue, 1, &submitInfo, fence) == VK_SUCCESS);
+            vkWaitForFences(_device, 1, &fence, VK_TRUE, UINT64_MAX);
+            vkDestroyFence(_device, fence, nullptr);
 
             vkFreeCommandBuffers(_device, _commandPool, 1, &commandBuffer);
+            collectGarbage(submittedValue);
         }
         void Device::transitionImageLayout(
             VkImage image, VkFormat format,
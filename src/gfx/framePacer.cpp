@@ -0,0 +1,138 @@
+#include <shard/gfx/framePacer.hpp>
+
+#include <thread>
+#include <algorithm>
+#include <cassert>
+
+namespace shard{
+    namespace gfx{
+        namespace{
+            // Never block on a present for longer than this, e.g. while minimized
+            constexpr uint64_t PRESENT_WAIT_TIMEOUT = 100000000; // 100ms
+            constexpr auto MIN_SLEEP_SLACK = std::chrono::microseconds(200);
+
+            float toSeconds(FrameLimiter::Clock::duration d){
+                return std::chrono::duration<float>(d).count();
+            }
+        }
+
+        void FrameLimiter::setTargetFrameRate(float fps){
+            assert(fps >= 0.0f);
+            _targetFrameRate = fps;
+            period = fps > 0.0f ?
+                std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0/fps)) :
+                Clock::duration::zero();
+            nextFrame = {};
+        }
+        float FrameLimiter::wait(){
+            if(period == Clock::duration::zero()) return 0.0f;
+
+            auto start = Clock::now();
+            if(nextFrame == Clock::time_point{}) nextFrame = start;
+
+            if(start < nextFrame){
+                // Sleep for the bulk of the wait, the OS may wake us up late
+                auto sleepTarget = nextFrame - sleepSlack;
+                if(sleepTarget > start){
+                    std::this_thread::sleep_until(sleepTarget);
+                    auto overshoot = Clock::now() - sleepTarget;
+                    // Follow the worst recent oversleep, decaying slowly back down
+                    sleepSlack = std::max<Clock::duration>(overshoot, sleepSlack - sleepSlack/16);
+                    sleepSlack = std::max<Clock::duration>(sleepSlack, MIN_SLEEP_SLACK);
+                }
+                // and spin for the rest
+                while(Clock::now() < nextFrame){
+                    std::this_thread::yield();
+                }
+            }
+
+            auto now = Clock::now();
+            nextFrame += period;
+            // Don't try to catch up after a long frame, restart the cadence instead
+            if(nextFrame < now) nextFrame = now;
+
+            return toSeconds(now - start);
+        }
+
+        void FramePacer::beginFrame(Swapchain& swapchain){
+            FrameTiming next = {};
+            next.limiterWait = limiter.wait();
+
+            uint64_t presentId = swapchain.lastPresentId();
+            if(maxQueuedPresents > 0 && presentId > maxQueuedPresents){
+                auto waitStart = Clock::now();
+                swapchain.waitForPresent(presentId - maxQueuedPresents, PRESENT_WAIT_TIMEOUT);
+                next.presentWait = toSeconds(Clock::now() - waitStart);
+            }
+
+            auto now = Clock::now();
+            if(frameStart != Clock::time_point{}){
+                current.frameTime = toSeconds(now - frameStart);
+                last = current;
+
+                timings[timingHead] = current;
+                timingHead = (timingHead + 1) % HISTORY_SIZE;
+                timingCount = std::min(timingCount + 1, HISTORY_SIZE);
+            }
+            frameStart = now;
+            current = next;
+        }
+        void FramePacer::endFrame(Swapchain& swapchain){
+            current.cpuTime = toSeconds(Clock::now() - frameStart);
+            current.fenceWait = swapchain.lastFenceWaitTime();
+        }
+
+        std::vector<FrameTiming> FramePacer::history() const {
+            std::vector<FrameTiming> ordered(timingCount);
+            size_t first = (timingHead + HISTORY_SIZE - timingCount) % HISTORY_SIZE;
+            for(size_t i = 0; i < timingCount; i++){
+                ordered[i] = timings[(first + i) % HISTORY_SIZE];
+            }
+            return ordered;
+        }
+        FrameStats FramePacer::frameTimeStats() const {
+            return calculateStats(&FrameTiming::frameTime);
+        }
+        FrameStats FramePacer::cpuTimeStats() const {
+            return calculateStats(&FrameTiming::cpuTime);
+        }
+        FrameStats FramePacer::calculateStats(float FrameTiming::* field) const {
+            FrameStats stats = {};
+            if(timingCount == 0) return stats;
+
+            std::vector<float> values(timingCount);
+            float sum = 0.0f;
+            for(size_t i = 0; i < timingCount; i++){
+                values[i] = timings[i].*field * 1000.0f;
+                sum += values[i];
+            }
+            std::sort(values.begin(), values.end());
+
+            auto percentile = [&](float p){
+                return values[size_t(p * float(values.size() - 1) + 0.5f)];
+            };
+            stats.average = sum / float(values.size());
+            stats.p50 = percentile(0.50f);
+            stats.p95 = percentile(0.95f);
+            stats.p99 = percentile(0.99f);
+            stats.max = values.back();
+            return stats;
+        }
+    } // namespace gfx
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -67,12 +67,12 @@ namespace shard{
             fb._framebuffer = VK_NULL_HANDLE;
         }
         Framebuffer::~Framebuffer(){
-            vkDestroyFramebuffer(device.device(), _framebuffer, nullptr);
+            destroy();
         }
 
         Framebuffer& Framebuffer::operator = (Framebuffer& fb){
             assert(&device == &fb.device);
-            vkDestroyFramebuffer(device.device(), _framebuffer, nullptr);
+            destroy();
             _framebuffer = fb._framebuffer;
             _extent = fb._extent;
             fb._framebuffer = VK_NULL_HANDLE;
@@ -80,13 +80,24 @@ namespace shard{
         }
         Framebuffer& Framebuffer::operator = (Framebuffer&& fb){
             assert(&device == &fb.device);
-            vkDestroyFramebuffer(device.device(), _framebuffer, nullptr);
+            destroy();
             _framebuffer = fb._framebuffer;
             _extent = fb._extent;
             fb._framebuffer = VK_NULL_HANDLE;
             return *this;
         }
 
+        void Framebuffer::destroy(){
+            if(_framebuffer == VK_NULL_HANDLE) return;
+
+            VkDevice vkDevice = device.device();
+            VkFramebuffer framebuffer = _framebuffer;
+            device.deferDestroy([vkDevice, framebuffer](){
+                vkDestroyFramebuffer(vkDevice, framebuffer, nullptr);
+            });
+            _framebuffer = VK_NULL_HANDLE;
+        }
+
         void Framebuffer::createFramebuffer(
             const std::vector<VkImageView>& attachments,
             VkExtent2D extent_, VkRenderPass renderPass
@@ -3,20 +3,24 @@
 namespace shard{
     namespace gfx{
         Graphics::Graphics(GLFWwindow* win, bool vsync):
-            VSYNC{vsync},
+            Graphics(win, vsync ? PresentPolicy::MAILBOX : PresentPolicy::IMMEDIATE)
+        {}
+        Graphics::Graphics(GLFWwindow* win, PresentPolicy policy):
+            _presentPolicy{policy},
             _window{win},
             _defaultPipelineConfig{}
         {
             assert(_window != nullptr);
 
             _device = std::make_unique<Device>(_window);
-            _swapchain = std::make_unique<Swapchain>(*_device, getFramebufferExtent(_window), VSYNC);
+            _swapchain = std::make_unique<Swapchain>(*_device, getFramebufferExtent(_window), _presentPolicy);
             _defaultPipelineConfig.makeDefault();
             createComputeCommandPool();
             createCommandBuffers();
             createEmptyPipelineLayout();
         }
         Graphics::~Graphics(){
+            _device->waitIdle();
             destroyCommandBuffers();
             vkDestroyPipelineLayout(_device->device(), _emptyPipelineLayout, nullptr);
             vkDestroyCommandPool(_device->device(), _computeCommandPool, nullptr);
@@ -28,10 +32,14 @@ namespace shard{
                 extent = getFramebufferExtent(_window);
                 glfwWaitEvents();
             }
-            _device->waitIdle();
 
+            // The old swapchain (and its framebuffers and depth images) may still be in
+            // use by frames in flight, retire it once the current frame has completed.
             std::shared_ptr<Swapchain> oldSwapchain = std::move(_swapchain);
-            _swapchain = std::make_unique<Swapchain>(*_device, extent, VSYNC, oldSwapchain);
+            _swapchain = std::make_unique<Swapchain>(*_device, extent, _presentPolicy, oldSwapchain);
+            _device->deferDestroy([retired = std::move(oldSwapchain)]() mutable {
+                retired.reset();
+            });
         }
         void Graphics::createComputeCommandPool(){
              QueueFamilyIndices indices = _device->getQueueFamilyIndices();
@@ -115,8 +123,16 @@ namespace shard{
             submitInfo.pCommandBuffers = &cmd;
             
 
-            vkQueueSubmit(_device->computeQueue(), 1, &submitInfo, VK_NULL_HANDLE);
-            vkQueueWaitIdle(_device->computeQueue());
+            _device->queueSubmit(_device->computeQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+            _device->queueWaitIdle(_device->computeQueue());
+
+            // With no frame being recorded and none in flight these commands were the only
+            // outstanding work, so compute only loops still complete frame values
+            uint64_t frameValue = _device->frameValue();
+            if(!isFrameStarted && _device->completedFrameValue() + 1 == frameValue){
+                _device->advanceFrame();
+                _device->collectGarbage(frameValue);
+            }
         }
 
         ShaderModule Graphics::createShaderModule(const char* filePath){
@@ -128,26 +144,29 @@ namespace shard{
 
         Compute Graphics::createCompute(
             VkPipelineLayout layout,
-            ShaderModule& shader
+            ShaderModule& shader,
+            const SpecializationConstants& constants
         ){
             return Compute(
-                device(), layout, shader
+                device(), layout, shader, constants
             );
         }
         Compute Graphics::createCompute(
             VkPipelineLayout layout,
-            const char* filePath
+            const char* filePath,
+            const SpecializationConstants& constants
         ){
             return Compute(
-                device(), layout, filePath
+                device(), layout, filePath, constants
             );
         }
         Compute Graphics::createCompute(
             VkPipelineLayout layout,
-            const std::vector<char> shaderSPV
+            const std::vector<char> shaderSPV,
+            const SpecializationConstants& constants
         ){
             return Compute(
-                device(), layout, shaderSPV
+                device(), layout, shaderSPV, constants
             );
         }
         Pipeline Graphics::createPipeline(
@@ -156,12 +175,13 @@ namespace shard{
             ShaderModule& frag,
             const std::vector<VkVertexInputBindingDescription>& bindingDescs,
             const std::vector<VkVertexInputAttributeDescription>& attrDescs,
-            PipelineConfigInfo& config
+            PipelineConfigInfo& config,
+            const SpecializationConstants& constants
         ){
             return Pipeline(device(), swapchain().renderPass(), layout, 
                 vert, frag,
                 bindingDescs, attrDescs,
-                config
+                config, constants
             );
         }
         Pipeline Graphics::createPipeline(
@@ -170,12 +190,13 @@ namespace shard{
             const char* fragFile,
             const std::vector<VkVertexInputBindingDescription>& bindingDescs,
             const std::vector<VkVertexInputAttributeDescription>& attrDescs,
-            PipelineConfigInfo& config
+            PipelineConfigInfo& config,
+            const SpecializationConstants& constants
         ){
             return Pipeline(device(), swapchain().renderPass(), layout, 
                 vertFile, fragFile,
                 bindingDescs, attrDescs,
-                config
+                config, constants
             );
         }
         Pipeline Graphics::createPipeline(
@@ -184,12 +205,13 @@ namespace shard{
             const std::vector<char>& fragFile,
             const std::vector<VkVertexInputBindingDescription>& bindingDescs,
             const std::vector<VkVertexInputAttributeDescription>& attrDescs,
-            PipelineConfigInfo& config
+            PipelineConfigInfo& config,
+            const SpecializationConstants& constants
         ){
             return Pipeline(device(), swapchain().renderPass(), layout, 
                 vertFile, fragFile,
                 bindingDescs, attrDescs,
-                config
+                config, constants
             );
         }
         Buffer Graphics::createVertexBuffer(size_t size, VkSharingMode sharingMode,const void* data){
@@ -209,6 +231,7 @@ namespace shard{
                 0, sharingMode
             );
             device().copyBuffer(stagingBuffer.buffer(), vBuf.buffer(), size);
+            stagingBuffer.destroyNow();
             return vBuf;
         }
         Buffer Graphics::createIndexBuffer(size_t size, VkSharingMode sharingMode, const void* data){
@@ -228,6 +251,7 @@ namespace shard{
                 0, sharingMode
             );
             device().copyBuffer(stagingBuffer.buffer(), iBuf.buffer(), size);
+            stagingBuffer.destroyNow();
             return iBuf;
         }
         Buffer Graphics::createUniformBuffer(size_t size, VkSharingMode sharingMode, const void* data){
@@ -262,11 +286,14 @@ namespace shard{
             Buffer sBuf = Buffer(
                 device(),
                 size,
-                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT   |
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
                 VMA_MEMORY_USAGE_GPU_ONLY,
                 0, sharingMode
             );
             device().copyBuffer(stagingBuffer.buffer(), sBuf.buffer(), size);
+            stagingBuffer.destroyNow();
             return sBuf;
         }
         Buffer Graphics::createBuffer(
@@ -286,6 +313,61 @@ namespace shard{
         Image Graphics::createTexture(uint32_t w, uint32_t h, const void* pixels){
             return Image(*_device, w, h, pixels);
         }
+        Image Graphics::createTexture(const char* filePath, MipFilter filter){
+            int w, h, channels;
+            stbi_uc* pixels = stbi_load(filePath, &w, &h, &channels, STBI_rgb_alpha);
+            assert(pixels != nullptr && "File does not exist!");
+
+            Image image = createTexture(uint32_t(w), uint32_t(h), pixels, filter);
+            stbi_image_free(pixels);
+            return image;
+        }
+        Image Graphics::createTexture(uint32_t w, uint32_t h, const void* pixels, MipFilter filter){
+            assert(pixels != nullptr);
+
+            // Levels are written through UNORM storage views of the sRGB image
+            Image image(*_device,
+                w, h, calculateMipmapLevels(w, h), 4,
+                VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
+                VK_SAMPLE_COUNT_1_BIT,
+                VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                VK_IMAGE_USAGE_SAMPLED_BIT |
+                VK_IMAGE_USAGE_STORAGE_BIT,
+                VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT |
+                VK_IMAGE_CREATE_EXTENDED_USAGE_BIT,
+                VMA_MEMORY_USAGE_GPU_ONLY,
+                VK_IMAGE_ASPECT_COLOR_BIT,
+                VK_SHARING_MODE_EXCLUSIVE
+            );
+            Buffer stagingBuffer(
+                *_device, size_t(w)*size_t(h)*4, pixels,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VMA_MEMORY_USAGE_CPU_ONLY,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                VK_SHARING_MODE_EXCLUSIVE
+            );
+
+            // Upload and mip generation share one submission
+            image.transition(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+            VkCommandBuffer commandBuffer = _device->beginSingleTimeCommands();
+
+            VkBufferImageCopy region = {};
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = 0;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = 1;
+            region.imageExtent = {w, h, 1};
+            vkCmdCopyBufferToImage(
+                commandBuffer, stagingBuffer.buffer(), image.image(),
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region
+            );
+            mipGenerator().record(commandBuffer, image, filter);
+
+            _device->endSingleTimeCommands(commandBuffer);
+            stagingBuffer.destroyNow();
+            return image;
+        }
         Image Graphics::createImage(
             uint32_t w, uint32_t h, uint32_t mipLevels,
             VkFormat format, VkImageTiling tiling,
@@ -386,8 +468,23 @@ namespace shard{
             return DescriptorSetLayout::Builder(device());
         }
 
+        MipGenerator& Graphics::mipGenerator(){
+            if(!_mipGenerator) _mipGenerator = std::make_unique<MipGenerator>(*_device);
+            return *_mipGenerator;
+        }
+        LayoutCache& Graphics::layoutCache(){
+            return _device->layoutCache();
+        }
+        ShaderReloader& Graphics::shaderReloader(){
+            if(!_shaderReloader) _shaderReloader = std::make_unique<ShaderReloader>(*_device);
+            return *_shaderReloader;
+        }
+
         void Graphics::setVsync(bool vsync){
-            VSYNC = vsync;
+            setPresentPolicy(vsync ? PresentPolicy::MAILBOX : PresentPolicy::IMMEDIATE);
+        }
+        void Graphics::setPresentPolicy(PresentPolicy policy){
+            _presentPolicy = policy;
             recreateSwapchain();
         }
 
@@ -395,6 +492,9 @@ namespace shard{
             std::function<void(VkCommandBuffer)> preRenderPassCommands, const Color& clearColor
         ){
             assert(!isFrameStarted);
+            if(_shaderReloader) _shaderReloader->swap();
+            _framePacer.beginFrame(*_swapchain);
+
             VkResult result = _swapchain->acquireNextImage(&imageIndex);
             if(result == VK_ERROR_OUT_OF_DATE_KHR){
                 recreateSwapchain();
@@ -463,6 +563,7 @@ namespace shard{
             );
 
             VkResult result = _swapchain->submitCommandBuffers(&commandBuffer, &imageIndex);
+            _framePacer.endFrame(*_swapchain);
             if(result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR){
                 recreateSwapchain();
                 result = VK_SUCCESS;
@@ -0,0 +1,62 @@
+#include <shard/gfx/gpu/compact.hpp>
+
+namespace shard{
+    namespace gfx{
+        namespace gpu{
+            Compact::Compact(Device& _device):
+                device{_device},
+                scan{_device},
+                scatter{_device, "compact", 5, sizeof(Params), false},
+                pools{_device},
+                offsets{_device}
+            {}
+
+            void Compact::record(
+                VkCommandBuffer commandBuffer, Buffer& values, Buffer& flags,
+                Buffer& dst, Buffer& outCount, uint32_t count
+            ){
+                assert(commandBuffer != VK_NULL_HANDLE);
+                assert(count > 0 && "Nothing to compact!");
+
+                Kernel::reserve(device, offsets, count * sizeof(uint32_t));
+                scan.record(commandBuffer, flags, offsets, count);
+
+                DescriptorPool& pool = pools.get(1);
+
+                Params params = {};
+                params.count = count;
+                params.groupCount = divideRoundUp(count, scatter.workgroupSize());
+                scatter.dispatch(
+                    commandBuffer, pool,
+                    {
+                        values.descriptorInfo(), flags.descriptorInfo(), offsets.descriptorInfo(),
+                        dst.descriptorInfo(), outCount.descriptorInfo()
+                    },
+                    &params, params.groupCount
+                );
+                Kernel::barrier(commandBuffer);
+            }
+            void Compact::run(Buffer& values, Buffer& flags, Buffer& dst, Buffer& outCount, uint32_t count){
+                VkCommandBuffer commandBuffer = device.beginSingleTimeCommands();
+                record(commandBuffer, values, flags, dst, outCount, count);
+                device.endSingleTimeCommands(commandBuffer);
+            }
+        } // namespace gpu
+    } // namespace gfx
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include <shard/gfx/gpu/kernel.hpp>
+#include <shard/gfx/layoutCache.hpp>
+
+#include <string>
+#include <algorithm>
+
+namespace shard{
+    namespace gfx{
+        namespace gpu{
+            namespace{
+                // Kernels with the same buffer count share one set layout
+                DescriptorSetLayout& cachedSetLayout(Device& device, uint32_t bufferCount){
+                    std::map<uint32_t, VkDescriptorSetLayoutBinding> bindings;
+                    for(uint32_t i = 0; i < bufferCount; i++){
+                        VkDescriptorSetLayoutBinding binding = {};
+                        binding.binding = i;
+                        binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                        binding.descriptorCount = 1;
+                        binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+                        bindings[i] = binding;
+                    }
+                    return device.layoutCache().descriptorSetLayout(bindings);
+                }
+            }
+
+            Kernel::Kernel(
+                Device& _device, const char* name, uint32_t _bufferCount,
+                uint32_t _pushSize, bool subgroupVariant,
+                const SpecializationConstants& constants
+            ):
+                device{_device},
+                bufferCount{_bufferCount},
+                pushSize{_pushSize},
+                _workgroupSize{Compute::clampWorkgroupSize(_device, PREFERRED_WORKGROUP_SIZE)},
+                _usesSubgroups{subgroupVariant && _device.subgroupArithmeticSupported()},
+                setLayout{cachedSetLayout(_device, _bufferCount)},
+                compute{_device}
+            {
+                assert(bufferCount > 0 && bufferCount <= MAX_BUFFERS);
+                assert(pushSize > 0 && pushSize % 4 == 0);
+
+                VkPushConstantRange range = {};
+                range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+                range.offset = 0;
+                range.size = pushSize;
+
+                layout = device.layoutCache().pipelineLayout({&setLayout}, {range});
+
+                SpecializationConstants kernelConstants = constants;
+                kernelConstants.set(0, _workgroupSize);
+
+                std::string path = std::string("shaders/gpu/") + name +
+                                   (_usesSubgroups ? "Subgroup" : "") + ".comp.spv";
+                compute = Compute(device, layout, path.c_str(), kernelConstants);
+            }
+
+            void Kernel::dispatch(
+                VkCommandBuffer commandBuffer, DescriptorPool& pool,
+                const std::vector<VkDescriptorBufferInfo>& buffers,
+                const void* push, uint32_t groupCount
+            ){
+                assert(buffers.size() == bufferCount);
+                if(groupCount == 0) return;
+
+                VkPhysicalDeviceLimits limits = device.properties().limits;
+                uint32_t groupsX = std::min(groupCount, limits.maxComputeWorkGroupCount[0]);
+                uint32_t groupsY = divideRoundUp(groupCount, groupsX);
+                assert(groupsY <= limits.maxComputeWorkGroupCount[1]);
+
+                bind(commandBuffer, pool, buffers, push);
+                compute.dispatch(commandBuffer, groupsX, groupsY);
+            }
+            void Kernel::dispatchIndirect(
+                VkCommandBuffer commandBuffer, DescriptorPool& pool,
+                const std::vector<VkDescriptorBufferInfo>& buffers,
+                const void* push, VkBuffer args, VkDeviceSize offset
+            ){
+                assert(args != VK_NULL_HANDLE);
+                bind(commandBuffer, pool, buffers, push);
+                compute.dispatchIndirect(commandBuffer, args, offset);
+            }
+            void Kernel::bind(
+                VkCommandBuffer commandBuffer, DescriptorPool& pool,
+                const std::vector<VkDescriptorBufferInfo>& buffers, const void* push
+            ){
+                assert(buffers.size() == bufferCount);
+
+                // The writer keeps pointers to the infos until build
+                std::vector<VkDescriptorBufferInfo> infos = buffers;
+                DescriptorWriter writer(setLayout, pool);
+                for(uint32_t i = 0; i < bufferCount; i++){
+                    writer.writeBuffer(i, &infos[i]);
+                }
+                VkDescriptorSet set = VK_NULL_HANDLE;
+                writer.build(set);
+
+                compute.bind(commandBuffer);
+                vkCmdBindDescriptorSets(
+                    commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                    layout, 0, 1, &set, 0, nullptr
+                );
+                vkCmdPushConstants(
+                    commandBuffer, layout, VK_SHADER_STAGE_COMPUTE_BIT,
+                    0, pushSize, push
+                );
+            }
+
+            void Kernel::barrier(VkCommandBuffer commandBuffer){
+                VkMemoryBarrier barrier = {};
+                barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT    |
+                                        VK_ACCESS_SHADER_WRITE_BIT   |
+                                        VK_ACCESS_TRANSFER_READ_BIT  |
+                                        VK_ACCESS_TRANSFER_WRITE_BIT |
+                                        VK_ACCESS_HOST_READ_BIT;
+                vkCmdPipelineBarrier(
+                    commandBuffer,
+                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT |
+                    VK_PIPELINE_STAGE_HOST_BIT,
+                    0,
+                    1, &barrier,
+                    0, nullptr,
+                    0, nullptr
+                );
+            }
+            void Kernel::reserve(Device& device, Buffer& buffer, VkDeviceSize size){
+                if(buffer.valid() && buffer.size() >= size) return;
+                buffer = Buffer(
+                    device, size,
+                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                    VK_BUFFER_USAGE_TRANSFER_SRC_BIT   |
+                    VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                    VMA_MEMORY_USAGE_GPU_ONLY, 0,
+                    VK_SHARING_MODE_EXCLUSIVE
+                );
+            }
+
+            DescriptorPool& FramePools::get(uint32_t setCount){
+                assert(setCount > 0);
+                uint64_t frameValue = device.frameValue();
+                uint64_t completedValue = device.completedFrameValue();
+
+                Entry* reusable = nullptr;
+                for(auto& entry : entries){
+                    if(entry.frameValue == frameValue && entry.used + setCount <= entry.capacity){
+                        entry.used += setCount;
+                        return *entry.pool;
+                    }
+                    if(!reusable && entry.frameValue <= completedValue && setCount <= entry.capacity){
+                        reusable = &entry;
+                    }
+                }
+
+                if(reusable){
+                    reusable->pool->reset();
+                } else{
+                    uint32_t capacity = std::max(setCount, MIN_SETS);
+                    entries.push_back({
+                        std::make_unique<DescriptorPool>(
+                            DescriptorPool::Builder(device)
+                                .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, capacity * Kernel::MAX_BUFFERS)
+                                .setMaxSets(capacity)
+                                .build()
+                        ),
+                        capacity, 0, 0
+                    });
+                    reusable = &entries.back();
+                }
+                reusable->frameValue = frameValue;
+                reusable->used = setCount;
+                return *reusable->pool;
+            }
+        } // namespace gpu
+    } // namespace gfx
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include <shard/gfx/gpu/radixSort.hpp>
+
+#include <utility>
+
+namespace shard{
+    namespace gfx{
+        namespace gpu{
+            RadixSort::RadixSort(Device& _device):
+                device{_device},
+                histogram{_device, "radixHistogram", 2, sizeof(Params), false},
+                scatter{_device, "radixScatter", 5, sizeof(Params), true},
+                scan{_device},
+                pools{_device},
+                histograms{_device},
+                offsets{_device},
+                tmpKeys{_device},
+                tmpValues{_device}
+            {
+                assert(histogram.workgroupSize() == scatter.workgroupSize());
+                assert(histogram.workgroupSize() >= RADIX);
+            }
+
+            void RadixSort::record(
+                VkCommandBuffer commandBuffer, Buffer& keys, Buffer& values,
+                uint32_t count, uint32_t keyBits
+            ){
+                assert(commandBuffer != VK_NULL_HANDLE);
+                if(count == 0) return;
+                recordPasses(commandBuffer, keys, values, count, keyBits, VK_NULL_HANDLE, 0);
+            }
+            void RadixSort::recordIndirect(
+                VkCommandBuffer commandBuffer, Buffer& keys, Buffer& values, uint32_t maxCount,
+                Buffer& args, VkDeviceSize argsOffset, uint32_t keyBits
+            ){
+                assert(commandBuffer != VK_NULL_HANDLE);
+                assert(args.valid());
+                if(maxCount == 0) return;
+                recordPasses(commandBuffer, keys, values, maxCount, keyBits, args.buffer(), argsOffset);
+            }
+            void RadixSort::recordPasses(
+                VkCommandBuffer commandBuffer, Buffer& keys, Buffer& values,
+                uint32_t count, uint32_t keyBits, VkBuffer args, VkDeviceSize argsOffset
+            ){
+                assert(keyBits > 0 && keyBits <= 32);
+
+                uint32_t groupCount = divideRoundUp(count, scatter.workgroupSize());
+                uint32_t passes = divideRoundUp(keyBits, RADIX_BITS);
+
+                Kernel::reserve(device, histograms, RADIX * groupCount * sizeof(uint32_t));
+                Kernel::reserve(device, offsets, RADIX * groupCount * sizeof(uint32_t));
+                Kernel::reserve(device, tmpKeys, count * sizeof(uint32_t));
+                Kernel::reserve(device, tmpValues, count * sizeof(uint32_t));
+
+                DescriptorPool& pool = pools.get(passes * 2);
+
+                Buffer* srcKeys = &keys;
+                Buffer* srcValues = &values;
+                Buffer* dstKeys = &tmpKeys;
+                Buffer* dstValues = &tmpValues;
+
+                // Indirect passes only overwrite the counts of the groups they run
+                if(args != VK_NULL_HANDLE){
+                    vkCmdFillBuffer(commandBuffer, histograms.buffer(), 0, RADIX * groupCount * sizeof(uint32_t), 0);
+                }
+                Kernel::barrier(commandBuffer);
+                for(uint32_t pass = 0; pass < passes; pass++){
+                    Params params = {};
+                    params.count = count;
+                    params.groupCount = groupCount;
+                    params.shift = pass * RADIX_BITS;
+
+                    auto dispatch = [&](Kernel& kernel, const std::vector<VkDescriptorBufferInfo>& buffers){
+                        if(args != VK_NULL_HANDLE){
+                            kernel.dispatchIndirect(commandBuffer, pool, buffers, &params, args, argsOffset);
+                        } else{
+                            kernel.dispatch(commandBuffer, pool, buffers, &params, groupCount);
+                        }
+                    };
+                    dispatch(histogram, {srcKeys->descriptorInfo(), histograms.descriptorInfo()});
+                    scan.record(commandBuffer, histograms, offsets, RADIX * groupCount);
+                    dispatch(scatter, {
+                        srcKeys->descriptorInfo(), srcValues->descriptorInfo(),
+                        offsets.descriptorInfo(),
+                        dstKeys->descriptorInfo(), dstValues->descriptorInfo()
+                    });
+                    Kernel::barrier(commandBuffer);
+
+                    std::swap(srcKeys, dstKeys);
+                    std::swap(srcValues, dstValues);
+                }
+
+                // The result ended up in the scratch buffers
+                if(srcKeys != &keys){
+                    VkBufferCopy region = {};
+                    region.size = count * sizeof(uint32_t);
+                    vkCmdCopyBuffer(commandBuffer, tmpKeys.buffer(), keys.buffer(), 1, &region);
+                    vkCmdCopyBuffer(commandBuffer, tmpValues.buffer(), values.buffer(), 1, &region);
+                    Kernel::barrier(commandBuffer);
+                }
+            }
+            void RadixSort::run(Buffer& keys, Buffer& values, uint32_t count, uint32_t keyBits){
+                VkCommandBuffer commandBuffer = device.beginSingleTimeCommands();
+                record(commandBuffer, keys, values, count, keyBits);
+                device.endSingleTimeCommands(commandBuffer);
+            }
+        } // namespace gpu
+    } // namespace gfx
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include <shard/gfx/gpu/reduce.hpp>
+
+namespace shard{
+    namespace gfx{
+        namespace gpu{
+            Reduce::Reduce(Device& _device, ReduceOp _op):
+                device{_device},
+                _op{_op},
+                kernel{
+                    _device, "reduce", 2, sizeof(Params), true,
+                    SpecializationConstants().set(1, static_cast<uint32_t>(_op))
+                },
+                pools{_device},
+                partials{Buffer(_device), Buffer(_device)}
+            {}
+
+            void Reduce::record(VkCommandBuffer commandBuffer, Buffer& src, Buffer& result, uint32_t count){
+                assert(commandBuffer != VK_NULL_HANDLE);
+                assert(count > 0 && "Nothing to reduce!");
+
+                uint32_t blockSize = kernel.workgroupSize() * ITEMS_PER_THREAD;
+
+                // Passes alternate between the partials, the last one writes the result
+                uint32_t passes = 0;
+                for(uint32_t n = count;; passes++){
+                    uint32_t groupCount = divideRoundUp(n, blockSize);
+                    if(groupCount == 1){
+                        passes++;
+                        break;
+                    }
+                    Kernel::reserve(device, partials[passes % 2], groupCount * sizeof(uint32_t));
+                    n = groupCount;
+                }
+
+                DescriptorPool& pool = pools.get(passes);
+
+                Kernel::barrier(commandBuffer);
+                VkDescriptorBufferInfo in = src.descriptorInfo();
+                for(uint32_t pass = 0, n = count; pass < passes; pass++){
+                    Params params = {};
+                    params.count = n;
+                    params.groupCount = divideRoundUp(n, blockSize);
+
+                    Buffer& out = pass + 1 == passes ? result : partials[pass % 2];
+                    kernel.dispatch(commandBuffer, pool, {in, out.descriptorInfo()}, &params, params.groupCount);
+                    Kernel::barrier(commandBuffer);
+
+                    in = out.descriptorInfo();
+                    n = params.groupCount;
+                }
+            }
+            void Reduce::run(Buffer& src, Buffer& result, uint32_t count){
+                VkCommandBuffer commandBuffer = device.beginSingleTimeCommands();
+                record(commandBuffer, src, result, count);
+                device.endSingleTimeCommands(commandBuffer);
+            }
+        } // namespace gpu
+    } // namespace gfx
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include <shard/gfx/gpu/scan.hpp>
+
+namespace shard{
+    namespace gfx{
+        namespace gpu{
+            Scan::Scan(Device& _device):
+                device{_device},
+                scan{_device, "scan", 3, sizeof(Params), true},
+                add{_device, "scanAdd", 2, sizeof(Params), false},
+                pools{_device}
+            {}
+
+            void Scan::record(VkCommandBuffer commandBuffer, Buffer& src, Buffer& dst, uint32_t count){
+                assert(commandBuffer != VK_NULL_HANDLE);
+                if(count == 0) return;
+
+                uint32_t levels = 0;
+                for(uint32_t n = count;; levels++){
+                    uint32_t groupCount = divideRoundUp(n, blockSize());
+                    if(blockSums.size() <= levels) blockSums.emplace_back(device);
+                    Kernel::reserve(device, blockSums[levels], groupCount * sizeof(uint32_t));
+                    if(groupCount == 1){
+                        levels++;
+                        break;
+                    }
+                    n = groupCount;
+                }
+
+                DescriptorPool& pool = pools.get(levels * 2);
+
+                Kernel::barrier(commandBuffer);
+                recordLevel(commandBuffer, pool, src.descriptorInfo(), dst.descriptorInfo(), count, 0);
+                Kernel::barrier(commandBuffer);
+            }
+            void Scan::run(Buffer& src, Buffer& dst, uint32_t count){
+                VkCommandBuffer commandBuffer = device.beginSingleTimeCommands();
+                record(commandBuffer, src, dst, count);
+                device.endSingleTimeCommands(commandBuffer);
+            }
+
+            void Scan::recordLevel(
+                VkCommandBuffer commandBuffer, DescriptorPool& pool,
+                VkDescriptorBufferInfo src, VkDescriptorBufferInfo dst,
+                uint32_t count, uint32_t level
+            ){
+                Params params = {};
+                params.count = count;
+                params.groupCount = divideRoundUp(count, blockSize());
+
+                VkDescriptorBufferInfo sums = blockSums[level].descriptorInfo();
+                scan.dispatch(commandBuffer, pool, {src, dst, sums}, &params, params.groupCount);
+                // A single block is already complete
+                if(params.groupCount == 1) return;
+
+                Kernel::barrier(commandBuffer);
+                recordLevel(commandBuffer, pool, sums, sums, params.groupCount, level + 1);
+                Kernel::barrier(commandBuffer);
+
+                add.dispatch(commandBuffer, pool, {dst, sums}, &params, params.groupCount);
+            }
+        } // namespace gpu
+    } // namespace gfx
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
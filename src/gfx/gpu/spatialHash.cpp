@@ -0,0 +1,155 @@
+#include <shard/gfx/gpu/spatialHash.hpp>
+
+namespace shard{
+    namespace gfx{
+        namespace gpu{
+            namespace{
+                uint32_t nextPowerOfTwo(uint32_t value){
+                    uint32_t result = 1;
+                    while(result < value) result <<= 1;
+                    return result;
+                }
+            }
+
+            void SpatialHash::Reference::build(
+                const float* positions, uint32_t count, float cellSize,
+                uint32_t tableSize, uint32_t stride, uint32_t offset
+            ){
+                build(positions + offset, positions + offset + 1, count, cellSize, tableSize, stride);
+            }
+            void SpatialHash::Reference::build(
+                const float* x, const float* y, uint32_t count, float cellSize,
+                uint32_t tableSize, uint32_t stride
+            ){
+                assert(cellSize > 0.0f);
+                assert(tableSize > 0 && (tableSize & (tableSize - 1)) == 0);
+
+                inverseCellSize = 1.0f / cellSize;
+                cellStarts.assign(tableSize, 0);
+                cellCounts.assign(tableSize, 0);
+                indices.resize(count);
+
+                std::vector<uint32_t> buckets(count);
+                for(uint32_t i = 0; i < count; i++){
+                    size_t index = size_t(i) * stride;
+                    buckets[i] = bucket(x[index], y[index], inverseCellSize, tableSize);
+                    cellCounts[buckets[i]]++;
+                }
+                for(uint32_t b = 1; b < tableSize; b++){
+                    cellStarts[b] = cellStarts[b - 1] + cellCounts[b - 1];
+                }
+
+                std::vector<uint32_t> fill = cellStarts;
+                for(uint32_t i = 0; i < count; i++){
+                    indices[fill[buckets[i]]++] = i;
+                }
+            }
+
+            SpatialHash::SpatialHash(Device& _device, uint32_t capacity, uint32_t tableSize):
+                device{_device},
+                _capacity{capacity},
+                _tableSize{tableSize == 0 ? nextPowerOfTwo(capacity) : tableSize},
+                histogram{_device, "spatialHashCount", 3, sizeof(Params), false},
+                scatter{_device, "spatialHashScatter", 4, sizeof(Params), false},
+                scan{_device},
+                pools{_device},
+                _cellStarts{_device},
+                _cellCounts{_device},
+                _indices{_device},
+                slots{_device}
+            {
+                assert(_capacity > 0);
+                assert((_tableSize & (_tableSize - 1)) == 0 && "The table size must be a power of two!");
+
+                Kernel::reserve(device, _cellStarts, _tableSize * sizeof(uint32_t));
+                Kernel::reserve(device, _cellCounts, _tableSize * sizeof(uint32_t));
+                Kernel::reserve(device, _indices, _capacity * sizeof(uint32_t));
+                Kernel::reserve(device, slots, _capacity * sizeof(uint32_t));
+            }
+
+            void SpatialHash::record(
+                VkCommandBuffer commandBuffer, Buffer& positions, uint32_t count,
+                float cellSize, uint32_t stride, uint32_t offset
+            ){
+                assert(commandBuffer != VK_NULL_HANDLE);
+                assert(count <= _capacity && "More points than the hash was created for!");
+                assert(cellSize > 0.0f && stride >= 2);
+
+                Kernel::barrier(commandBuffer);
+                vkCmdFillBuffer(commandBuffer, _cellCounts.buffer(), 0, VK_WHOLE_SIZE, 0);
+                Kernel::barrier(commandBuffer);
+                if(count == 0){
+                    scan.record(commandBuffer, _cellCounts, _cellStarts, _tableSize);
+                    return;
+                }
+
+                DescriptorPool& pool = pools.get(2);
+
+                Params params = {};
+                params.count = count;
+                params.groupCount = divideRoundUp(count, histogram.workgroupSize());
+                params.tableSize = _tableSize;
+                params.stride = stride;
+                params.offset = offset;
+                params.inverseCellSize = 1.0f / cellSize;
+
+                histogram.dispatch(
+                    commandBuffer, pool,
+                    {positions.descriptorInfo(), _cellCounts.descriptorInfo(), slots.descriptorInfo()},
+                    &params, params.groupCount
+                );
+                scan.record(commandBuffer, _cellCounts, _cellStarts, _tableSize);
+                scatter.dispatch(
+                    commandBuffer, pool,
+                    {
+                        positions.descriptorInfo(), _cellStarts.descriptorInfo(),
+                        slots.descriptorInfo(), _indices.descriptorInfo()
+                    },
+                    &params, params.groupCount
+                );
+                Kernel::barrier(commandBuffer);
+            }
+            void SpatialHash::build(
+                Buffer& positions, uint32_t count,
+                float cellSize, uint32_t stride, uint32_t offset
+            ){
+                VkCommandBuffer commandBuffer = device.beginSingleTimeCommands();
+                record(commandBuffer, positions, count, cellSize, stride, offset);
+                device.endSingleTimeCommands(commandBuffer);
+            }
+
+            uint32_t SpatialHash::neighbours(
+                float x, float y, float inverseCellSize, uint32_t tableSize, uint32_t buckets[9]
+            ){
+                int32_t cx = int32_t(std::floor(x * inverseCellSize));
+                int32_t cy = int32_t(std::floor(y * inverseCellSize));
+                uint32_t count = 0;
+                for(int32_t dy = -1; dy <= 1; dy++){
+                    for(int32_t dx = -1; dx <= 1; dx++){
+                        uint32_t b = bucket(cx + dx, cy + dy, tableSize);
+                        bool seen = false;
+                        for(uint32_t i = 0; i < count; i++) seen = seen || buckets[i] == b;
+                        if(!seen) buckets[count++] = b;
+                    }
+                }
+                return count;
+            }
+        } // namespace gpu
+    } // namespace gfx
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -1,11 +1,19 @@
 #include <shard/gfx/image.hpp>
 #include <cmath>
+#include <algorithm>
 
 namespace shard{
     namespace gfx{
         Image::Image(Device& _device, const char* filePath):
             device{_device}
         {
+            if(ktx2::isKtx2File(filePath)){
+                ktx2::Texture texture;
+                shard_abort_ifnot(ktx2::load(filePath, texture) && "Unsupported KTX2 file!");
+                *this = Image(device, texture);
+                return;
+            }
+
             int w, h, channels;
             stbi_uc* pixels = stbi_load(filePath, &w, &h, &channels, STBI_rgb_alpha);
             assert(pixels != nullptr && "File does not exist!");
@@ -111,6 +119,7 @@ namespace shard{
                     stagingBuffer.buffer(), _image,
                     _extent.width, _extent.height 
                 );
+                stagingBuffer.destroyNow();
                 if(mipLevels > 1)
                     genMipMaps();
                 else
@@ -124,10 +133,19 @@ namespace shard{
             imageViewInfo.format = _format;
             imageViewInfo.subresourceRange.aspectMask = aspectMask;
             imageViewInfo.subresourceRange.baseMipLevel = 0;
-            imageViewInfo.subresourceRange.levelCount = 1;
+            imageViewInfo.subresourceRange.levelCount = _mipLevels;
             imageViewInfo.subresourceRange.baseArrayLayer = 0;
             imageViewInfo.subresourceRange.layerCount = 1;
 
+            // Storage access to extended usage images goes through views of a compatible
+            // format (see MipGenerator), the default view only supports the other usages
+            VkImageViewUsageCreateInfo viewUsageInfo = {};
+            if(flags & VK_IMAGE_CREATE_EXTENDED_USAGE_BIT){
+                viewUsageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO;
+                viewUsageInfo.usage = usage & ~VK_IMAGE_USAGE_STORAGE_BIT;
+                imageViewInfo.pNext = &viewUsageInfo;
+            }
+
             shard_abort_ifnot(
                 vkCreateImageView(
                     device.device(), &imageViewInfo, nullptr,
@@ -135,6 +153,70 @@ namespace shard{
                 ) == VK_SUCCESS
             );            
         }
+        Image::Image(Device& _device, const ktx2::Texture& texture):
+            device{_device}
+        {
+            VkFormatProperties formatProperties;
+            vkGetPhysicalDeviceFormatProperties(device.pDevice(), texture.format, &formatProperties);
+            shard_abort_ifnot(
+                (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) &&
+                "Texture format is not supported by the device!"
+            );
+
+            uint32_t levelCount = static_cast<uint32_t>(texture.levels.size());
+            *this = Image(
+                device,
+                texture.width, texture.height, levelCount,
+                getFormatBlockInfo(texture.format).blockSize,
+                texture.format, VK_IMAGE_TILING_OPTIMAL,
+                VK_SAMPLE_COUNT_1_BIT,
+                VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+                VK_IMAGE_USAGE_SAMPLED_BIT,
+                0,
+                VMA_MEMORY_USAGE_GPU_ONLY,
+                VK_IMAGE_ASPECT_COLOR_BIT,
+                VK_SHARING_MODE_EXCLUSIVE
+            );
+
+            // The whole file is staged, level offsets are relative to its start
+            Buffer stagingBuffer = Buffer(
+                device, texture.data.size(),
+                texture.data.data(),
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VMA_MEMORY_USAGE_CPU_ONLY,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT  |
+                VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                VK_SHARING_MODE_EXCLUSIVE
+            );
+
+            std::vector<VkBufferImageCopy> regions(levelCount);
+            for(uint32_t i = 0; i < levelCount; i++){
+                VkBufferImageCopy& region = regions[i];
+                region = {};
+                region.bufferOffset = texture.levels[i].byteOffset;
+                region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                region.imageSubresource.mipLevel = i;
+                region.imageSubresource.baseArrayLayer = 0;
+                region.imageSubresource.layerCount = 1;
+                region.imageOffset = {0, 0, 0};
+                region.imageExtent = {
+                    std::max(texture.width  >> i, 1u),
+                    std::max(texture.height >> i, 1u),
+                    1
+                };
+            }
+
+            transition(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+            VkCommandBuffer commandBuffer = device.beginSingleTimeCommands();
+            vkCmdCopyBufferToImage(
+                commandBuffer, stagingBuffer.buffer(), _image,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                levelCount, regions.data()
+            );
+            device.endSingleTimeCommands(commandBuffer);
+            stagingBuffer.destroyNow();
+            transition(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        }
         Image::Image(Image& i):
             device{i.device},
             _extent{i._extent},
@@ -182,8 +264,20 @@ namespace shard{
             i.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
         }
         void Image::cleanup(){
-            vkDestroyImageView(device.device(), _imageView, nullptr);
-            vmaDestroyImage(device.allocator(), _image, _allocation);
+            if(_image == VK_NULL_HANDLE && _imageView == VK_NULL_HANDLE) return;
+
+            VkDevice vkDevice = device.device();
+            VmaAllocator allocator = device.allocator();
+            VkImage image = _image;
+            VkImageView imageView = _imageView;
+            VmaAllocation allocation = _allocation;
+            device.deferDestroy([vkDevice, allocator, image, imageView, allocation](){
+                vkDestroyImageView(vkDevice, imageView, nullptr);
+                vmaDestroyImage(allocator, image, allocation);
+            });
+            _image = VK_NULL_HANDLE;
+            _imageView = VK_NULL_HANDLE;
+            _allocation = VK_NULL_HANDLE;
         }
         Image::~Image(){
             cleanup();
@@ -239,6 +333,11 @@ namespace shard{
         }
 
         void Image::genMipMaps(){
+            VkCommandBuffer commandBuffer = device.beginSingleTimeCommands();
+            recordMipMaps(commandBuffer);
+            device.endSingleTimeCommands(commandBuffer);
+        }
+        void Image::recordMipMaps(VkCommandBuffer commandBuffer){
             // Check if image format supports linear blitting
             VkFormatProperties formatProperties;
             vkGetPhysicalDeviceFormatProperties(device.pDevice(), _format, &formatProperties);
@@ -248,8 +347,6 @@ namespace shard{
                 VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT
             );
 
-            VkCommandBuffer commandBuffer = device.beginSingleTimeCommands();
-
             VkImageMemoryBarrier barrier{};
             barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
             barrier.image = _image;
@@ -327,10 +424,8 @@ namespace shard{
                 1, &barrier
             );
 
-            device.endSingleTimeCommands(commandBuffer);
-
             oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-         }
+        }
 
         Sampler::Sampler(
             Device& _device,
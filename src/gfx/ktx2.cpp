@@ -0,0 +1,158 @@
+#include <shard/gfx/ktx2.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+
+namespace shard{
+    namespace gfx{
+        FormatBlockInfo getFormatBlockInfo(VkFormat format){
+            switch(format){
+                case VK_FORMAT_R8_UNORM:
+                case VK_FORMAT_R8_SRGB:
+                    return {1, 1, 1};
+                case VK_FORMAT_R8G8_UNORM:
+                case VK_FORMAT_R8G8_SRGB:
+                    return {1, 1, 2};
+                case VK_FORMAT_R8G8B8A8_UNORM:
+                case VK_FORMAT_R8G8B8A8_SRGB:
+                case VK_FORMAT_B8G8R8A8_UNORM:
+                case VK_FORMAT_B8G8R8A8_SRGB:
+                    return {1, 1, 4};
+                case VK_FORMAT_R16G16B16A16_SFLOAT:
+                    return {1, 1, 8};
+                case VK_FORMAT_R32G32B32A32_SFLOAT:
+                    return {1, 1, 16};
+
+                case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+                case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+                case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+                case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+                case VK_FORMAT_BC4_UNORM_BLOCK:
+                case VK_FORMAT_BC4_SNORM_BLOCK:
+                    return {4, 4, 8};
+                case VK_FORMAT_BC2_UNORM_BLOCK:
+                case VK_FORMAT_BC2_SRGB_BLOCK:
+                case VK_FORMAT_BC3_UNORM_BLOCK:
+                case VK_FORMAT_BC3_SRGB_BLOCK:
+                case VK_FORMAT_BC5_UNORM_BLOCK:
+                case VK_FORMAT_BC5_SNORM_BLOCK:
+                case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+                case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+                case VK_FORMAT_BC7_UNORM_BLOCK:
+                case VK_FORMAT_BC7_SRGB_BLOCK:
+                    return {4, 4, 16};
+
+                // ASTC blocks are always 16 bytes
+                case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:
+                case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+                    return {4, 4, 16};
+                case VK_FORMAT_ASTC_5x5_UNORM_BLOCK:
+                case VK_FORMAT_ASTC_5x5_SRGB_BLOCK:
+                    return {5, 5, 16};
+                case VK_FORMAT_ASTC_6x6_UNORM_BLOCK:
+                case VK_FORMAT_ASTC_6x6_SRGB_BLOCK:
+                    return {6, 6, 16};
+                case VK_FORMAT_ASTC_8x8_UNORM_BLOCK:
+                case VK_FORMAT_ASTC_8x8_SRGB_BLOCK:
+                    return {8, 8, 16};
+                case VK_FORMAT_ASTC_10x10_UNORM_BLOCK:
+                case VK_FORMAT_ASTC_10x10_SRGB_BLOCK:
+                    return {10, 10, 16};
+                case VK_FORMAT_ASTC_12x12_UNORM_BLOCK:
+                case VK_FORMAT_ASTC_12x12_SRGB_BLOCK:
+                    return {12, 12, 16};
+
+                default:
+                    return {1, 1, 0};
+            }
+        }
+
+        namespace ktx2{
+            bool isKtx2File(const char* filePath){
+                std::ifstream fp(filePath, std::ios::binary);
+                if(!fp.is_open()) return false;
+
+                uint8_t identifier[sizeof(IDENTIFIER)] = {};
+                fp.read(reinterpret_cast<char*>(identifier), sizeof(identifier));
+                return fp.gcount() == sizeof(identifier) &&
+                       memcmp(identifier, IDENTIFIER, sizeof(IDENTIFIER)) == 0;
+            }
+
+            bool load(const char* filePath, Texture& texture){
+                std::ifstream fp(filePath, std::ios::ate | std::ios::binary);
+                if(!fp.is_open()) return false;
+
+                size_t fileSize = static_cast<size_t>(fp.tellg());
+                if(fileSize < sizeof(Header)) return false;
+
+                texture.data.resize(fileSize);
+                fp.seekg(0);
+                fp.read(reinterpret_cast<char*>(texture.data.data()), fileSize);
+                fp.close();
+
+                Header header;
+                memcpy(&header, texture.data.data(), sizeof(Header));
+                if(memcmp(header.identifier, IDENTIFIER, sizeof(IDENTIFIER)) != 0) return false;
+
+                FormatBlockInfo blockInfo = getFormatBlockInfo(VkFormat(header.vkFormat));
+                if(
+                    blockInfo.blockSize == 0 ||         // also rejects Basis Universal
+                    header.pixelHeight == 0 ||          // 1D
+                    header.pixelDepth != 0 ||           // 3D
+                    header.layerCount > 1 ||
+                    header.faceCount != 1 ||
+                    header.supercompressionScheme != 0
+                ) return false;
+
+                // A level count of 0 asks the loader to generate mips, just use level 0
+                uint32_t levelCount = std::max(header.levelCount, 1u);
+                size_t levelIndexEnd = sizeof(Header) + levelCount * sizeof(LevelIndex);
+                if(fileSize < levelIndexEnd) return false;
+
+                texture.format = VkFormat(header.vkFormat);
+                texture.width = header.pixelWidth;
+                texture.height = header.pixelHeight;
+                texture.levels.resize(levelCount);
+                memcpy(
+                    texture.levels.data(),
+                    texture.data.data() + sizeof(Header),
+                    levelCount * sizeof(LevelIndex)
+                );
+
+                for(uint32_t i = 0; i < levelCount; i++){
+                    const LevelIndex& level = texture.levels[i];
+
+                    uint32_t w = std::max(texture.width  >> i, 1u);
+                    uint32_t h = std::max(texture.height >> i, 1u);
+                    uint64_t expected =
+                        uint64_t((w + blockInfo.blockWidth  - 1) / blockInfo.blockWidth) *
+                        uint64_t((h + blockInfo.blockHeight - 1) / blockInfo.blockHeight) *
+                        blockInfo.blockSize;
+
+                    if(
+                        level.byteLength < expected ||
+                        level.byteOffset + level.byteLength > fileSize
+                    ) return false;
+                }
+                return true;
+            }
+        } // namespace ktx2
+    } // namespace gfx
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include <shard/gfx/layoutCache.hpp>
+
+#include <algorithm>
+
+namespace shard{
+    namespace gfx{
+        LayoutCache::LayoutCache(Device& _device):
+            device{_device}
+        {}
+        LayoutCache::~LayoutCache(){
+            VkDevice vkDevice = device.device();
+            for(auto& [key, layout] : pipelineLayouts){
+                VkPipelineLayout pipelineLayout = layout;
+                device.deferDestroy([vkDevice, pipelineLayout](){
+                    vkDestroyPipelineLayout(vkDevice, pipelineLayout, nullptr);
+                });
+            }
+        }
+
+        DescriptorSetLayout& LayoutCache::descriptorSetLayout(
+            const std::map<uint32_t, VkDescriptorSetLayoutBinding>& bindings
+        ){
+            std::vector<uint32_t> key;
+            key.reserve(bindings.size() * 4);
+            for(auto& [binding, desc] : bindings){
+                assert(desc.pImmutableSamplers == nullptr);
+                key.insert(key.end(), {
+                    binding, uint32_t(desc.descriptorType), desc.descriptorCount, desc.stageFlags
+                });
+            }
+
+            auto it = setLayouts.find(key);
+            if(it == setLayouts.end()){
+                it = setLayouts.emplace(
+                    std::move(key), std::make_unique<DescriptorSetLayout>(device, bindings)
+                ).first;
+            }
+            return *it->second;
+        }
+        VkPipelineLayout LayoutCache::pipelineLayout(
+            const std::vector<DescriptorSetLayout*>& layouts,
+            const std::vector<VkPushConstantRange>& ranges
+        ){
+            std::vector<VkDescriptorSetLayout> rawLayouts(layouts.size());
+            std::vector<uint64_t> key;
+            key.reserve(layouts.size() + ranges.size() * 3 + 1);
+            key.push_back(layouts.size());
+            for(size_t i = 0; i < layouts.size(); i++){
+                assert(layouts[i] != nullptr);
+                rawLayouts[i] = layouts[i]->layout();
+                key.push_back(uint64_t(rawLayouts[i]));
+            }
+            for(auto& range : ranges){
+                key.insert(key.end(), {range.stageFlags, range.offset, range.size});
+            }
+
+            auto it = pipelineLayouts.find(key);
+            if(it != pipelineLayouts.end()) return it->second;
+
+            VkPipelineLayoutCreateInfo createInfo = {};
+            createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+            createInfo.setLayoutCount         = uint32_t(rawLayouts.size());
+            createInfo.pSetLayouts            = rawLayouts.data();
+            createInfo.pushConstantRangeCount = uint32_t(ranges.size());
+            createInfo.pPushConstantRanges    = ranges.data();
+
+            VkPipelineLayout layout = VK_NULL_HANDLE;
+            shard_abort_ifnot(
+                vkCreatePipelineLayout(device.device(), &createInfo, nullptr, &layout)
+                == VK_SUCCESS
+            );
+            pipelineLayouts.emplace(std::move(key), layout);
+            return layout;
+        }
+        LayoutCache::Layout LayoutCache::reflect(const std::vector<const ShaderModule*>& shaders){
+            std::map<uint32_t, std::map<uint32_t, VkDescriptorSetLayoutBinding>> sets;
+            VkPushConstantRange pushConstants = {};
+            uint32_t pushConstantsEnd = 0;
+
+            for(auto shader : shaders){
+                assert(shader != nullptr);
+                const ShaderReflection& reflection = shader->reflection();
+                assert(reflection.valid() && "Shader module has no reflection data!");
+
+                for(auto& binding : reflection.bindings){
+                    // Runtime sized arrays need a variable descriptor count, build those by hand
+                    shard_abort_ifnot(binding.count > 0);
+                    auto [it, inserted] = sets[binding.set].try_emplace(binding.binding);
+                    VkDescriptorSetLayoutBinding& desc = it->second;
+                    if(inserted){
+                        desc.binding = binding.binding;
+                        desc.descriptorType = binding.type;
+                        desc.descriptorCount = binding.count;
+                    } else{
+                        assert(
+                            desc.descriptorType == binding.type &&
+                            "Stages disagree on the type of a descriptor binding!"
+                        );
+                        desc.descriptorCount = std::max(desc.descriptorCount, binding.count);
+                    }
+                    desc.stageFlags |= reflection.stage;
+                }
+
+                // One range covering every stage's block is always valid
+                const VkPushConstantRange& range = reflection.pushConstants;
+                if(range.size == 0) continue;
+                if(pushConstants.stageFlags == 0) pushConstants.offset = range.offset;
+                pushConstants.offset = std::min(pushConstants.offset, range.offset);
+                pushConstantsEnd = std::max(pushConstantsEnd, range.offset + range.size);
+                pushConstants.stageFlags |= range.stageFlags;
+            }
+            if(pushConstants.stageFlags != 0) pushConstants.size = pushConstantsEnd - pushConstants.offset;
+
+            Layout layout;
+            layout.pushConstants = pushConstants;
+            uint32_t setCount = sets.empty() ? 0 : sets.rbegin()->first + 1;
+            layout.setLayouts.resize(setCount);
+            for(uint32_t set = 0; set < setCount; set++){
+                auto it = sets.find(set);
+                layout.setLayouts[set] = it != sets.end() ?
+                    &descriptorSetLayout(it->second) : &descriptorSetLayout({});
+            }
+
+            std::vector<VkPushConstantRange> ranges;
+            if(pushConstants.size > 0) ranges.push_back(pushConstants);
+            layout.pipelineLayout = pipelineLayout(layout.setLayouts, ranges);
+            return layout;
+        }
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,305 @@
+#include <shard/gfx/meshFile.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <thread>
+#include <functional>
+
+#if defined(_WIN32)
+    #include <process.h>
+#else
+    #include <unistd.h>
+#endif
+
+namespace shard{
+    namespace gfx{
+        namespace smesh{
+            static uint64_t mix(uint64_t v){
+                v ^= v >> 31;
+                v *= 0x7FB5D329728EA185ull;
+                v ^= v >> 27;
+                v *= 0x81DADEF4BC2DD44Dull;
+                v ^= v >> 33;
+                return v;
+            }
+
+            uint64_t hashBytes(const void* data, size_t size){
+                const uint8_t* bytes = static_cast<const uint8_t*>(data);
+                uint64_t h = 0x9E3779B97F4A7C15ull ^ size;
+                // Empty input may come with a null pointer, which memcpy does not accept
+                if(size == 0) return mix(h ^ mix(0));
+
+                size_t i = 0;
+                for(; i + 8 <= size; i += 8){
+                    uint64_t word;
+                    memcpy(&word, bytes + i, 8);
+                    h = (h ^ mix(word)) * 0x100000001B3ull;
+                }
+                uint64_t tail = 0;
+                memcpy(&tail, bytes + i, size - i);
+                return mix(h ^ mix(tail));
+            }
+
+            bool stampFile(const char* filePath, SourceStamp& stamp, bool hash){
+                std::error_code error;
+                stamp.size = std::filesystem::file_size(filePath, error);
+                if(error) return false;
+                stamp.modifiedTime = static_cast<int64_t>(
+                    std::filesystem::last_write_time(filePath, error).time_since_epoch().count()
+                );
+                if(error) return false;
+
+                stamp.hash = 0;
+                if(hash){
+                    MappedFile source(filePath);
+                    if(!source.valid()) return false;
+                    stamp.hash = hashBytes(source.data(), source.size());
+                }
+                return true;
+            }
+
+            bool write(
+                const char* filePath, const SourceStamp& source,
+                const std::vector<Vertex3D>& vertices,
+                const std::vector<uint32_t>& indices,
+                const MeshletMesh* meshlets
+            ){
+                auto align = [](uint64_t offset){
+                    return (offset + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+                };
+
+                Header header = {};
+                memcpy(header.magic, MAGIC, sizeof(MAGIC));
+                header.version = VERSION;
+                header.sourceSize = source.size;
+                header.sourceModifiedTime = source.modifiedTime;
+                header.sourceHash = source.hash;
+                header.vertexStride = sizeof(Vertex3D);
+
+                glm::vec3 boundsMin(vertices.empty() ? 0.0f :  INFINITY);
+                glm::vec3 boundsMax(vertices.empty() ? 0.0f : -INFINITY);
+                for(const auto& vertex : vertices){
+                    boundsMin = glm::min(boundsMin, vertex.pos);
+                    boundsMax = glm::max(boundsMax, vertex.pos);
+                }
+                memcpy(header.boundsMin, &boundsMin, sizeof(header.boundsMin));
+                memcpy(header.boundsMax, &boundsMax, sizeof(header.boundsMax));
+
+                struct Blob{
+                    SectionType type;
+                    size_t elementCount;
+                    size_t elementSize;
+                    const void* data;
+                };
+                std::vector<Blob> blobs = {
+                    {SectionType::VERTICES, vertices.size(), sizeof(Vertex3D), vertices.data()},
+                    {SectionType::INDICES,  indices.size(),  sizeof(uint32_t), indices.data()},
+                };
+                if(meshlets){
+                    blobs.push_back({
+                        SectionType::MESHLETS, meshlets->meshlets.size(),
+                        sizeof(Meshlet), meshlets->meshlets.data()
+                    });
+                    blobs.push_back({
+                        SectionType::MESHLET_BOUNDS, meshlets->bounds.size(),
+                        sizeof(MeshletBounds), meshlets->bounds.data()
+                    });
+                    blobs.push_back({
+                        SectionType::MESHLET_VERTICES, meshlets->vertices.size(),
+                        sizeof(uint32_t), meshlets->vertices.data()
+                    });
+                    blobs.push_back({
+                        SectionType::MESHLET_TRIANGLES, meshlets->triangles.size(),
+                        sizeof(uint8_t), meshlets->triangles.data()
+                    });
+                }
+                header.sectionCount = static_cast<uint32_t>(blobs.size());
+
+                std::vector<Section> sections(blobs.size());
+                uint64_t offset = align(sizeof(Header) + sections.size() * sizeof(Section));
+                for(size_t i = 0; i < blobs.size(); i++){
+                    offset = align(offset);
+                    sections[i] = {
+                        blobs[i].type, static_cast<uint32_t>(blobs[i].elementCount),
+                        offset, blobs[i].elementCount * blobs[i].elementSize
+                    };
+                    offset += sections[i].byteLength;
+                }
+
+                std::vector<uint8_t> file(offset, 0);
+                memcpy(file.data(), &header, sizeof(header));
+                memcpy(file.data() + sizeof(header), sections.data(), sections.size() * sizeof(Section));
+                for(size_t i = 0; i < blobs.size(); i++){
+                    if(sections[i].byteLength == 0) continue;
+                    memcpy(file.data() + sections[i].byteOffset, blobs[i].data, sections[i].byteLength);
+                }
+
+                // Other threads and processes may be writing the same cache file
+            #if defined(_WIN32)
+                uint64_t processId = static_cast<uint64_t>(_getpid());
+            #else
+                uint64_t processId = static_cast<uint64_t>(getpid());
+            #endif
+                std::string tempPath = std::string(filePath) + "." + std::to_string(processId) + "." +
+                    std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+                {
+                    std::ofstream fp(tempPath, std::ios::binary | std::ios::trunc);
+                    if(!fp.is_open()) return false;
+                    fp.write(reinterpret_cast<const char*>(file.data()), file.size());
+                    if(!fp.good()) return false;
+                }
+
+                std::error_code error;
+                std::filesystem::rename(tempPath, filePath, error);
+                if(error){
+                    std::filesystem::remove(tempPath, error);
+                    return false;
+                }
+                return true;
+            }
+        } // namespace smesh
+
+        MeshFile::MeshFile(const char* filePath):
+            file{filePath}
+        {
+            if(!file.valid() || file.size() < sizeof(smesh::Header)) return;
+
+            const auto* header = reinterpret_cast<const smesh::Header*>(file.data());
+            if(
+                memcmp(header->magic, smesh::MAGIC, sizeof(smesh::MAGIC)) != 0 ||
+                header->version != smesh::VERSION ||
+                header->vertexStride != sizeof(Vertex3D) ||
+                file.size() < sizeof(smesh::Header) + uint64_t(header->sectionCount) * sizeof(smesh::Section)
+            ) return;
+
+            const auto* sections = reinterpret_cast<const smesh::Section*>(file.data() + sizeof(smesh::Header));
+            for(uint32_t i = 0; i < header->sectionCount; i++){
+                const smesh::Section& section = sections[i];
+                if(
+                    section.byteOffset % smesh::SECTION_ALIGNMENT != 0 ||
+                    section.byteOffset > file.size() ||
+                    section.byteLength > file.size() - section.byteOffset
+                ) return;
+            }
+
+            _header = header;
+
+            uint64_t vertexBytes = 0, indexBytes = 0;
+            _vertices = static_cast<const Vertex3D*>(section(smesh::SectionType::VERTICES, &_vertexCount, &vertexBytes));
+            _indices  = static_cast<const uint32_t*>(section(smesh::SectionType::INDICES,  &_indexCount,  &indexBytes));
+            if(
+                !_vertices || vertexBytes != uint64_t(_vertexCount) * sizeof(Vertex3D) ||
+                !_indices  || indexBytes  != uint64_t(_indexCount)  * sizeof(uint32_t)
+            ){
+                *this = MeshFile();
+                return;
+            }
+
+            uint64_t meshletBytes = 0, boundsBytes = 0;
+            uint32_t boundsCount = 0;
+            _meshlets = static_cast<const Meshlet*>(section(smesh::SectionType::MESHLETS, &_meshletCount, &meshletBytes));
+            _meshletBounds = static_cast<const MeshletBounds*>(section(smesh::SectionType::MESHLET_BOUNDS, &boundsCount, &boundsBytes));
+            if(
+                !_meshlets || !_meshletBounds || boundsCount != _meshletCount ||
+                meshletBytes != uint64_t(_meshletCount) * sizeof(Meshlet) ||
+                boundsBytes  != uint64_t(_meshletCount) * sizeof(MeshletBounds)
+            ){
+                _meshlets = nullptr;
+                _meshletBounds = nullptr;
+                _meshletCount = 0;
+            }
+        }
+        MeshFile::MeshFile(MeshFile&& m){
+            *this = std::move(m);
+        }
+
+        MeshFile& MeshFile::operator = (MeshFile&& m){
+            if(this == &m) return *this;
+            file = std::move(m.file);
+            _header = std::exchange(m._header, nullptr);
+            _vertices = std::exchange(m._vertices, nullptr);
+            _indices = std::exchange(m._indices, nullptr);
+            _vertexCount = std::exchange(m._vertexCount, 0);
+            _indexCount = std::exchange(m._indexCount, 0);
+            _meshlets = std::exchange(m._meshlets, nullptr);
+            _meshletBounds = std::exchange(m._meshletBounds, nullptr);
+            _meshletCount = std::exchange(m._meshletCount, 0);
+            return *this;
+        }
+
+        MeshFile MeshFile::loadObj(const char* objPath){
+            std::string cache = smesh::cachePath(objPath);
+
+            smesh::SourceStamp stamp = {};
+            bool hashed = false;
+            if(!smesh::stampFile(objPath, stamp, false)) return MeshFile();
+
+            MeshFile mesh(cache.c_str());
+            if(mesh.valid() && mesh.header().sourceSize == stamp.size){
+                if(mesh.header().sourceModifiedTime == stamp.modifiedTime) return mesh;
+
+                // Touched but possibly unchanged, refresh the stored time if the contents match
+                if(!smesh::stampFile(objPath, stamp, true)) return MeshFile();
+                hashed = true;
+                if(mesh.header().sourceHash == stamp.hash){
+                    mesh = MeshFile();
+                    std::fstream fp(cache, std::ios::binary | std::ios::in | std::ios::out);
+                    fp.seekp(offsetof(smesh::Header, sourceModifiedTime));
+                    fp.write(reinterpret_cast<const char*>(&stamp.modifiedTime), sizeof(stamp.modifiedTime));
+                    fp.close();
+                    return MeshFile(cache.c_str());
+                }
+            }
+            // The mapping must be released before the cache is replaced
+            mesh = MeshFile();
+
+            if(!hashed && !smesh::stampFile(objPath, stamp, true)) return MeshFile();
+
+            ModelLoader loader(objPath);
+            MeshletMesh meshlets = buildMeshlets(
+                loader.vertices.data(), loader.vertices.size(),
+                loader.indices.data(),  loader.indices.size()
+            );
+            if(!smesh::write(cache.c_str(), stamp, loader.vertices, loader.indices, &meshlets)){
+                std::cerr << SHARD_FUNC << ": Failed to write " << cache << "\n";
+                return MeshFile();
+            }
+            return MeshFile(cache.c_str());
+        }
+
+        const void* MeshFile::section(
+            smesh::SectionType type, uint32_t* elementCount, uint64_t* byteLength
+        ) const {
+            if(!_header) return nullptr;
+
+            const auto* sections = reinterpret_cast<const smesh::Section*>(file.data() + sizeof(smesh::Header));
+            for(uint32_t i = 0; i < _header->sectionCount; i++){
+                if(sections[i].type != type) continue;
+                if(elementCount) *elementCount = sections[i].elementCount;
+                if(byteLength) *byteLength = sections[i].byteLength;
+                return file.data() + sections[i].byteOffset;
+            }
+            return nullptr;
+        }
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include <shard/gfx/meshLod.hpp>
+#include <shard/gfx/meshOptimizer.hpp>
+
+namespace shard{
+    namespace gfx{
+        // Levels that shrink less than this aren't worth an extra range
+        static constexpr float MIN_LEVEL_REDUCTION = 0.9f;
+
+        std::vector<MeshLod> buildLodChain(
+            std::vector<uint32_t>& indices, const std::vector<Vertex3D>& vertices,
+            uint32_t maxLevels, float reduction, float maxError
+        ){
+            assert(reduction > 0.0f && reduction < 1.0f);
+
+            std::vector<MeshLod> lods;
+            if(indices.empty() || maxLevels == 0) return lods;
+            lods.push_back({0, static_cast<uint32_t>(indices.size()), 0.0f});
+
+            std::vector<uint32_t> level;
+            std::vector<uint32_t> ordered;
+            while(lods.size() < maxLevels){
+                const MeshLod& previous = lods.back();
+                size_t target = size_t(float(previous.indexCount / 3) * reduction) * 3;
+                if(target < 3) break;
+
+                level.resize(previous.indexCount);
+                float levelError = 0.0f;
+                size_t count = meshopt::simplify(
+                    level.data(), indices.data() + previous.firstIndex, previous.indexCount,
+                    vertices.data(), vertices.size(),
+                    target, maxError - previous.error, &levelError
+                );
+                if(count == 0 || float(count) > float(previous.indexCount) * MIN_LEVEL_REDUCTION) break;
+
+                ordered.resize(count);
+                meshopt::optimizeVertexCache(ordered.data(), level.data(), count, vertices.size());
+
+                // Errors of successive simplifications add up at worst
+                MeshLod lod = {
+                    static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(count),
+                    previous.error + levelError
+                };
+                indices.insert(indices.end(), ordered.begin(), ordered.end());
+                lods.push_back(lod);
+            }
+            return lods;
+        }
+
+        uint32_t selectLod(
+            const MeshLod* lods, uint32_t lodCount,
+            float distance, float pixelScale,
+            float maxPixelError, float scale
+        ){
+            if(lodCount == 0 || distance <= 0.0f) return 0;
+
+            // Errors increase with the level, take the last one that still fits
+            float allowed = maxPixelError * distance / (pixelScale * scale);
+            uint32_t level = 0;
+            for(uint32_t i = 1; i < lodCount; i++){
+                if(lods[i].error > allowed) break;
+                level = i;
+            }
+            return level;
+        }
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,550 @@
+#include <shard/gfx/meshOptimizer.hpp>
+
+#include <cmath>
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+#include <unordered_set>
+#include <unordered_map>
+
+namespace shard{
+    namespace gfx{
+        namespace meshopt{
+            // Forsyth's scoring constants, the simulated cache is LRU
+            static constexpr uint32_t FORSYTH_CACHE_SIZE = 32;
+            static constexpr uint32_t FORSYTH_MAX_VALENCE = 32;
+            static constexpr float CACHE_DECAY_POWER = 1.5f;
+            static constexpr float LAST_TRI_SCORE = 0.75f;
+            static constexpr float VALENCE_BOOST_SCALE = 2.0f;
+            static constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+            struct ScoreTable{
+                float cache[FORSYTH_CACHE_SIZE + 1];   // indexed by cache position + 1
+                float valence[FORSYTH_MAX_VALENCE + 1];
+
+                ScoreTable(){
+                    cache[0] = 0.0f;
+                    for(uint32_t i = 0; i < FORSYTH_CACHE_SIZE; i++){
+                        if(i < 3){
+                            cache[i + 1] = LAST_TRI_SCORE;
+                        } else{
+                            float scaler = 1.0f / float(FORSYTH_CACHE_SIZE - 3);
+                            cache[i + 1] = std::pow(1.0f - float(i - 3) * scaler, CACHE_DECAY_POWER);
+                        }
+                    }
+                    valence[0] = 0.0f;
+                    for(uint32_t i = 1; i <= FORSYTH_MAX_VALENCE; i++){
+                        valence[i] = VALENCE_BOOST_SCALE * std::pow(float(i), -VALENCE_BOOST_POWER);
+                    }
+                }
+
+                float score(int32_t cachePosition, uint32_t liveTriangles) const {
+                    if(liveTriangles == 0) return -1.0f;
+                    return cache[cachePosition + 1] + valence[std::min(liveTriangles, FORSYTH_MAX_VALENCE)];
+                }
+            };
+
+            VertexCacheStats analyzeVertexCache(
+                const uint32_t* indices, size_t indexCount, size_t vertexCount,
+                uint32_t cacheSize
+            ){
+                VertexCacheStats stats = {};
+                if(indexCount == 0) return stats;
+
+                // Timestamps make the FIFO test O(1): a vertex is cached if it was
+                // inserted less than cacheSize insertions ago
+                std::vector<uint32_t> insertedAt(vertexCount, 0);
+                std::vector<bool> referenced(vertexCount, false);
+                uint32_t timestamp = cacheSize + 1;
+                size_t uniqueCount = 0;
+                for(size_t i = 0; i < indexCount; i++){
+                    uint32_t v = indices[i];
+                    assert(v < vertexCount);
+                    if(timestamp - insertedAt[v] > cacheSize){
+                        insertedAt[v] = timestamp++;
+                        stats.transformedVertices++;
+                    }
+                    if(!referenced[v]){
+                        referenced[v] = true;
+                        uniqueCount++;
+                    }
+                }
+
+                stats.acmr = float(stats.transformedVertices) / float(indexCount / 3);
+                stats.atvr = float(stats.transformedVertices) / float(uniqueCount);
+                return stats;
+            }
+
+            void optimizeVertexCache(
+                uint32_t* dst, const uint32_t* indices, size_t indexCount, size_t vertexCount
+            ){
+                assert(indexCount % 3 == 0);
+                assert(dst != indices && "optimizeVertexCache can't run in place");
+                size_t triangleCount = indexCount / 3;
+                if(triangleCount == 0) return;
+
+                static const ScoreTable table;
+
+                // Vertex to triangle adjacency, live triangles are kept at the front of
+                // each vertex's range
+                std::vector<uint32_t> liveTriangles(vertexCount, 0);
+                for(size_t i = 0; i < indexCount; i++) liveTriangles[indices[i]]++;
+
+                std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+                for(size_t v = 0; v < vertexCount; v++){
+                    adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+                }
+                std::vector<uint32_t> adjacency(indexCount);
+                {
+                    std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+                    for(size_t i = 0; i < indexCount; i++){
+                        adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+                    }
+                }
+
+                std::vector<int32_t> cachePosition(vertexCount, -1);
+                std::vector<float> vertexScore(vertexCount);
+                for(size_t v = 0; v < vertexCount; v++){
+                    vertexScore[v] = table.score(-1, liveTriangles[v]);
+                }
+
+                std::vector<float> triangleScore(triangleCount);
+                std::vector<bool> emitted(triangleCount, false);
+                for(size_t t = 0; t < triangleCount; t++){
+                    triangleScore[t] =
+                        vertexScore[indices[t*3 + 0]] +
+                        vertexScore[indices[t*3 + 1]] +
+                        vertexScore[indices[t*3 + 2]];
+                }
+
+                uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+                uint32_t cacheCount = 0;
+
+                uint32_t bestTriangle = static_cast<uint32_t>(
+                    std::max_element(triangleScore.begin(), triangleScore.end()) - triangleScore.begin()
+                );
+                size_t cursor = 0;
+                for(size_t output = 0; output < triangleCount; output++){
+                    if(bestTriangle == UINT32_MAX){
+                        // Nothing adjacent to the cache is left, continue in input order
+                        while(emitted[cursor]) cursor++;
+                        bestTriangle = static_cast<uint32_t>(cursor);
+                    }
+
+                    const uint32_t* triangle = indices + size_t(bestTriangle) * 3;
+                    dst[output*3 + 0] = triangle[0];
+                    dst[output*3 + 1] = triangle[1];
+                    dst[output*3 + 2] = triangle[2];
+                    emitted[bestTriangle] = true;
+
+                    // Drop the triangle from its vertices' live lists
+                    for(uint32_t k = 0; k < 3; k++){
+                        uint32_t v = triangle[k];
+                        uint32_t* begin = adjacency.data() + adjacencyOffsets[v];
+                        uint32_t* end = begin + liveTriangles[v];
+                        uint32_t* it = std::find(begin, end, bestTriangle);
+                        assert(it != end);
+                        std::swap(*it, *(end - 1));
+                        liveTriangles[v]--;
+                    }
+
+                    // Emitted vertices move to the front, the rest shift back
+                    uint32_t newCache[FORSYTH_CACHE_SIZE + 3];
+                    uint32_t newCount = 0;
+                    for(uint32_t k = 0; k < 3; k++) newCache[newCount++] = triangle[k];
+                    for(uint32_t i = 0; i < cacheCount; i++){
+                        uint32_t v = cache[i];
+                        if(v != triangle[0] && v != triangle[1] && v != triangle[2]) newCache[newCount++] = v;
+                    }
+
+                    bestTriangle = UINT32_MAX;
+                    float bestScore = -1.0f;
+                    for(uint32_t i = 0; i < newCount; i++){
+                        uint32_t v = newCache[i];
+                        int32_t position = i < FORSYTH_CACHE_SIZE ? int32_t(i) : -1;
+                        cachePosition[v] = position;
+
+                        float score = table.score(position, liveTriangles[v]);
+                        float delta = score - vertexScore[v];
+                        vertexScore[v] = score;
+
+                        const uint32_t* begin = adjacency.data() + adjacencyOffsets[v];
+                        for(uint32_t j = 0; j < liveTriangles[v]; j++){
+                            uint32_t t = begin[j];
+                            triangleScore[t] += delta;
+                            if(triangleScore[t] > bestScore){
+                                bestScore = triangleScore[t];
+                                bestTriangle = t;
+                            }
+                        }
+                    }
+
+                    cacheCount = std::min(newCount, FORSYTH_CACHE_SIZE);
+                    std::copy(newCache, newCache + cacheCount, cache);
+                }
+            }
+
+            void optimizeOverdraw(
+                uint32_t* dst, const uint32_t* indices, size_t indexCount,
+                const Vertex3D* vertices, size_t vertexCount,
+                float threshold
+            ){
+                assert(indexCount % 3 == 0);
+                assert(dst != indices && "optimizeOverdraw can't run in place");
+                size_t triangleCount = indexCount / 3;
+                if(triangleCount == 0) return;
+
+                constexpr uint32_t CACHE_SIZE = 16;
+
+                // One FIFO simulation state is shared by every pass below, bumping the
+                // timestamp by more than the cache size flushes it
+                std::vector<uint32_t> insertedAt(vertexCount, 0);
+                uint32_t timestamp = CACHE_SIZE + 1;
+                auto simulate = [&](uint32_t t){
+                    uint32_t misses = 0;
+                    for(uint32_t k = 0; k < 3; k++){
+                        uint32_t v = indices[size_t(t)*3 + k];
+                        if(timestamp - insertedAt[v] > CACHE_SIZE){
+                            insertedAt[v] = timestamp++;
+                            misses++;
+                        }
+                    }
+                    return misses;
+                };
+                auto flush = [&](){ timestamp += CACHE_SIZE + 1; };
+
+                // Hard boundaries: triangles where the simulated cache misses all three
+                // vertices, nothing is lost by reordering around them
+                std::vector<uint32_t> clusters;
+                for(uint32_t t = 0; t < triangleCount; t++){
+                    if(simulate(t) == 3 || t == 0) clusters.push_back(t);
+                }
+
+                // Soft boundaries: split a hard cluster wherever the ACMR so far is within
+                // threshold of the whole cluster's
+                std::vector<uint32_t> softClusters;
+                for(size_t c = 0; c < clusters.size(); c++){
+                    uint32_t begin = clusters[c];
+                    uint32_t end = c + 1 < clusters.size() ? clusters[c + 1] : uint32_t(triangleCount);
+
+                    flush();
+                    uint32_t clusterMisses = 0;
+                    for(uint32_t t = begin; t < end; t++) clusterMisses += simulate(t);
+                    float clusterAcmr = float(clusterMisses) / float(end - begin);
+
+                    flush();
+                    uint32_t misses = 0;
+                    uint32_t start = begin;
+                    softClusters.push_back(begin);
+                    for(uint32_t t = begin; t < end; t++){
+                        misses += simulate(t);
+                        uint32_t triangles = t - start + 1;
+                        if(t + 1 < end && float(misses) / float(triangles) <= clusterAcmr * threshold){
+                            // The next cluster may be drawn after anything, start it cold
+                            softClusters.push_back(t + 1);
+                            start = t + 1;
+                            misses = 0;
+                            flush();
+                        }
+                    }
+                }
+
+                glm::vec3 meshCenter(0.0f);
+                for(size_t i = 0; i < indexCount; i++) meshCenter += vertices[indices[i]].pos;
+                meshCenter /= float(indexCount);
+
+                // Clusters facing away from the center are drawn first, they are the most
+                // likely to occlude the rest
+                std::vector<float> sortKey(softClusters.size());
+                for(size_t c = 0; c < softClusters.size(); c++){
+                    uint32_t begin = softClusters[c];
+                    uint32_t end = c + 1 < softClusters.size() ? softClusters[c + 1] : uint32_t(triangleCount);
+
+                    glm::vec3 centroid(0.0f);
+                    glm::vec3 normal(0.0f);
+                    float area = 0.0f;
+                    for(uint32_t t = begin; t < end; t++){
+                        const glm::vec3& p0 = vertices[indices[size_t(t)*3 + 0]].pos;
+                        const glm::vec3& p1 = vertices[indices[size_t(t)*3 + 1]].pos;
+                        const glm::vec3& p2 = vertices[indices[size_t(t)*3 + 2]].pos;
+                        glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+                        float a = glm::length(n);
+                        centroid += (p0 + p1 + p2) * (a / 3.0f);
+                        normal += n;
+                        area += a;
+                    }
+                    if(area > 0.0f) centroid /= area;
+                    float normalLength = glm::length(normal);
+                    sortKey[c] = normalLength > 0.0f ? glm::dot(centroid - meshCenter, normal / normalLength) : 0.0f;
+                }
+
+                std::vector<uint32_t> order(softClusters.size());
+                std::iota(order.begin(), order.end(), 0u);
+                std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b){
+                    return sortKey[a] > sortKey[b];
+                });
+
+                size_t output = 0;
+                for(uint32_t c : order){
+                    uint32_t begin = softClusters[c];
+                    uint32_t end = c + 1 < softClusters.size() ? softClusters[c + 1] : uint32_t(triangleCount);
+                    std::copy(indices + size_t(begin) * 3, indices + size_t(end) * 3, dst + output);
+                    output += size_t(end - begin) * 3;
+                }
+                assert(output == indexCount);
+            }
+
+            size_t optimizeVertexFetch(std::vector<Vertex3D>& vertices, std::vector<uint32_t>& indices){
+                std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+                std::vector<Vertex3D> fetchOrdered;
+                fetchOrdered.reserve(vertices.size());
+
+                for(auto& index : indices){
+                    if(remap[index] == UINT32_MAX){
+                        remap[index] = static_cast<uint32_t>(fetchOrdered.size());
+                        fetchOrdered.push_back(vertices[index]);
+                    }
+                    index = remap[index];
+                }
+
+                vertices = std::move(fetchOrdered);
+                return vertices.size();
+            }
+
+            // Symmetric 4x4 plane quadric, error(p) is the sum of squared plane distances
+            struct Quadric{
+                double a2 = 0, b2 = 0, c2 = 0, d2 = 0;
+                double ab = 0, ac = 0, ad = 0, bc = 0, bd = 0, cd = 0;
+
+                void addPlane(const glm::vec3& n, float d){
+                    a2 += n.x*n.x; b2 += n.y*n.y; c2 += n.z*n.z; d2 += double(d)*d;
+                    ab += n.x*n.y; ac += n.x*n.z; ad += n.x*d;
+                    bc += n.y*n.z; bd += n.y*d;   cd += n.z*d;
+                }
+                void operator += (const Quadric& q){
+                    a2 += q.a2; b2 += q.b2; c2 += q.c2; d2 += q.d2;
+                    ab += q.ab; ac += q.ac; ad += q.ad; bc += q.bc; bd += q.bd; cd += q.cd;
+                }
+                double error(const glm::vec3& p) const {
+                    double x = p.x, y = p.y, z = p.z;
+                    double e = a2*x*x + b2*y*y + c2*z*z + d2 +
+                               2.0*(ab*x*y + ac*x*z + ad*x + bc*y*z + bd*y + cd*z);
+                    return std::max(e, 0.0);
+                }
+            };
+
+            size_t simplify(
+                uint32_t* dst, const uint32_t* indices, size_t indexCount,
+                const Vertex3D* vertices, size_t vertexCount,
+                size_t targetIndexCount, float targetError, float* resultError
+            ){
+                assert(indexCount % 3 == 0);
+
+                std::vector<uint32_t> work(indices, indices + indexCount);
+                if(resultError) *resultError = 0.0f;
+
+                // Vertices that share a position with another vertex are UV/normal seams,
+                // vertices on open edges are borders. Neither moves, so the output never
+                // cracks or needs new vertices.
+                auto positionKey = [&](uint32_t v){
+                    uint32_t bits[3];
+                    memcpy(bits, &vertices[v].pos, sizeof(bits));
+                    return (uint64_t(bits[0]) * 73856093u) ^ (uint64_t(bits[1]) * 19349663u) ^
+                           (uint64_t(bits[2]) * 83492791u) ^ (uint64_t(bits[2]) << 32);
+                };
+                std::unordered_multimap<uint64_t, uint32_t> positions;
+                positions.reserve(vertexCount);
+                std::vector<uint32_t> positionOf(vertexCount);
+                std::vector<uint32_t> wedges(vertexCount, 0);
+                for(uint32_t v = 0; v < vertexCount; v++){
+                    positionOf[v] = v;
+                    auto range = positions.equal_range(positionKey(v));
+                    for(auto it = range.first; it != range.second; ++it){
+                        if(vertices[it->second].pos == vertices[v].pos){
+                            positionOf[v] = it->second;
+                            break;
+                        }
+                    }
+                    if(positionOf[v] == v) positions.emplace(positionKey(v), v);
+                    wedges[positionOf[v]]++;
+                }
+
+                std::vector<uint8_t> locked(vertexCount, 0);
+                for(uint32_t v = 0; v < vertexCount; v++){
+                    if(wedges[positionOf[v]] > 1) locked[v] = 1;
+                }
+                {
+                    std::unordered_set<uint64_t> directedEdges;
+                    directedEdges.reserve(indexCount);
+                    auto edgeKey = [&](uint32_t a, uint32_t b){
+                        return (uint64_t(positionOf[a]) << 32) | positionOf[b];
+                    };
+                    for(size_t i = 0; i < indexCount; i += 3){
+                        for(int e = 0; e < 3; e++){
+                            directedEdges.insert(edgeKey(work[i + e], work[i + (e + 1) % 3]));
+                        }
+                    }
+                    for(size_t i = 0; i < indexCount; i += 3){
+                        for(int e = 0; e < 3; e++){
+                            uint32_t a = work[i + e], b = work[i + (e + 1) % 3];
+                            if(!directedEdges.count(edgeKey(b, a))) locked[a] = locked[b] = 1;
+                        }
+                    }
+                }
+
+                std::vector<Quadric> quadrics(vertexCount);
+                for(size_t i = 0; i < indexCount; i += 3){
+                    const glm::vec3& p0 = vertices[work[i + 0]].pos;
+                    const glm::vec3& p1 = vertices[work[i + 1]].pos;
+                    const glm::vec3& p2 = vertices[work[i + 2]].pos;
+                    glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+                    float area = glm::length(normal);
+                    if(area <= 0.0f) continue;
+                    normal /= area;
+                    Quadric q;
+                    q.addPlane(normal, -glm::dot(normal, p0));
+                    for(int c = 0; c < 3; c++) quadrics[work[i + c]] += q;
+                }
+
+                struct Collapse{
+                    uint32_t source;
+                    uint32_t target;
+                    double   cost;
+                };
+                std::vector<Collapse> collapses;
+                std::vector<uint32_t> triangleOffsets(vertexCount + 1);
+                std::vector<uint32_t> vertexTriangles;
+                std::vector<uint32_t> remap(vertexCount);
+                std::vector<uint8_t> touched(vertexCount);
+
+                double maxCost = 0.0;
+                double maxAllowed = double(targetError) * double(targetError);
+
+                while(work.size() > targetIndexCount){
+                    size_t triangleCount = work.size() / 3;
+
+                    std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+                    for(uint32_t index : work) triangleOffsets[index + 1]++;
+                    for(size_t v = 0; v < vertexCount; v++) triangleOffsets[v + 1] += triangleOffsets[v];
+                    vertexTriangles.resize(work.size());
+                    {
+                        std::vector<uint32_t> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+                        for(size_t i = 0; i < work.size(); i++){
+                            vertexTriangles[fill[work[i]]++] = static_cast<uint32_t>(i / 3);
+                        }
+                    }
+
+                    collapses.clear();
+                    for(size_t i = 0; i < work.size(); i += 3){
+                        for(int e = 0; e < 3; e++){
+                            uint32_t a = work[i + e], b = work[i + (e + 1) % 3];
+                            // Sources move, so they need a single wedge, targets must have one
+                            // too so the corner keeps its attributes
+                            if(!locked[a] && wedges[positionOf[b]] == 1)
+                                collapses.push_back({a, b, quadrics[a].error(vertices[b].pos)});
+                            if(!locked[b] && wedges[positionOf[a]] == 1)
+                                collapses.push_back({b, a, quadrics[b].error(vertices[a].pos)});
+                        }
+                    }
+                    std::sort(collapses.begin(), collapses.end(), [](const Collapse& l, const Collapse& r){
+                        return l.cost < r.cost;
+                    });
+
+                    for(uint32_t v = 0; v < vertexCount; v++) remap[v] = v;
+                    std::fill(touched.begin(), touched.end(), 0);
+
+                    // An interior collapse removes two triangles
+                    size_t removable = (triangleCount - targetIndexCount / 3 + 1) / 2;
+                    size_t performed = 0;
+                    for(const auto& collapse : collapses){
+                        if(performed >= removable || collapse.cost > maxAllowed) break;
+                        if(touched[collapse.source] || touched[collapse.target]) continue;
+
+                        // Reject collapses that flip or degenerate a remaining triangle
+                        bool flips = false;
+                        const glm::vec3& target = vertices[collapse.target].pos;
+                        for(uint32_t t = triangleOffsets[collapse.source]; t < triangleOffsets[collapse.source + 1]; t++){
+                            const uint32_t* tri = &work[size_t(vertexTriangles[t]) * 3];
+                            if(tri[0] == collapse.target || tri[1] == collapse.target || tri[2] == collapse.target)
+                                continue;
+                            glm::vec3 p[3], moved[3];
+                            for(int c = 0; c < 3; c++){
+                                p[c] = vertices[tri[c]].pos;
+                                moved[c] = tri[c] == collapse.source ? target : p[c];
+                            }
+                            glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                            glm::vec3 after  = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+                            if(glm::dot(before, after) <= 0.0f){
+                                flips = true;
+                                break;
+                            }
+                        }
+                        if(flips) continue;
+
+                        remap[collapse.source] = collapse.target;
+                        quadrics[collapse.target] += quadrics[collapse.source];
+                        maxCost = std::max(maxCost, collapse.cost);
+                        performed++;
+
+                        // Neighbours keep their positions for the rest of the pass, so the
+                        // flip tests above stay valid
+                        for(uint32_t t = triangleOffsets[collapse.source]; t < triangleOffsets[collapse.source + 1]; t++){
+                            const uint32_t* tri = &work[size_t(vertexTriangles[t]) * 3];
+                            touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+                        }
+                    }
+                    if(performed == 0) break;
+
+                    size_t output = 0;
+                    for(size_t i = 0; i < work.size(); i += 3){
+                        uint32_t a = remap[work[i]], b = remap[work[i + 1]], c = remap[work[i + 2]];
+                        if(a == b || b == c || a == c) continue;
+                        work[output++] = a;
+                        work[output++] = b;
+                        work[output++] = c;
+                    }
+                    work.resize(output);
+                }
+
+                if(resultError) *resultError = static_cast<float>(std::sqrt(maxCost));
+                std::copy(work.begin(), work.end(), dst);
+                return work.size();
+            }
+
+            OptimizeStats optimizeMesh(
+                std::vector<Vertex3D>& vertices, std::vector<uint32_t>& indices,
+                float overdrawThreshold
+            ){
+                OptimizeStats stats = {};
+                stats.before = analyzeVertexCache(indices.data(), indices.size(), vertices.size());
+
+                std::vector<uint32_t> scratch(indices.size());
+                optimizeVertexCache(scratch.data(), indices.data(), indices.size(), vertices.size());
+                optimizeOverdraw(
+                    indices.data(), scratch.data(), scratch.size(),
+                    vertices.data(), vertices.size(),
+                    overdrawThreshold
+                );
+                optimizeVertexFetch(vertices, indices);
+
+                stats.after = analyzeVertexCache(indices.data(), indices.size(), vertices.size());
+                return stats;
+            }
+        } // namespace meshopt
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include <shard/gfx/meshlet.hpp>
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace shard{
+    namespace gfx{
+        MeshletMesh buildMeshlets(
+            const Vertex3D* vertices, size_t vertexCount,
+            const uint32_t* indices,  size_t indexCount,
+            uint32_t maxVertices, uint32_t maxTriangles
+        ){
+            assert(indexCount % 3 == 0);
+            assert(maxVertices >= 3 && maxVertices <= 256 && "Local vertices are stored as bytes!");
+            assert(maxTriangles >= 1);
+
+            constexpr uint32_t UNUSED = std::numeric_limits<uint32_t>::max();
+
+            MeshletMesh mesh;
+            size_t triangleCount = indexCount / 3;
+            size_t meshletEstimate = triangleCount / maxTriangles + 1;
+            mesh.meshlets.reserve(meshletEstimate);
+            mesh.vertices.reserve(meshletEstimate * maxVertices);
+            mesh.triangles.reserve(indexCount);
+
+            // Mesh vertex -> local vertex of the meshlet being built
+            std::vector<uint32_t> localIndex(vertexCount, UNUSED);
+            Meshlet current = {};
+
+            auto flush = [&](){
+                if(current.triangleCount == 0) return;
+                for(uint32_t i = 0; i < current.vertexCount; i++){
+                    localIndex[mesh.vertices[current.vertexOffset + i]] = UNUSED;
+                }
+                mesh.meshlets.push_back(current);
+                current.vertexOffset += current.vertexCount;
+                current.triangleOffset += current.triangleCount;
+                current.vertexCount = 0;
+                current.triangleCount = 0;
+            };
+
+            for(size_t t = 0; t < triangleCount; t++){
+                const uint32_t* tri = indices + t*3;
+                uint32_t a = tri[0], b = tri[1], c = tri[2];
+                assert(a < vertexCount && b < vertexCount && c < vertexCount);
+
+                uint32_t newVertices = (localIndex[a] == UNUSED) +
+                                       (localIndex[b] == UNUSED && b != a) +
+                                       (localIndex[c] == UNUSED && c != a && c != b);
+                if(
+                    current.vertexCount + newVertices > maxVertices ||
+                    current.triangleCount + 1 > maxTriangles
+                ) flush();
+
+                for(uint32_t v : {a, b, c}){
+                    if(localIndex[v] == UNUSED){
+                        localIndex[v] = current.vertexCount++;
+                        mesh.vertices.push_back(v);
+                    }
+                    mesh.triangles.push_back(static_cast<uint8_t>(localIndex[v]));
+                }
+                current.triangleCount++;
+            }
+            flush();
+
+            mesh.bounds.resize(mesh.meshlets.size());
+            for(size_t i = 0; i < mesh.meshlets.size(); i++){
+                mesh.bounds[i] = computeMeshletBounds(mesh, mesh.meshlets[i], vertices);
+            }
+            return mesh;
+        }
+
+        MeshletBounds computeMeshletBounds(
+            const MeshletMesh& mesh, const Meshlet& meshlet, const Vertex3D* vertices
+        ){
+            MeshletBounds bounds = {};
+            if(meshlet.vertexCount == 0) return bounds;
+
+            const uint32_t* meshletVertices = mesh.vertices.data() + meshlet.vertexOffset;
+            const uint8_t* meshletTriangles = mesh.triangles.data() + size_t(meshlet.triangleOffset)*3;
+
+            // Sphere around the box center, close enough to Ritter for small clusters
+            glm::vec3 boxMin(INFINITY), boxMax(-INFINITY);
+            for(uint32_t i = 0; i < meshlet.vertexCount; i++){
+                boxMin = glm::min(boxMin, vertices[meshletVertices[i]].pos);
+                boxMax = glm::max(boxMax, vertices[meshletVertices[i]].pos);
+            }
+            bounds.center = (boxMin + boxMax) * 0.5f;
+            for(uint32_t i = 0; i < meshlet.vertexCount; i++){
+                bounds.radius = std::max(bounds.radius, glm::length(vertices[meshletVertices[i]].pos - bounds.center));
+            }
+
+            // Normal cone over the face normals, degenerate triangles don't constrain it
+            std::vector<glm::vec3> normals;
+            std::vector<glm::vec3> corners;
+            normals.reserve(meshlet.triangleCount);
+            corners.reserve(meshlet.triangleCount);
+            glm::vec3 normalSum(0.0f);
+            for(uint32_t t = 0; t < meshlet.triangleCount; t++){
+                const glm::vec3& p0 = vertices[meshletVertices[meshletTriangles[t*3 + 0]]].pos;
+                const glm::vec3& p1 = vertices[meshletVertices[meshletTriangles[t*3 + 1]]].pos;
+                const glm::vec3& p2 = vertices[meshletVertices[meshletTriangles[t*3 + 2]]].pos;
+                glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+                float area = glm::length(normal);
+                if(area <= 0.0f) continue;
+                normals.push_back(normal / area);
+                corners.push_back(p0);
+                normalSum += normals.back();
+            }
+
+            bounds.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+            bounds.coneApex = bounds.center;
+            bounds.coneCutoff = 2.0f;
+
+            float axisLength = glm::length(normalSum);
+            if(normals.empty() || axisLength <= 0.0f) return bounds;
+            glm::vec3 axis = normalSum / axisLength;
+
+            float minDot = 1.0f;
+            for(const auto& normal : normals) minDot = std::min(minDot, glm::dot(axis, normal));
+            // Past ~84 degrees the cone almost never culls, don't pay for the test
+            if(minDot <= 0.1f) return bounds;
+
+            // Move the apex back until every triangle plane is in front of it
+            float maxT = 0.0f;
+            for(size_t i = 0; i < normals.size(); i++){
+                float dc = glm::dot(bounds.center - corners[i], normals[i]);
+                float dn = glm::dot(axis, normals[i]);
+                maxT = std::max(maxT, dc / dn);
+            }
+
+            bounds.coneAxis = axis;
+            bounds.coneApex = bounds.center - axis * maxT;
+            bounds.coneCutoff = std::sqrt(1.0f - minDot*minDot);
+            return bounds;
+        }
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
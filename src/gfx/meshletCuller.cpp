@@ -0,0 +1,216 @@
+#include <shard/gfx/meshletCuller.hpp>
+
+namespace shard{
+    namespace gfx{
+        MeshletCuller::MeshletCuller(
+            Graphics& _gfx,
+            const Meshlet* meshlets, const MeshletBounds* bounds, uint32_t meshletCount
+        ):
+            gfx{_gfx},
+            _meshletCount{meshletCount},
+            meshletBuffer{_gfx.device()},
+            boundsBuffer{_gfx.device()},
+            drawBuffer{
+                _gfx.device(), meshletCount * sizeof(VkDrawIndexedIndirectCommand),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT  |
+                VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VMA_MEMORY_USAGE_GPU_ONLY, 0,
+                VK_SHARING_MODE_EXCLUSIVE
+            },
+            countBuffer{
+                _gfx.device(), sizeof(uint32_t),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT  |
+                VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VMA_MEMORY_USAGE_GPU_ONLY, 0,
+                VK_SHARING_MODE_EXCLUSIVE
+            },
+            setLayout{
+                DescriptorSetLayout::Builder(_gfx.device())
+                    .addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+                    .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+                    .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+                    .addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+                    .build()
+            },
+            descriptorPool{
+                DescriptorPool::Builder(_gfx.device())
+                    .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4)
+                    .setMaxSets(1)
+                    .build()
+            },
+            pipeline{_gfx.device()}
+        {
+            assert(meshlets && bounds && meshletCount > 0);
+            Device& device = gfx.device();
+
+            meshletBuffer = gfx.createStorageBuffer_GPUonly(
+                meshletCount * sizeof(Meshlet), VK_SHARING_MODE_EXCLUSIVE, meshlets
+            );
+            boundsBuffer = gfx.createStorageBuffer_GPUonly(
+                meshletCount * sizeof(MeshletBounds), VK_SHARING_MODE_EXCLUSIVE, bounds
+            );
+
+            VkDescriptorBufferInfo infos[] = {
+                meshletBuffer.descriptorInfo(),
+                boundsBuffer.descriptorInfo(),
+                drawBuffer.descriptorInfo(),
+                countBuffer.descriptorInfo()
+            };
+            DescriptorWriter(setLayout, descriptorPool)
+                .writeBuffer(0, &infos[0])
+                .writeBuffer(1, &infos[1])
+                .writeBuffer(2, &infos[2])
+                .writeBuffer(3, &infos[3])
+                .build(descriptorSet);
+
+            VkPushConstantRange range = {};
+            range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+            range.offset = 0;
+            range.size = sizeof(CullParams);
+
+            VkDescriptorSetLayout rawLayout = setLayout.layout();
+
+            VkPipelineLayoutCreateInfo layoutInfo = {};
+            layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+            layoutInfo.setLayoutCount = 1;
+            layoutInfo.pSetLayouts = &rawLayout;
+            layoutInfo.pushConstantRangeCount = 1;
+            layoutInfo.pPushConstantRanges = &range;
+            shard_abort_ifnot(
+                vkCreatePipelineLayout(device.device(), &layoutInfo, nullptr, &pipelineLayout)
+                == VK_SUCCESS
+            );
+
+            pipeline = Compute(device, pipelineLayout, "shaders/meshlet/cull.comp.spv");
+        }
+        MeshletCuller::MeshletCuller(Graphics& _gfx, const MeshletMesh& mesh):
+            MeshletCuller(
+                _gfx,
+                mesh.meshlets.data(), mesh.bounds.data(),
+                static_cast<uint32_t>(mesh.meshlets.size())
+            )
+        {}
+        MeshletCuller::MeshletCuller(Graphics& _gfx, const MeshFile& mesh):
+            MeshletCuller(_gfx, mesh.meshlets(), mesh.meshletBounds(), mesh.meshletCount())
+        {}
+        MeshletCuller::~MeshletCuller(){
+            VkDevice vkDevice = gfx.device().device();
+            VkPipelineLayout layout = pipelineLayout;
+            gfx.device().deferDestroy([vkDevice, layout](){
+                vkDestroyPipelineLayout(vkDevice, layout, nullptr);
+            });
+        }
+
+        void MeshletCuller::cull(
+            VkCommandBuffer cmd,
+            const glm::mat4& modelViewProj, const glm::vec3& cameraPosition
+        ){
+            // The previous frame's draws may still read the commands
+            VkMemoryBarrier barrier = {};
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            vkCmdPipelineBarrier(
+                cmd,
+                VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                0,
+                1, &barrier,
+                0, nullptr,
+                0, nullptr
+            );
+
+            vkCmdFillBuffer(cmd, countBuffer.buffer(), 0, VK_WHOLE_SIZE, 0);
+            // Without a count buffer the unused commands must draw nothing
+            if(!gfx.device().drawIndirectCountSupported())
+                vkCmdFillBuffer(cmd, drawBuffer.buffer(), 0, VK_WHOLE_SIZE, 0);
+
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            vkCmdPipelineBarrier(
+                cmd,
+                VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                0,
+                1, &barrier,
+                0, nullptr,
+                0, nullptr
+            );
+
+            // Gribb/Hartmann plane extraction, depth is zero to one
+            const glm::mat4& m = modelViewProj;
+            glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+            glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+            glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+            glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+            CullParams params = {};
+            params.planes[0] = row3 + row0;
+            params.planes[1] = row3 - row0;
+            params.planes[2] = row3 + row1;
+            params.planes[3] = row3 - row1;
+            params.planes[4] = row2;
+            params.planes[5] = row3 - row2;
+            for(auto& plane : params.planes){
+                plane /= glm::length(glm::vec3(plane));
+            }
+            params.cameraPosition = cameraPosition;
+            params.meshletCount = _meshletCount;
+
+            pipeline.bind(cmd);
+            vkCmdBindDescriptorSets(
+                cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+                pipelineLayout, 0, 1, &descriptorSet, 0, nullptr
+            );
+            vkCmdPushConstants(
+                cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT,
+                0, sizeof(params), &params
+            );
+            pipeline.dispatch(cmd, (_meshletCount + 63) / 64, 1);
+
+            barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+            vkCmdPipelineBarrier(
+                cmd,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                0,
+                1, &barrier,
+                0, nullptr,
+                0, nullptr
+            );
+        }
+        void MeshletCuller::draw(VkCommandBuffer cmd){
+            constexpr uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+            Device& device = gfx.device();
+
+            if(device.drawIndirectCountSupported()){
+                vkCmdDrawIndexedIndirectCount(
+                    cmd, drawBuffer.buffer(), 0,
+                    countBuffer.buffer(), 0,
+                    _meshletCount, stride
+                );
+            } else if(device.multiDrawIndirectSupported()){
+                vkCmdDrawIndexedIndirect(cmd, drawBuffer.buffer(), 0, _meshletCount, stride);
+            } else{
+                for(uint32_t i = 0; i < _meshletCount; i++){
+                    vkCmdDrawIndexedIndirect(cmd, drawBuffer.buffer(), VkDeviceSize(i) * stride, 1, stride);
+                }
+            }
+        }
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
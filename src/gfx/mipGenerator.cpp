@@ -0,0 +1,331 @@
+#include <shard/gfx/mipGenerator.hpp>
+
+#include <array>
+#include <memory>
+#include <algorithm>
+
+namespace shard{
+    namespace gfx{
+        namespace{
+            VkPipelineLayout createPipelineLayout(
+                Device& device, DescriptorSetLayout& setLayout, uint32_t pushConstantSize
+            ){
+                VkPushConstantRange range = {};
+                range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+                range.offset = 0;
+                range.size = pushConstantSize;
+
+                VkDescriptorSetLayout rawLayout = setLayout.layout();
+
+                VkPipelineLayoutCreateInfo createInfo = {};
+                createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+                createInfo.setLayoutCount = 1;
+                createInfo.pSetLayouts = &rawLayout;
+                createInfo.pushConstantRangeCount = 1;
+                createInfo.pPushConstantRanges = &range;
+
+                VkPipelineLayout layout = VK_NULL_HANDLE;
+                shard_abort_ifnot(
+                    vkCreatePipelineLayout(device.device(), &createInfo, nullptr, &layout)
+                    == VK_SUCCESS
+                );
+                return layout;
+            }
+
+            void computeBarrier(VkCommandBuffer commandBuffer){
+                VkMemoryBarrier barrier = {};
+                barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+                barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT  |
+                                        VK_ACCESS_SHADER_WRITE_BIT |
+                                        VK_ACCESS_TRANSFER_WRITE_BIT;
+                vkCmdPipelineBarrier(
+                    commandBuffer,
+                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                    0,
+                    1, &barrier,
+                    0, nullptr,
+                    0, nullptr
+                );
+            }
+        }
+
+        MipGenerator::MipGenerator(Device& _device):
+            device{_device},
+            spdSetLayout{
+                DescriptorSetLayout::Builder(_device)
+                    .addBinding(
+                        0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                        VK_SHADER_STAGE_COMPUTE_BIT, MAX_LEVELS_PER_DISPATCH + 1
+                    )
+                    .addBinding(
+                        1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                        VK_SHADER_STAGE_COMPUTE_BIT
+                    ).build()
+            },
+            kaiserSetLayout{
+                DescriptorSetLayout::Builder(_device)
+                    .addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+                    .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+                    .build()
+            },
+            spd{_device},
+            kaiser{_device},
+            counter{
+                _device, sizeof(uint32_t),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VMA_MEMORY_USAGE_GPU_ONLY, 0,
+                VK_SHARING_MODE_EXCLUSIVE
+            }
+        {
+            spdLayout = createPipelineLayout(device, spdSetLayout, sizeof(SpdParams));
+            kaiserLayout = createPipelineLayout(device, kaiserSetLayout, sizeof(KaiserParams));
+            spd = Compute(device, spdLayout, "shaders/mipgen/spd.comp.spv");
+            kaiser = Compute(device, kaiserLayout, "shaders/mipgen/kaiser.comp.spv");
+        }
+        MipGenerator::~MipGenerator(){
+            VkDevice vkDevice = device.device();
+            VkPipelineLayout layouts[] = {spdLayout, kaiserLayout};
+            device.deferDestroy([vkDevice, layouts](){
+                for(auto layout : layouts){
+                    vkDestroyPipelineLayout(vkDevice, layout, nullptr);
+                }
+            });
+        }
+
+        bool MipGenerator::supportsFormat(VkFormat format){
+            return format == VK_FORMAT_R8G8B8A8_UNORM ||
+                   format == VK_FORMAT_R8G8B8A8_SRGB;
+        }
+        VkFormat MipGenerator::storageFormat(VkFormat format){
+            if(format == VK_FORMAT_R8G8B8A8_SRGB) return VK_FORMAT_R8G8B8A8_UNORM;
+            return format;
+        }
+
+        void MipGenerator::record(VkCommandBuffer commandBuffer, Image& image, MipFilter filter){
+            assert(commandBuffer != VK_NULL_HANDLE);
+            assert(supportsFormat(image.format()) && "Unsupported mip generation format!");
+            assert(image.layout() != VK_IMAGE_LAYOUT_UNDEFINED && "Level 0 holds no data!");
+
+            uint32_t levels = image.mipMapLevels();
+            VkFormat viewFormat = storageFormat(image.format());
+            bool srgb = viewFormat != image.format();
+
+            std::vector<VkImageView> views(levels);
+            for(uint32_t i = 0; i < levels; i++){
+                VkImageViewCreateInfo viewInfo = {};
+                viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+                viewInfo.image = image.image();
+                viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+                viewInfo.format = viewFormat;
+                viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                viewInfo.subresourceRange.baseMipLevel = i;
+                viewInfo.subresourceRange.levelCount = 1;
+                viewInfo.subresourceRange.baseArrayLayer = 0;
+                viewInfo.subresourceRange.layerCount = 1;
+                shard_abort_ifnot(
+                    vkCreateImageView(device.device(), &viewInfo, nullptr, &views[i])
+                    == VK_SUCCESS
+                );
+            }
+
+            VkImageMemoryBarrier barrier = {};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = image.image();
+            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            barrier.subresourceRange.baseMipLevel = 0;
+            barrier.subresourceRange.levelCount = levels;
+            barrier.subresourceRange.baseArrayLayer = 0;
+            barrier.subresourceRange.layerCount = 1;
+
+            barrier.oldLayout = image.layout();
+            barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+            barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                0,
+                0, nullptr,
+                0, nullptr,
+                1, &barrier
+            );
+
+            // Released through the deletion queue once the commands have executed
+            auto pool = std::make_shared<DescriptorPool>(
+                DescriptorPool::Builder(device)
+                    .addPoolSize(
+                        VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                        levels * (MAX_LEVELS_PER_DISPATCH + 1)
+                    )
+                    .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, levels)
+                    .setMaxSets(levels)
+                    .build()
+            );
+
+            if(levels > 1){
+                if(filter == MipFilter::BOX)
+                    recordSpd(commandBuffer, image, views, *pool, srgb);
+                else
+                    recordKaiser(commandBuffer, image, views, *pool, srgb);
+            }
+
+            barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+            barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                0,
+                0, nullptr,
+                0, nullptr,
+                1, &barrier
+            );
+            image.setLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+            VkDevice vkDevice = device.device();
+            device.deferDestroy([vkDevice, views, pool](){
+                for(auto view : views){
+                    vkDestroyImageView(vkDevice, view, nullptr);
+                }
+            });
+        }
+        void MipGenerator::generate(Image& image, MipFilter filter){
+            VkCommandBuffer commandBuffer = device.beginSingleTimeCommands();
+            record(commandBuffer, image, filter);
+            device.endSingleTimeCommands(commandBuffer);
+        }
+
+        void MipGenerator::recordSpd(
+            VkCommandBuffer commandBuffer, Image& image,
+            const std::vector<VkImageView>& views, DescriptorPool& pool, bool srgb
+        ){
+            VkExtent2D extent = image.extent();
+            uint32_t levels = image.mipMapLevels();
+
+            spd.bind(commandBuffer);
+            for(uint32_t base = 0; base + 1 < levels;){
+                uint32_t w = std::max(extent.width  >> base, 1u);
+                uint32_t h = std::max(extent.height >> base, 1u);
+
+                // The last workgroup finishes the chain from level 6 on its own, which
+                // only works while level 6 fits into a single 64x64 tile
+                uint32_t maxCount = (w > 4096 || h > 4096) ? 6 : MAX_LEVELS_PER_DISPATCH;
+                uint32_t count = std::min(levels - 1 - base, maxCount);
+
+                // Unused slots alias the last level, the shader never touches them
+                std::array<VkDescriptorImageInfo, MAX_LEVELS_PER_DISPATCH + 1> imageInfos;
+                for(uint32_t i = 0; i < imageInfos.size(); i++){
+                    imageInfos[i].sampler = VK_NULL_HANDLE;
+                    imageInfos[i].imageView = views[std::min(base + i, levels - 1)];
+                    imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+                }
+                VkDescriptorBufferInfo counterInfo = counter.descriptorInfo();
+
+                VkDescriptorSet set = VK_NULL_HANDLE;
+                DescriptorWriter(spdSetLayout, pool)
+                    .writeImages(0, imageInfos.data(), static_cast<uint32_t>(imageInfos.size()))
+                    .writeBuffer(1, &counterInfo)
+                    .build(set);
+
+                vkCmdFillBuffer(commandBuffer, counter.buffer(), 0, VK_WHOLE_SIZE, 0);
+                VkMemoryBarrier fillBarrier = {};
+                fillBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                fillBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                fillBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+                vkCmdPipelineBarrier(
+                    commandBuffer,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                    0,
+                    1, &fillBarrier,
+                    0, nullptr,
+                    0, nullptr
+                );
+
+                uint32_t groupsX = (w + 63) / 64;
+                uint32_t groupsY = (h + 63) / 64;
+
+                SpdParams params = {};
+                params.srcWidth = static_cast<int32_t>(w);
+                params.srcHeight = static_cast<int32_t>(h);
+                params.levelCount = static_cast<int32_t>(count);
+                params.srgb = srgb;
+                params.workgroupCount = groupsX * groupsY;
+
+                vkCmdBindDescriptorSets(
+                    commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                    spdLayout, 0, 1, &set, 0, nullptr
+                );
+                vkCmdPushConstants(
+                    commandBuffer, spdLayout, VK_SHADER_STAGE_COMPUTE_BIT,
+                    0, sizeof(SpdParams), &params
+                );
+                spd.dispatch(commandBuffer, groupsX, groupsY);
+                computeBarrier(commandBuffer);
+
+                base += count;
+            }
+        }
+        void MipGenerator::recordKaiser(
+            VkCommandBuffer commandBuffer, Image& image,
+            const std::vector<VkImageView>& views, DescriptorPool& pool, bool srgb
+        ){
+            VkExtent2D extent = image.extent();
+            uint32_t levels = image.mipMapLevels();
+
+            kaiser.bind(commandBuffer);
+            for(uint32_t level = 1; level < levels; level++){
+                VkDescriptorImageInfo srcInfo = {VK_NULL_HANDLE, views[level - 1], VK_IMAGE_LAYOUT_GENERAL};
+                VkDescriptorImageInfo dstInfo = {VK_NULL_HANDLE, views[level],     VK_IMAGE_LAYOUT_GENERAL};
+
+                VkDescriptorSet set = VK_NULL_HANDLE;
+                DescriptorWriter(kaiserSetLayout, pool)
+                    .writeImage(0, &srcInfo)
+                    .writeImage(1, &dstInfo)
+                    .build(set);
+
+                KaiserParams params = {};
+                params.srcWidth = static_cast<int32_t>(std::max(extent.width  >> (level - 1), 1u));
+                params.srcHeight = static_cast<int32_t>(std::max(extent.height >> (level - 1), 1u));
+                params.dstWidth = static_cast<int32_t>(std::max(extent.width  >> level, 1u));
+                params.dstHeight = static_cast<int32_t>(std::max(extent.height >> level, 1u));
+                params.srgb = srgb;
+
+                vkCmdBindDescriptorSets(
+                    commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                    kaiserLayout, 0, 1, &set, 0, nullptr
+                );
+                vkCmdPushConstants(
+                    commandBuffer, kaiserLayout, VK_SHADER_STAGE_COMPUTE_BIT,
+                    0, sizeof(KaiserParams), &params
+                );
+                kaiser.dispatch(
+                    commandBuffer,
+                    (uint32_t(params.dstWidth)  + 7) / 8,
+                    (uint32_t(params.dstHeight) + 7) / 8
+                );
+                computeBarrier(commandBuffer);
+            }
+        }
+    } // namespace gfx
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
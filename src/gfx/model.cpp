@@ -2,12 +2,30 @@
 
 namespace shard{
     namespace gfx{
+        static Buffer uploadIndices(
+            Graphics& gfx, const uint32_t* indices, size_t icount, VkIndexType type
+        ){
+            if(type == VK_INDEX_TYPE_UINT32){
+                return gfx.createIndexBuffer(
+                    icount*sizeof(uint32_t), VK_SHARING_MODE_EXCLUSIVE,
+                    indices
+                );
+            }
+            std::vector<uint16_t> indices16(icount);
+            packIndices(indices16.data(), indices, icount, type);
+            return gfx.createIndexBuffer(
+                icount*sizeof(uint16_t), VK_SHARING_MODE_EXCLUSIVE,
+                indices16.data()
+            );
+        }
+
         Model::Model(Graphics& _gfx):
             gfx{_gfx},
             vBuffer{gfx.device()},
             iBuffer{gfx.device()},
             vertCount{0},
-            _indexCount{0}
+            _indexCount{0},
+            _indexType{VK_INDEX_TYPE_UINT32}
         {}
         Model::Model(
             Graphics& _gfx,
@@ -22,13 +40,11 @@ namespace shard{
                 )
             },
             iBuffer{
-                gfx.createIndexBuffer(
-                    indices.size()*sizeof(uint32_t), VK_SHARING_MODE_EXCLUSIVE,
-                    indices.data()
-                )
+                uploadIndices(gfx, indices.data(), indices.size(), selectIndexType(vertices.size()))
             },
             vertCount{uint32_t(vertices.size())},
-            _indexCount{uint32_t(indices.size())}
+            _indexCount{uint32_t(indices.size())},
+            _indexType{selectIndexType(vertices.size())}
         {}
         Model::Model(
             Graphics& _gfx,
@@ -43,13 +59,11 @@ namespace shard{
                 )
             },
             iBuffer{
-                gfx.createIndexBuffer(
-                    indices.size()*sizeof(uint32_t), VK_SHARING_MODE_EXCLUSIVE,
-                    indices.data()
-                )
+                uploadIndices(gfx, indices.data(), indices.size(), selectIndexType(vertices.size()))
             },
             vertCount{uint32_t(vertices.size())},
-            _indexCount{uint32_t(indices.size())}
+            _indexCount{uint32_t(indices.size())},
+            _indexType{selectIndexType(vertices.size())}
         {}
         Model::Model(
             Graphics& _gfx,
@@ -64,13 +78,11 @@ namespace shard{
                 )
             },
             iBuffer{
-                gfx.createIndexBuffer(
-                    icount*sizeof(uint32_t), VK_SHARING_MODE_EXCLUSIVE,
-                    indices
-                )
+                uploadIndices(gfx, indices, icount, selectIndexType(vcount))
             },
             vertCount{uint32_t(vcount)},
-            _indexCount{uint32_t(icount)}
+            _indexCount{uint32_t(icount)},
+            _indexType{selectIndexType(vcount)}
         {}
         Model::Model(
             Graphics& _gfx,
@@ -85,58 +97,203 @@ namespace shard{
                 )
             },
             iBuffer{
-                gfx.createIndexBuffer(
-                    icount*sizeof(uint32_t), VK_SHARING_MODE_EXCLUSIVE,
-                    indices
+                uploadIndices(gfx, indices, icount, selectIndexType(vcount))
+            },
+            vertCount{uint32_t(vcount)},
+            _indexCount{uint32_t(icount)},
+            _indexType{selectIndexType(vcount)}
+        {}
+        Model::Model(
+            Graphics& _gfx,
+            const void* vertices, size_t vertexStride, size_t vcount,
+            const uint32_t* indices, size_t icount
+        ):
+            gfx{_gfx},
+            vBuffer{
+                gfx.createVertexBuffer(
+                    vcount*vertexStride, VK_SHARING_MODE_EXCLUSIVE,
+                    vertices
                 )
             },
+            iBuffer{
+                uploadIndices(gfx, indices, icount, selectIndexType(vcount))
+            },
+            vertCount{uint32_t(vcount)},
+            _indexCount{uint32_t(icount)},
+            _indexType{selectIndexType(vcount)}
+        {}
+        Model::Model(
+            Graphics& _gfx,
+            const std::vector<VertexStream>& streams, size_t vcount,
+            const uint32_t* indices, size_t icount
+        ):
+            gfx{_gfx},
+            vBuffer{gfx.device()},
+            iBuffer{
+                uploadIndices(gfx, indices, icount, selectIndexType(vcount))
+            },
             vertCount{uint32_t(vcount)},
-            _indexCount{uint32_t(icount)}
+            _indexCount{uint32_t(icount)},
+            _indexType{selectIndexType(vcount)}
+        {
+            assert(!streams.empty() && streams.size() <= MAX_STREAMS);
+            vBuffer = gfx.createVertexBuffer(
+                vcount*streams[0].stride, VK_SHARING_MODE_EXCLUSIVE,
+                streams[0].data
+            );
+            extraStreams.reserve(streams.size() - 1);
+            for(size_t i = 1; i < streams.size(); i++){
+                extraStreams.push_back(
+                    gfx.createVertexBuffer(
+                        vcount*streams[i].stride, VK_SHARING_MODE_EXCLUSIVE,
+                        streams[i].data
+                    )
+                );
+            }
+        }
+        Model::Model(
+            Graphics& _gfx,
+            const std::vector<Vertex3D>& vertices,
+            const std::vector<uint32_t>& indices,
+            VertexStreamLayout layout
+        ):
+            Model(_gfx)
+        {
+            if(layout == VertexStreamLayout::INTERLEAVED){
+                *this = Model(_gfx, vertices, indices);
+                return;
+            }
+            std::vector<glm::vec3> positions;
+            std::vector<Vertex3DAttributes> attributes;
+            splitVertexStreams(vertices, positions, attributes);
+            *this = Model(
+                _gfx,
+                {
+                    {positions.data(),  sizeof(glm::vec3)},
+                    {attributes.data(), sizeof(Vertex3DAttributes)}
+                },
+                vertices.size(),
+                indices.data(), indices.size()
+            );
+        }
+        Model::Model(Graphics& _gfx, const ModelLoader& loader):
+            Model(_gfx, loader.vertices, loader.indices)
+        {
+            setLods(loader.lods);
+        }
+        Model::Model(Graphics& _gfx, const MeshFile& mesh):
+            Model(
+                _gfx,
+                mesh.vertices(), mesh.vertexCount(),
+                mesh.indices(),  mesh.indexCount()
+            )
+        {
+            assert(mesh.valid());
+        }
+        Model::Model(
+            Graphics& _gfx,
+            Buffer&& vertexBuffer, uint32_t vertexCount,
+            Buffer&& indexBuffer,  uint32_t indexCount,
+            VkIndexType indexType
+        ):
+            gfx{_gfx},
+            vBuffer{std::move(vertexBuffer)},
+            iBuffer{std::move(indexBuffer)},
+            vertCount{vertexCount},
+            _indexCount{indexCount},
+            _indexType{indexType}
         {}
         Model::Model(Model&  m):
             gfx{m.gfx},
             vBuffer{m.vBuffer},
             iBuffer{m.iBuffer},
+            extraStreams{std::move(m.extraStreams)},
             vertCount{m.vertCount},
-            _indexCount{m._indexCount}
+            _indexCount{m._indexCount},
+            _indexType{m._indexType},
+            _lods{std::move(m._lods)}
         {}
         Model::Model(Model&& m):
             gfx{m.gfx},
             vBuffer{m.vBuffer},
             iBuffer{m.iBuffer},
+            extraStreams{std::move(m.extraStreams)},
             vertCount{m.vertCount},
-            _indexCount{m._indexCount}
+            _indexCount{m._indexCount},
+            _indexType{m._indexType},
+            _lods{std::move(m._lods)}
         {}
         Model& Model::operator = (Model&  m){
             assert(&gfx == &m.gfx);
             vBuffer = m.vBuffer;
             iBuffer = m.iBuffer;
+            extraStreams = std::move(m.extraStreams);
             vertCount = m.vertCount;
             _indexCount = m._indexCount;
+            _indexType = m._indexType;
+            _lods = std::move(m._lods);
             return *this;
         }
         Model& Model::operator = (Model&& m){
             assert(&gfx == &m.gfx);
             vBuffer = m.vBuffer;
             iBuffer = m.iBuffer;
+            extraStreams = std::move(m.extraStreams);
             vertCount = m.vertCount;
             _indexCount = m._indexCount;
+            _indexType = m._indexType;
+            _lods = std::move(m._lods);
             return *this;
         }
 
         void Model::bind(VkCommandBuffer cBuf){
+            assert(valid());
+            if(extraStreams.empty()){
+                vBuffer.bindVertex(cBuf);
+            } else{
+                VkBuffer buffers[MAX_STREAMS];
+                VkDeviceSize offsets[MAX_STREAMS] = {};
+                buffers[0] = vBuffer.buffer();
+                for(size_t i = 0; i < extraStreams.size(); i++)
+                    buffers[i + 1] = extraStreams[i].buffer();
+                vkCmdBindVertexBuffers(cBuf, 0, streamCount(), buffers, offsets);
+            }
+            if(iBuffer.valid())
+                iBuffer.bindIndex(cBuf, _indexType);
+        }
+        void Model::bindPositions(VkCommandBuffer cBuf){
             assert(valid());
             vBuffer.bindVertex(cBuf);
             if(iBuffer.valid())
-                iBuffer.bindIndex(cBuf, VK_INDEX_TYPE_UINT32);
+                iBuffer.bindIndex(cBuf, _indexType);
         }
         void Model::draw(VkCommandBuffer cBuf){
+            drawLod(cBuf, 0);
+        }
+        void Model::drawLod(VkCommandBuffer cBuf, uint32_t level){
+            record(cBuf, level, 1, 0);
+        }
+        void Model::record(
+            VkCommandBuffer cBuf, uint32_t level,
+            uint32_t instanceCount, uint32_t firstInstance
+        ){
             assert(valid());
+            if(!_lods.empty()){
+                const MeshLod& lod = _lods[std::min(level, uint32_t(_lods.size()) - 1)];
+                vkCmdDrawIndexed(cBuf, lod.indexCount, instanceCount, lod.firstIndex, 0, firstInstance);
+                return;
+            }
             if(iBuffer.valid()){
-                vkCmdDrawIndexed(cBuf, _indexCount, 1, 0, 0, 0);
+                vkCmdDrawIndexed(cBuf, _indexCount, instanceCount, 0, 0, firstInstance);
                 return;
             }
-            vkCmdDraw(cBuf, vertCount, 1, 0, 0);
+            vkCmdDraw(cBuf, vertCount, instanceCount, 0, firstInstance);
+        }
+        void Model::setLods(const std::vector<MeshLod>& lods){
+            for(const auto& lod : lods){
+                assert(uint64_t(lod.firstIndex) + lod.indexCount <= _indexCount);
+            }
+            _lods = lods;
         }
     } // namespace gfx
 } // namespace shard
\ No newline at end of file
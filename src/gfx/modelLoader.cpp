@@ -0,0 +1,170 @@
+#include <shard/gfx/modelLoader.hpp>
+
+#include <tiny_obj_loader.h>
+#include <algorithm>
+#include <cmath>
+
+namespace shard{
+    namespace gfx{
+        // Open addressing map from an OBJ index triplet to the vertex emitted for it.
+        // Capacity is fixed up front from the index count, which bounds the number of
+        // unique triplets, so lookups never rehash and the load factor stays under 1/2.
+        class VertexIndexMap{
+            public:
+                VertexIndexMap(size_t maxEntries){
+                    size_t capacity = 16;
+                    while(capacity < maxEntries * 2) capacity <<= 1;
+                    slots.resize(capacity);
+                    mask = capacity - 1;
+                }
+
+                // Returns the vertex already mapped to key, or maps it to newIndex
+                uint32_t findOrInsert(const tinyobj::index_t& key, uint32_t newIndex, bool& inserted){
+                    size_t i = hash(key) & mask;
+                    while(true){
+                        Slot& slot = slots[i];
+                        if(slot.value == EMPTY){
+                            slot = {key.vertex_index, key.normal_index, key.texcoord_index, newIndex};
+                            inserted = true;
+                            return newIndex;
+                        }
+                        if(
+                            slot.vertex   == key.vertex_index &&
+                            slot.normal   == key.normal_index &&
+                            slot.texcoord == key.texcoord_index
+                        ){
+                            inserted = false;
+                            return slot.value;
+                        }
+                        i = (i + 1) & mask;
+                    }
+                }
+            private:
+                static constexpr uint32_t EMPTY = UINT32_MAX;
+
+                struct Slot{
+                    int32_t  vertex   = 0;
+                    int32_t  normal   = 0;
+                    int32_t  texcoord = 0;
+                    uint32_t value    = EMPTY;
+                };
+
+                static size_t hash(const tinyobj::index_t& key){
+                    uint64_t h = uint64_t(uint32_t(key.vertex_index))   * 0x9E3779B97F4A7C15ull;
+                    h         ^= uint64_t(uint32_t(key.normal_index))   * 0xC2B2AE3D27D4EB4Full;
+                    h         ^= uint64_t(uint32_t(key.texcoord_index)) * 0x165667B19E3779F9ull;
+                    return static_cast<size_t>(h ^ (h >> 29));
+                }
+
+                std::vector<Slot> slots;
+                size_t mask;
+        };
+
+        ModelLoader::ModelLoader(const char* filePath){
+            tinyobj::attrib_t attrib;
+            std::vector<tinyobj::shape_t> shapes;
+            std::vector<tinyobj::material_t> materials;
+            std::string warn, err;
+
+            shard_abort_ifnot(tinyobj::LoadObj(
+                    &attrib, &shapes, &materials, &warn, &err, filePath
+            ));
+
+            size_t indexCount = 0;
+            for(const auto& shape : shapes) indexCount += shape.mesh.indices.size();
+
+            vertices.clear();
+            indices.clear();
+            vertices.reserve(std::min(indexCount, attrib.vertices.size() / 3 * 2));
+            indices.reserve(indexCount);
+
+            VertexIndexMap uniqueVertices(indexCount);
+            for(const auto& shape : shapes){
+                for(const auto& index : shape.mesh.indices){
+                    bool inserted;
+                    uint32_t vertexIndex = uniqueVertices.findOrInsert(
+                        index, static_cast<uint32_t>(vertices.size()), inserted
+                    );
+                    indices.push_back(vertexIndex);
+                    if(!inserted) continue;
+
+                    Vertex3D& vertex = vertices.emplace_back();
+                    vertex.color = Color(255.0f);
+
+                    if(index.vertex_index >= 0){
+                        size_t i = 3 * size_t(index.vertex_index);
+                        vertex.pos = {attrib.vertices[i + 0], attrib.vertices[i + 1], attrib.vertices[i + 2]};
+                        if(i + 2 < attrib.colors.size()){
+                            // OBJ colors are normalized
+                            vertex.color = {
+                                attrib.colors[i + 0] * 255.0f,
+                                attrib.colors[i + 1] * 255.0f,
+                                attrib.colors[i + 2] * 255.0f,
+                            };
+                        }
+                    }
+
+                    if(index.normal_index >= 0){
+                        size_t i = 3 * size_t(index.normal_index);
+                        vertex.normal = {attrib.normals[i + 0], attrib.normals[i + 1], attrib.normals[i + 2]};
+                    }
+
+                    if(index.texcoord_index >= 0){
+                        size_t i = 2 * size_t(index.texcoord_index);
+                        vertex.uv = {attrib.texcoords[i + 0], attrib.texcoords[i + 1]};
+                    }
+                }
+            }
+        }
+
+        void ModelLoader::generateLods(uint32_t maxLevels, float reduction, float maxError){
+            assert(lods.empty() && "Levels were already generated!");
+            lods = buildLodChain(indices, vertices, maxLevels, reduction, maxError);
+        }
+
+        std::vector<uint8_t> ModelLoader::packedIndices() const {
+            VkIndexType type = indexType();
+            std::vector<uint8_t> packed(indices.size() * indexTypeSize(type));
+            packIndices(packed.data(), indices.data(), indices.size(), type);
+            return packed;
+        }
+
+        std::vector<CompactVertex3D> ModelLoader::compactVertices() const {
+            std::vector<CompactVertex3D> compact(vertices.size());
+            for(size_t i = 0; i < vertices.size(); i++){
+                compact[i] = CompactVertex3D::from(vertices[i]);
+            }
+            return compact;
+        }
+        std::vector<QuantizedVertex3D> ModelLoader::quantizedVertices(VertexQuantization& quantization) const {
+            glm::vec3 boundsMin(vertices.empty() ? 0.0f :  INFINITY);
+            glm::vec3 boundsMax(vertices.empty() ? 0.0f : -INFINITY);
+            for(const auto& vertex : vertices){
+                boundsMin = glm::min(boundsMin, vertex.pos);
+                boundsMax = glm::max(boundsMax, vertex.pos);
+            }
+            quantization = VertexQuantization::fromBounds(boundsMin, boundsMax);
+
+            std::vector<QuantizedVertex3D> quantized(vertices.size());
+            for(size_t i = 0; i < vertices.size(); i++){
+                quantized[i] = QuantizedVertex3D::from(vertices[i], quantization);
+            }
+            return quantized;
+        }
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
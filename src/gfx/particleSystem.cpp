@@ -0,0 +1,257 @@
+#include <shard/gfx/particleSystem.hpp>
+
+#include <numeric>
+#include <cstddef>
+
+namespace shard{
+    namespace gfx{
+        namespace{
+            constexpr uint32_t BINDING_COUNT = 7;
+            // end.comp pads the last sorted workgroup with the largest key
+            constexpr uint32_t SORT_KEY_BITS = 16;
+
+            Buffer createStorage(Device& device, VkDeviceSize size, VkBufferUsageFlags usage = 0){
+                return Buffer(
+                    device, size,
+                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                    VK_BUFFER_USAGE_TRANSFER_SRC_BIT   |
+                    VK_BUFFER_USAGE_TRANSFER_DST_BIT   | usage,
+                    VMA_MEMORY_USAGE_GPU_ONLY, 0,
+                    VK_SHARING_MODE_EXCLUSIVE
+                );
+            }
+            DescriptorSetLayout& cachedSetLayout(LayoutCache& cache){
+                std::map<uint32_t, VkDescriptorSetLayoutBinding> bindings;
+                for(uint32_t i = 0; i < BINDING_COUNT; i++){
+                    VkDescriptorSetLayoutBinding binding = {};
+                    binding.binding = i;
+                    binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                    binding.descriptorCount = 1;
+                    binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+                    bindings[i] = binding;
+                }
+                return cache.descriptorSetLayout(bindings);
+            }
+            void memoryBarrier(
+                VkCommandBuffer cmd,
+                VkPipelineStageFlags srcStage, VkAccessFlags srcAccess,
+                VkPipelineStageFlags dstStage, VkAccessFlags dstAccess
+            ){
+                VkMemoryBarrier barrier = {};
+                barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                barrier.srcAccessMask = srcAccess;
+                barrier.dstAccessMask = dstAccess;
+                vkCmdPipelineBarrier(
+                    cmd, srcStage, dstStage, 0,
+                    1, &barrier,
+                    0, nullptr,
+                    0, nullptr
+                );
+            }
+            // Compute writes to the following compute passes and indirect arguments
+            void computeBarrier(VkCommandBuffer cmd){
+                memoryBarrier(
+                    cmd,
+                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                    VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+                    VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                    VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT |
+                    VK_ACCESS_INDIRECT_COMMAND_READ_BIT
+                );
+            }
+        }
+
+        ParticleSystem::ParticleSystem(
+            Graphics& _gfx, uint32_t capacity,
+            bool sorted, uint32_t verticesPerParticle
+        ):
+            gfx{_gfx},
+            _capacity{capacity},
+            _sorted{sorted},
+            workgroupSize{Compute::clampWorkgroupSize(_gfx.device(), 256)},
+            particleBuffer{createStorage(_gfx.device(), capacity * sizeof(Particle))},
+            deadBuffer{_gfx.device()},
+            aliveBuffers{
+                createStorage(_gfx.device(), capacity * sizeof(uint32_t)),
+                createStorage(_gfx.device(), capacity * sizeof(uint32_t))
+            },
+            counterBuffer{createStorage(_gfx.device(), sizeof(Counters), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT)},
+            sortKeyBuffer{createStorage(_gfx.device(), (sorted ? capacity : 1) * sizeof(uint32_t))},
+            instanceBuffer{
+                createStorage(_gfx.device(), capacity * sizeof(Instance), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)
+            },
+            setLayout{cachedSetLayout(_gfx.layoutCache())},
+            descriptorPool{
+                DescriptorPool::Builder(_gfx.device())
+                    .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 * BINDING_COUNT)
+                    .setMaxSets(2)
+                    .build()
+            },
+            beginKernel{_gfx.device()},
+            emitKernel{_gfx.device()},
+            simulateKernel{_gfx.device()},
+            endKernel{_gfx.device()},
+            compactKernel{_gfx.device()}
+        {
+            Device& device = gfx.device();
+            assert(_capacity > 0);
+            assert(verticesPerParticle > 0);
+            shard_abort_ifnot(
+                (_capacity + workgroupSize - 1) / workgroupSize <= device.properties().limits.maxComputeWorkGroupCount[0]
+            );
+
+            // Every slot starts out dead
+            std::vector<uint32_t> slots(_capacity);
+            std::iota(slots.begin(), slots.end(), 0);
+            deadBuffer = gfx.createStorageBuffer_GPUonly(
+                _capacity * sizeof(uint32_t), VK_SHARING_MODE_EXCLUSIVE, slots.data()
+            );
+
+            Counters counters = {};
+            counters.deadCount = _capacity;
+            counters.draw.vertexCount = verticesPerParticle;
+            VkCommandBuffer cmd = device.beginSingleTimeCommands();
+            vkCmdUpdateBuffer(cmd, counterBuffer.buffer(), 0, sizeof(Counters), &counters);
+            device.endSingleTimeCommands(cmd);
+
+            for(uint32_t i = 0; i < 2; i++){
+                VkDescriptorBufferInfo infos[BINDING_COUNT] = {
+                    particleBuffer.descriptorInfo(),
+                    deadBuffer.descriptorInfo(),
+                    aliveBuffers[i].descriptorInfo(),
+                    aliveBuffers[1 - i].descriptorInfo(),
+                    counterBuffer.descriptorInfo(),
+                    sortKeyBuffer.descriptorInfo(),
+                    instanceBuffer.descriptorInfo()
+                };
+                DescriptorWriter writer(setLayout, descriptorPool);
+                for(uint32_t binding = 0; binding < BINDING_COUNT; binding++){
+                    writer.writeBuffer(binding, &infos[binding]);
+                }
+                writer.build(descriptorSets[i]);
+            }
+
+            VkPushConstantRange range = {};
+            range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+            range.offset = 0;
+            range.size = sizeof(Params);
+
+            pipelineLayout = gfx.layoutCache().pipelineLayout({&setLayout}, {range});
+
+            auto constants = SpecializationConstants()
+                .set(0, workgroupSize)
+                .set(1, _sorted)
+                .set(2, verticesPerParticle);
+            beginKernel = Compute(device, pipelineLayout, "shaders/particles/begin.comp.spv", constants);
+            emitKernel = Compute(device, pipelineLayout, "shaders/particles/emit.comp.spv", constants);
+            simulateKernel = Compute(device, pipelineLayout, "shaders/particles/simulate.comp.spv", constants);
+            endKernel = Compute(device, pipelineLayout, "shaders/particles/end.comp.spv", constants);
+            compactKernel = Compute(device, pipelineLayout, "shaders/particles/compact.comp.spv", constants);
+
+            if(_sorted){
+                sorter = std::make_unique<gpu::RadixSort>(device);
+                // The sort is dispatched with compactGroups
+                assert(sorter->workgroupSize() == workgroupSize);
+            }
+        }
+
+        void ParticleSystem::bind(VkCommandBuffer cmd, Compute& kernel, const Params& params){
+            kernel.bind(cmd);
+            vkCmdBindDescriptorSets(
+                cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+                pipelineLayout, 0, 1, &descriptorSets[parity], 0, nullptr
+            );
+            vkCmdPushConstants(
+                cmd, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT,
+                0, sizeof(Params), &params
+            );
+        }
+
+        void ParticleSystem::update(VkCommandBuffer cmd, float deltaTime){
+            assert(cmd != VK_NULL_HANDLE);
+
+            Params params = {};
+            params.position = glm::vec4(_emitter.position, _emitter.radius);
+            params.velocity = glm::vec4(_emitter.velocity, _emitter.velocitySpread);
+            params.acceleration = glm::vec4(_emitter.acceleration, _emitter.drag);
+            params.startColor = _emitter.startColor;
+            params.endColor = _emitter.endColor;
+            params.camera = camera;
+            params.lifetime = _emitter.lifetime;
+            params.lifetimeVariation = _emitter.lifetimeVariation;
+            params.startSize = _emitter.startSize;
+            params.endSize = _emitter.endSize;
+            params.deltaTime = deltaTime;
+            params.rate = _emitter.rate;
+            params.burst = pendingBurst;
+            params.seed = seed++;
+            pendingBurst = 0;
+
+            // The previous frame's draw may still read the instances and arguments
+            memoryBarrier(
+                cmd,
+                VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT
+            );
+            bind(cmd, beginKernel, params);
+            beginKernel.dispatch(cmd, 1, 1);
+            computeBarrier(cmd);
+
+            bind(cmd, emitKernel, params);
+            emitKernel.dispatchIndirect(cmd, counterBuffer.buffer(), offsetof(Counters, emitGroups));
+            computeBarrier(cmd);
+
+            bind(cmd, simulateKernel, params);
+            simulateKernel.dispatchIndirect(cmd, counterBuffer.buffer(), offsetof(Counters, simulateGroups));
+            computeBarrier(cmd);
+
+            bind(cmd, endKernel, params);
+            endKernel.dispatch(cmd, 1, 1);
+            computeBarrier(cmd);
+
+            // Only the survivors' workgroups are sorted, the count never leaves the GPU
+            if(_sorted){
+                sorter->recordIndirect(
+                    cmd, sortKeyBuffer, aliveBuffers[1 - parity], _capacity,
+                    counterBuffer, offsetof(Counters, compactGroups), SORT_KEY_BITS
+                );
+                computeBarrier(cmd);
+            }
+
+            bind(cmd, compactKernel, params);
+            compactKernel.dispatchIndirect(cmd, counterBuffer.buffer(), offsetof(Counters, compactGroups));
+
+            memoryBarrier(
+                cmd,
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT
+            );
+
+            // The survivors are simulated next
+            parity = 1 - parity;
+        }
+        void ParticleSystem::draw(VkCommandBuffer cmd, uint32_t instanceBinding){
+            instanceBuffer.bindVertex(cmd, instanceBinding);
+            vkCmdDrawIndirect(cmd, counterBuffer.buffer(), offsetof(Counters, draw), 1, sizeof(VkDrawIndirectCommand));
+        }
+    } // namespace gfx
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
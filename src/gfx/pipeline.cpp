@@ -1,5 +1,7 @@
 #include <shard/gfx/pipeline.hpp>
 
+#include <algorithm>
+
 namespace shard{
     namespace gfx{
         void PipelineConfigInfo::makeDefault(){
@@ -85,7 +87,8 @@ namespace shard{
             const std::vector<char>& fragSPV,
             const std::vector<VkVertexInputBindingDescription>& bindingDescs,
             const std::vector<VkVertexInputAttributeDescription>& attrDescs,
-            PipelineConfigInfo& config
+            PipelineConfigInfo& config,
+            const SpecializationConstants& constants
         ):
             device{_device}
         {
@@ -97,7 +100,8 @@ namespace shard{
                 layout, vert, frag,
                 bindingDescs,
                 attrDescs,
-                config
+                config,
+                constants
             );
         }
         Pipeline::Pipeline(
@@ -108,7 +112,8 @@ namespace shard{
             const char* fragFile,
             const std::vector<VkVertexInputBindingDescription>& bindingDescs,
             const std::vector<VkVertexInputAttributeDescription>& attrDescs,
-            PipelineConfigInfo& config
+            PipelineConfigInfo& config,
+            const SpecializationConstants& constants
         ):
             device{_device}
         {
@@ -120,7 +125,8 @@ namespace shard{
                 layout, vert, frag,
                 bindingDescs,
                 attrDescs,
-                config
+                config,
+                constants
             );
         }
         Pipeline::Pipeline(
@@ -131,7 +137,8 @@ namespace shard{
             ShaderModule& frag,
             const std::vector<VkVertexInputBindingDescription>& bindingDescs,
             const std::vector<VkVertexInputAttributeDescription>& attrDescs,
-            PipelineConfigInfo& config
+            PipelineConfigInfo& config,
+            const SpecializationConstants& constants
         ):
             device{_device}
         {
@@ -143,7 +150,8 @@ namespace shard{
                 layout, vert, frag,
                 bindingDescs,
                 attrDescs,
-                config
+                config,
+                constants
             );
         }
         Pipeline::Pipeline(Pipeline& p):
@@ -161,7 +169,17 @@ namespace shard{
             p._pipeline = VK_NULL_HANDLE;
         }
         Pipeline::~Pipeline(){
-            vkDestroyPipeline(device.device(), _pipeline, nullptr);
+            destroy();
+        }
+        void Pipeline::destroy(){
+            if(_pipeline == VK_NULL_HANDLE) return;
+
+            VkDevice vkDevice = device.device();
+            VkPipeline pipeline = _pipeline;
+            device.deferDestroy([vkDevice, pipeline](){
+                vkDestroyPipeline(vkDevice, pipeline, nullptr);
+            });
+            _pipeline = VK_NULL_HANDLE;
         }
         void Pipeline::init(
             VkRenderPass renderPass,
@@ -170,8 +188,17 @@ namespace shard{
             ShaderModule& frag,
             const std::vector<VkVertexInputBindingDescription>& bindingDescs,
             const std::vector<VkVertexInputAttributeDescription>& attrDescs,
-            PipelineConfigInfo& config
+            PipelineConfigInfo& config,
+            const SpecializationConstants& constants
         ){
+            // Every input the vertex shader reads must be fed by an attribute
+            for(auto& input : vert.reflection().vertexInputs){
+                bool fed = std::any_of(attrDescs.begin(), attrDescs.end(),
+                    [&input](const auto& attr){ return attr.location == input.location; }
+                );
+                shard_abort_ifnot(fed);
+            }
+
             VkPipelineShaderStageCreateInfo shaderStages[2] = {{}};
             shaderStages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
             shaderStages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
@@ -179,7 +206,7 @@ namespace shard{
             shaderStages[0].pName = "main";
             shaderStages[0].flags = 0;
             shaderStages[0].pNext = nullptr;
-            shaderStages[0].pSpecializationInfo = nullptr;
+            shaderStages[0].pSpecializationInfo = constants.info();
 
             shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
             shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -187,7 +214,7 @@ namespace shard{
             shaderStages[1].pName = "main";
             shaderStages[1].flags = 0;
             shaderStages[1].pNext = nullptr;
-            shaderStages[1].pSpecializationInfo = nullptr;
+            shaderStages[1].pSpecializationInfo = constants.info();
 
             VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
             vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
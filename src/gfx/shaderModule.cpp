@@ -15,20 +15,32 @@ namespace shard{
         }
         ShaderModule::ShaderModule(ShaderModule& sm):
             device{sm.device},
-            _shaderModule{sm._shaderModule}
+            _shaderModule{sm._shaderModule},
+            _reflection{std::move(sm._reflection)}
         {
             //assert(sm.valid());
             sm._shaderModule = VK_NULL_HANDLE;
         }
         ShaderModule::ShaderModule(ShaderModule&& sm):
             device{sm.device},
-            _shaderModule{sm._shaderModule}
+            _shaderModule{sm._shaderModule},
+            _reflection{std::move(sm._reflection)}
         {
             //assert(sm.valid());
             sm._shaderModule = VK_NULL_HANDLE;
         }
         ShaderModule::~ShaderModule(){
-            vkDestroyShaderModule(device.device(), _shaderModule, nullptr);
+            destroy();
+        }
+        void ShaderModule::destroy(){
+            if(_shaderModule == VK_NULL_HANDLE) return;
+
+            VkDevice vkDevice = device.device();
+            VkShaderModule shaderModule = _shaderModule;
+            device.deferDestroy([vkDevice, shaderModule](){
+                vkDestroyShaderModule(vkDevice, shaderModule, nullptr);
+            });
+            _shaderModule = VK_NULL_HANDLE;
         }
 
         void ShaderModule::init(const std::vector<char>& spv){
@@ -43,6 +55,9 @@ namespace shard{
                     &_shaderModule
                 ) == VK_SUCCESS
             );
+            _reflection = ShaderReflection::reflect(
+                reinterpret_cast<const uint32_t*>(spv.data()), spv.size() / sizeof(uint32_t)
+            );
         }
     } // namespace gfx
 } // namespace shard
@@ -0,0 +1,415 @@
+#include <shard/gfx/shaderReflection.hpp>
+
+#include <unordered_map>
+#include <algorithm>
+#include <tuple>
+
+namespace shard{
+    namespace gfx{
+        namespace{
+            // Only the parts of the SPIR-V spec needed to describe a module's interface
+            namespace spv{
+                constexpr uint32_t MAGIC = 0x07230203;
+
+                enum Op : uint32_t{
+                    OpEntryPoint          = 15,
+                    OpExecutionMode       = 16,
+                    OpTypeInt             = 21,
+                    OpTypeFloat           = 22,
+                    OpTypeVector          = 23,
+                    OpTypeMatrix          = 24,
+                    OpTypeImage           = 25,
+                    OpTypeSampler         = 26,
+                    OpTypeSampledImage    = 27,
+                    OpTypeArray           = 28,
+                    OpTypeRuntimeArray    = 29,
+                    OpTypeStruct          = 30,
+                    OpTypePointer         = 32,
+                    OpConstant            = 43,
+                    OpConstantComposite   = 44,
+                    OpSpecConstant        = 50,
+                    OpSpecConstantComposite = 51,
+                    OpVariable            = 59,
+                    OpDecorate            = 71,
+                    OpMemberDecorate      = 72,
+                };
+                enum Decoration : uint32_t{
+                    Block         = 2,
+                    BufferBlock   = 3,
+                    ArrayStride   = 6,
+                    MatrixStride  = 7,
+                    BuiltIn       = 11,
+                    Location      = 30,
+                    Binding       = 33,
+                    DescriptorSet = 34,
+                    Offset        = 35,
+                };
+                enum StorageClass : uint32_t{
+                    UniformConstant = 0,
+                    Input           = 1,
+                    Uniform         = 2,
+                    PushConstant    = 9,
+                    StorageBuffer   = 12,
+                };
+                enum Dim : uint32_t{
+                    DimBuffer      = 5,
+                    DimSubpassData = 6,
+                };
+                constexpr uint32_t EXECUTION_MODE_LOCAL_SIZE = 17;
+                constexpr uint32_t BUILTIN_WORKGROUP_SIZE = 25;
+            } // namespace spv
+
+            struct Decorations{
+                uint32_t set = 0;
+                uint32_t binding = 0;
+                uint32_t location = 0;
+                uint32_t arrayStride = 0;
+                bool hasBinding = false;
+                bool hasLocation = false;
+                bool builtIn = false;
+                bool bufferBlock = false;
+                bool workgroupSize = false;
+            };
+            struct MemberDecorations{
+                uint32_t offset = 0;
+                uint32_t matrixStride = 0;
+            };
+
+            class Parser{
+                public:
+                    Parser(const uint32_t* _code, size_t _wordCount):
+                        code{_code}, wordCount{_wordCount}
+                    {}
+
+                    bool parse(ShaderReflection& out){
+                        if(wordCount < 5 || code[0] != spv::MAGIC) return false;
+
+                        size_t i = 5;
+                        while(i < wordCount){
+                            const uint32_t* inst = code + i;
+                            uint32_t count = inst[0] >> 16;
+                            uint32_t op = inst[0] & 0xFFFF;
+                            if(count == 0 || i + count > wordCount) return false;
+                            visit(inst, op, count);
+                            i += count;
+                        }
+                        if(!hasEntryPoint) return false;
+
+                        out.stage = stage;
+                        for(uint32_t c = 0; c < 3; c++) out.localSize[c] = localSize[c];
+                        for(auto& [id, storage] : variables) reflectVariable(out, id, storage);
+
+                        std::sort(out.bindings.begin(), out.bindings.end(),
+                            [](const auto& a, const auto& b){
+                                return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+                            }
+                        );
+                        std::sort(out.vertexInputs.begin(), out.vertexInputs.end(),
+                            [](const auto& a, const auto& b){ return a.location < b.location; }
+                        );
+                        return true;
+                    }
+                private:
+                    struct Variable{
+                        uint32_t type;
+                        uint32_t storage;
+                    };
+
+                    void visit(const uint32_t* inst, uint32_t op, uint32_t count){
+                        switch(op){
+                            case spv::OpEntryPoint:
+                                // Modules with several entry points reflect the first one
+                                if(!hasEntryPoint && count >= 3){
+                                    hasEntryPoint = true;
+                                    stage = executionModelStage(inst[1]);
+                                }
+                                break;
+                            case spv::OpExecutionMode:
+                                if(count >= 6 && inst[2] == spv::EXECUTION_MODE_LOCAL_SIZE){
+                                    localSize[0] = inst[3];
+                                    localSize[1] = inst[4];
+                                    localSize[2] = inst[5];
+                                }
+                                break;
+                            case spv::OpDecorate:
+                                if(count >= 3) decorate(decorations[inst[1]], inst[2], count >= 4 ? inst[3] : 0);
+                                break;
+                            case spv::OpMemberDecorate:
+                                if(count >= 5){
+                                    auto& member = memberDecorations[inst[1]];
+                                    if(member.size() <= inst[2]) member.resize(inst[2] + 1);
+                                    if(inst[3] == spv::Offset)       member[inst[2]].offset = inst[4];
+                                    if(inst[3] == spv::MatrixStride) member[inst[2]].matrixStride = inst[4];
+                                }
+                                break;
+                            case spv::OpTypeInt:
+                            case spv::OpTypeFloat:
+                            case spv::OpTypeVector:
+                            case spv::OpTypeMatrix:
+                            case spv::OpTypeImage:
+                            case spv::OpTypeSampler:
+                            case spv::OpTypeSampledImage:
+                            case spv::OpTypeArray:
+                            case spv::OpTypeRuntimeArray:
+                            case spv::OpTypeStruct:
+                            case spv::OpTypePointer:
+                                if(count >= 2) types[inst[1]] = {inst, count};
+                                break;
+                            case spv::OpConstant:
+                            case spv::OpSpecConstant:
+                                if(count >= 4) constants[inst[2]] = inst[3];
+                                break;
+                            case spv::OpConstantComposite:
+                            case spv::OpSpecConstantComposite:
+                                // local_size_x_id declares the workgroup size as a composite
+                                // whose defaults override the LocalSize execution mode
+                                if(count >= 6 && decorations[inst[2]].workgroupSize){
+                                    for(uint32_t c = 0; c < 3; c++) localSize[c] = constant(inst[3 + c]);
+                                }
+                                break;
+                            case spv::OpVariable:
+                                if(count >= 4) variables.push_back({inst[2], {inst[1], inst[3]}});
+                                break;
+                            default:
+                                break;
+                        }
+                    }
+
+                    static void decorate(Decorations& d, uint32_t decoration, uint32_t value){
+                        switch(decoration){
+                            case spv::DescriptorSet: d.set = value; break;
+                            case spv::Binding:       d.binding = value; d.hasBinding = true; break;
+                            case spv::Location:      d.location = value; d.hasLocation = true; break;
+                            case spv::ArrayStride:   d.arrayStride = value; break;
+                            case spv::BufferBlock:   d.bufferBlock = true; break;
+                            case spv::BuiltIn:
+                                d.builtIn = true;
+                                d.workgroupSize = value == spv::BUILTIN_WORKGROUP_SIZE;
+                                break;
+                            default: break;
+                        }
+                    }
+
+                    static VkShaderStageFlagBits executionModelStage(uint32_t model){
+                        switch(model){
+                            case 0: return VK_SHADER_STAGE_VERTEX_BIT;
+                            case 1: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+                            case 2: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+                            case 3: return VK_SHADER_STAGE_GEOMETRY_BIT;
+                            case 4: return VK_SHADER_STAGE_FRAGMENT_BIT;
+                            case 5: return VK_SHADER_STAGE_COMPUTE_BIT;
+                            default: return VkShaderStageFlagBits(0);
+                        }
+                    }
+
+                    // Returns {nullptr, 0} for ids that are not types
+                    std::pair<const uint32_t*, uint32_t> type(uint32_t id) const {
+                        auto it = types.find(id);
+                        if(it == types.end()) return {nullptr, 0};
+                        return it->second;
+                    }
+                    uint32_t constant(uint32_t id) const {
+                        auto it = constants.find(id);
+                        return it == constants.end() ? 0 : it->second;
+                    }
+
+                    uint32_t typeSize(uint32_t id, uint32_t matrixStride) const {
+                        auto [inst, count] = type(id);
+                        if(!inst) return 0;
+                        switch(inst[0] & 0xFFFF){
+                            case spv::OpTypeInt:
+                            case spv::OpTypeFloat:
+                                return inst[2] / 8;
+                            case spv::OpTypeVector:
+                                return inst[3] * typeSize(inst[2], 0);
+                            case spv::OpTypeMatrix:
+                                return inst[3] * (matrixStride ? matrixStride : typeSize(inst[2], 0));
+                            case spv::OpTypeArray: {
+                                auto it = decorations.find(id);
+                                uint32_t stride = it != decorations.end() ? it->second.arrayStride : 0;
+                                if(stride == 0) stride = typeSize(inst[2], matrixStride);
+                                return constant(inst[3]) * stride;
+                            }
+                            case spv::OpTypeStruct: {
+                                auto it = memberDecorations.find(id);
+                                uint32_t size = 0;
+                                for(uint32_t m = 0; m + 2 < count; m++){
+                                    MemberDecorations member{};
+                                    if(it != memberDecorations.end() && m < it->second.size()){
+                                        member = it->second[m];
+                                    }
+                                    size = std::max(size, member.offset + typeSize(inst[2 + m], member.matrixStride));
+                                }
+                                return size;
+                            }
+                            default:
+                                return 0;
+                        }
+                    }
+                    // The offset of a block's first member, push constant blocks may
+                    // skip the bytes owned by other stages
+                    uint32_t structOffset(uint32_t id) const {
+                        auto it = memberDecorations.find(id);
+                        if(it == memberDecorations.end() || it->second.empty()) return 0;
+                        uint32_t offset = UINT32_MAX;
+                        for(auto& member : it->second) offset = std::min(offset, member.offset);
+                        return offset;
+                    }
+
+                    VkDescriptorType descriptorType(const uint32_t* inst, uint32_t storage, uint32_t id) const {
+                        switch(inst[0] & 0xFFFF){
+                            case spv::OpTypeSampler:
+                                return VK_DESCRIPTOR_TYPE_SAMPLER;
+                            case spv::OpTypeSampledImage: {
+                                auto [image, count] = type(inst[2]);
+                                if(image && image[3] == spv::DimBuffer) return VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+                                return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+                            }
+                            case spv::OpTypeImage:
+                                if(inst[3] == spv::DimSubpassData) return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+                                if(inst[3] == spv::DimBuffer){
+                                    return inst[7] == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER
+                                                        : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+                                }
+                                return inst[7] == 2 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
+                                                    : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+                            case spv::OpTypeStruct: {
+                                // Pre 1.3 modules mark storage buffers as BufferBlock in Uniform
+                                auto it = decorations.find(id);
+                                bool bufferBlock = it != decorations.end() && it->second.bufferBlock;
+                                if(storage == spv::StorageBuffer || bufferBlock) return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                                return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                            }
+                            default:
+                                return VK_DESCRIPTOR_TYPE_MAX_ENUM;
+                        }
+                    }
+
+                    VkFormat vertexFormat(uint32_t id, uint32_t& locations) const {
+                        auto [inst, count] = type(id);
+                        locations = 1;
+                        if(!inst) return VK_FORMAT_UNDEFINED;
+
+                        uint32_t op = inst[0] & 0xFFFF;
+                        uint32_t components = 1;
+                        if(op == spv::OpTypeMatrix){
+                            // One location per column
+                            VkFormat column = vertexFormat(inst[2], locations);
+                            locations = inst[3];
+                            return column;
+                        }
+                        if(op == spv::OpTypeVector){
+                            components = inst[3];
+                            std::tie(inst, count) = type(inst[2]);
+                            if(!inst) return VK_FORMAT_UNDEFINED;
+                            op = inst[0] & 0xFFFF;
+                        }
+                        if(op != spv::OpTypeFloat && op != spv::OpTypeInt) return VK_FORMAT_UNDEFINED;
+                        if(inst[2] != 32 || components < 1 || components > 4) return VK_FORMAT_UNDEFINED;
+
+                        static constexpr VkFormat floats[] = {
+                            VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT,
+                            VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT
+                        };
+                        static constexpr VkFormat sints[] = {
+                            VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT,
+                            VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT
+                        };
+                        static constexpr VkFormat uints[] = {
+                            VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT,
+                            VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT
+                        };
+                        if(op == spv::OpTypeFloat) return floats[components - 1];
+                        return inst[3] ? sints[components - 1] : uints[components - 1];
+                    }
+
+                    void reflectVariable(ShaderReflection& out, uint32_t id, const Variable& var) const {
+                        auto [pointer, pointerCount] = type(var.type);
+                        if(!pointer || (pointer[0] & 0xFFFF) != spv::OpTypePointer) return;
+                        uint32_t pointee = pointer[3];
+
+                        auto decoIt = decorations.find(id);
+                        Decorations deco = decoIt != decorations.end() ? decoIt->second : Decorations{};
+
+                        switch(var.storage){
+                            case spv::UniformConstant:
+                            case spv::Uniform:
+                            case spv::StorageBuffer: {
+                                if(!deco.hasBinding) return;
+                                uint32_t arraySize = 1;
+                                auto [inst, count] = type(pointee);
+                                if(!inst) return;
+                                if((inst[0] & 0xFFFF) == spv::OpTypeArray){
+                                    arraySize = constant(inst[3]);
+                                    pointee = inst[2];
+                                    std::tie(inst, count) = type(pointee);
+                                } else if((inst[0] & 0xFFFF) == spv::OpTypeRuntimeArray){
+                                    arraySize = 0;
+                                    pointee = inst[2];
+                                    std::tie(inst, count) = type(pointee);
+                                }
+                                if(!inst) return;
+
+                                VkDescriptorType descType = descriptorType(inst, var.storage, pointee);
+                                if(descType == VK_DESCRIPTOR_TYPE_MAX_ENUM) return;
+                                out.bindings.push_back({deco.set, deco.binding, descType, arraySize});
+                                break;
+                            }
+                            case spv::PushConstant: {
+                                uint32_t offset = structOffset(pointee);
+                                out.pushConstants.stageFlags = stage;
+                                out.pushConstants.offset = offset;
+                                out.pushConstants.size = typeSize(pointee, 0) - offset;
+                                break;
+                            }
+                            case spv::Input: {
+                                if(stage != VK_SHADER_STAGE_VERTEX_BIT || deco.builtIn || !deco.hasLocation) return;
+                                uint32_t locations = 1;
+                                VkFormat format = vertexFormat(pointee, locations);
+                                for(uint32_t l = 0; l < locations; l++){
+                                    out.vertexInputs.push_back({deco.location + l, format});
+                                }
+                                break;
+                            }
+                            default:
+                                break;
+                        }
+                    }
+
+                    const uint32_t* code;
+                    size_t wordCount;
+
+                    bool hasEntryPoint = false;
+                    VkShaderStageFlagBits stage = VkShaderStageFlagBits(0);
+                    uint32_t localSize[3] = {0, 0, 0};
+
+                    std::unordered_map<uint32_t, std::pair<const uint32_t*, uint32_t>> types;
+                    std::unordered_map<uint32_t, uint32_t> constants;
+                    std::unordered_map<uint32_t, Decorations> decorations;
+                    std::unordered_map<uint32_t, std::vector<MemberDecorations>> memberDecorations;
+                    std::vector<std::pair<uint32_t, Variable>> variables;
+            };
+        }
+
+        ShaderReflection ShaderReflection::reflect(const uint32_t* code, size_t wordCount){
+            ShaderReflection reflection;
+            if(!code || !Parser(code, wordCount).parse(reflection)) return ShaderReflection{};
+            return reflection;
+        }
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,265 @@
+#include <shard/gfx/shaderReloader.hpp>
+
+#include <set>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <filesystem>
+
+#ifdef __linux__
+    #include <poll.h>
+    #include <unistd.h>
+    #include <sys/inotify.h>
+#endif
+
+namespace shard{
+    namespace gfx{
+        namespace{
+            constexpr int POLL_INTERVAL_MS = 250;
+
+            std::string sourcePath(const std::string& spvFile){
+                constexpr std::string_view EXT = ".spv";
+                assert(spvFile.ends_with(EXT) && "Watched shaders must be *.spv files!");
+                return std::filesystem::path(spvFile.substr(0, spvFile.size() - EXT.size()))
+                    .lexically_normal().string();
+            }
+            int64_t writeTime(const std::string& path){
+                std::error_code ec;
+                auto time = std::filesystem::last_write_time(path, ec);
+                return ec ? 0 : int64_t(time.time_since_epoch().count());
+            }
+        }
+
+        ShaderReloader::ShaderReloader(Device& _device, const char* _compiler):
+            device{_device},
+            compiler{_compiler}
+        {
+        #ifdef __linux__
+            // Falls back to polling if inotify is unavailable
+            notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        #endif
+            thread = std::thread(&ShaderReloader::worker, this);
+        }
+        ShaderReloader::~ShaderReloader(){
+            stopping = true;
+            thread.join();
+        #ifdef __linux__
+            if(notifyFd >= 0) close(notifyFd);
+        #endif
+        }
+
+        void ShaderReloader::watch(
+            Pipeline& pipeline,
+            std::function<VkRenderPass()> renderPass,
+            VkPipelineLayout layout,
+            const char* vertFile,
+            const char* fragFile,
+            const std::vector<VkVertexInputBindingDescription>& bindingDescs,
+            const std::vector<VkVertexInputAttributeDescription>& attrDescs,
+            PipelineConfigInfo& config,
+            const SpecializationConstants& constants
+        ){
+            assert(renderPass);
+            assert(layout != VK_NULL_HANDLE);
+
+            Target target;
+            target.pipeline = &pipeline;
+            target.renderPass = std::move(renderPass);
+            target.layout = layout;
+            target.spvFiles = {vertFile, fragFile};
+            target.bindingDescs = bindingDescs;
+            target.attrDescs = attrDescs;
+            target.config = &config;
+            target.constants = constants;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            for(auto& file : target.spvFiles) addSource(file);
+            targets[&pipeline] = std::move(target);
+        }
+        void ShaderReloader::watch(
+            Compute& compute, VkPipelineLayout layout, const char* filePath,
+            const SpecializationConstants& constants
+        ){
+            assert(layout != VK_NULL_HANDLE);
+
+            Target target;
+            target.compute = &compute;
+            target.layout = layout;
+            target.spvFiles = {filePath};
+            target.constants = constants;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            addSource(target.spvFiles[0]);
+            targets[&compute] = std::move(target);
+        }
+        void ShaderReloader::unwatch(void* target){
+            std::lock_guard<std::mutex> lock(mutex);
+            targets.erase(target);
+        }
+
+        uint32_t ShaderReloader::swap(){
+            std::lock_guard<std::mutex> lock(mutex);
+            uint32_t swapped = 0;
+            for(auto& result : rebuilt){
+                // Unwatched while it was being rebuilt
+                auto it = targets.find(result.target);
+                if(it == targets.end()) continue;
+
+                // Assignment retires the old pipeline through deferred deletion
+                const Target& target = it->second;
+                if(result.compute){
+                    *target.compute = *result.compute;
+                } else{
+                    VkRenderPass renderPass = target.renderPass();
+                    assert(renderPass != VK_NULL_HANDLE);
+                    Pipeline pipeline(
+                        device, renderPass, target.layout, *result.vert, *result.frag,
+                        target.bindingDescs, target.attrDescs, *target.config, target.constants
+                    );
+                    *target.pipeline = pipeline;
+                }
+                swapped++;
+            }
+            rebuilt.clear();
+            return swapped;
+        }
+
+        void ShaderReloader::addSource(const std::string& spvFile){
+            std::string source = sourcePath(spvFile);
+            if(sources.contains(source)) return;
+            sources[source] = writeTime(source);
+
+        #ifdef __linux__
+            if(notifyFd < 0) return;
+            // Directories are watched instead of files, editors that save by
+            // replacing the file would otherwise drop the watch
+            std::string dir = std::filesystem::path(source).parent_path().string();
+            if(dir.empty()) dir = ".";
+            int wd = inotify_add_watch(notifyFd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if(wd >= 0) watchedDirs[wd] = dir;
+        #endif
+        }
+
+        void ShaderReloader::worker(){
+            while(!stopping){
+                std::vector<std::string> changed = pollChanges();
+                if(changed.empty()) continue;
+
+                std::vector<std::string> compiled;
+                for(auto& source : changed){
+                    if(compile(source)) compiled.push_back(source);
+                }
+
+                std::vector<std::pair<void*, Target>> affected;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    for(auto& [key, target] : targets){
+                        bool uses = std::any_of(target.spvFiles.begin(), target.spvFiles.end(),
+                            [&compiled](const std::string& file){
+                                return std::find(
+                                    compiled.begin(), compiled.end(), sourcePath(file)
+                                ) != compiled.end();
+                            }
+                        );
+                        if(uses) affected.emplace_back(key, target);
+                    }
+                }
+                // Pipelines are built outside the lock, swap() may run meanwhile
+                for(auto& [key, target] : affected) rebuild(key, target);
+            }
+        }
+        std::vector<std::string> ShaderReloader::pollChanges(){
+            std::set<std::string> changed;
+        #ifdef __linux__
+            if(notifyFd >= 0){
+                pollfd pfd = {notifyFd, POLLIN, 0};
+                if(poll(&pfd, 1, POLL_INTERVAL_MS) <= 0) return {};
+
+                alignas(inotify_event) char buffer[4096];
+                ssize_t length = read(notifyFd, buffer, sizeof(buffer));
+
+                std::lock_guard<std::mutex> lock(mutex);
+                for(ssize_t offset = 0; offset < length;){
+                    auto event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                    offset += sizeof(inotify_event) + event->len;
+
+                    auto dir = watchedDirs.find(event->wd);
+                    if(event->len == 0 || dir == watchedDirs.end()) continue;
+                    std::string path = (std::filesystem::path(dir->second) / event->name)
+                        .lexically_normal().string();
+                    if(sources.contains(path)) changed.insert(path);
+                }
+                return {changed.begin(), changed.end()};
+            }
+        #endif
+            std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+
+            std::lock_guard<std::mutex> lock(mutex);
+            for(auto& [source, time] : sources){
+                int64_t current = writeTime(source);
+                if(current == time) continue;
+                time = current;
+                changed.insert(source);
+            }
+            return {changed.begin(), changed.end()};
+        }
+        bool ShaderReloader::compile(const std::string& source){
+            // Same target as the build, see CMakeLists.txt
+            std::string command = compiler + " --target-env=vulkan1.2 -o \"" + source + ".spv\" \"" + source + "\"";
+            if(std::system(command.c_str()) != 0){
+                // glslc has already printed the errors, the old pipeline stays in use
+                std::cerr << SHARD_FUNC << ": Failed to compile " << source << "\n";
+                return false;
+            }
+            return true;
+        }
+        void ShaderReloader::rebuild(void* key, const Target& target){
+            Rebuilt result{key, nullptr, nullptr, nullptr};
+
+            if(target.compute){
+                ShaderModule shader(device, target.spvFiles[0].c_str());
+                if(shader.stage() != VK_SHADER_STAGE_COMPUTE_BIT){
+                    std::cerr << SHARD_FUNC << ": " << target.spvFiles[0] << " is not a compute shader\n";
+                    return;
+                }
+                result.compute = std::make_unique<Compute>(
+                    device, target.layout, shader, target.constants
+                );
+            } else{
+                auto vert = std::make_unique<ShaderModule>(device, target.spvFiles[0].c_str());
+                auto frag = std::make_unique<ShaderModule>(device, target.spvFiles[1].c_str());
+
+                // Pipeline creation aborts on unfed inputs, an edit should only be reported
+                for(auto& input : vert->reflection().vertexInputs){
+                    bool fed = std::any_of(target.attrDescs.begin(), target.attrDescs.end(),
+                        [&input](const auto& attr){ return attr.location == input.location; }
+                    );
+                    if(fed) continue;
+                    std::cerr << SHARD_FUNC << ": " << target.spvFiles[0]
+                              << " reads location " << input.location << " with no attribute\n";
+                    return;
+                }
+                result.vert = std::move(vert);
+                result.frag = std::move(frag);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            rebuilt.push_back(std::move(result));
+        }
+    } // namespace gfx
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
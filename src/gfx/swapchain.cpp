@@ -3,24 +3,37 @@
 #include <limits>
 #include <array>
 #include <set>
+#include <chrono>
 
 namespace shard{
     namespace gfx{
-        Swapchain::Swapchain(Device& refDevice, VkExtent2D winExtent, bool vsync):
-            VSYNC{vsync},
+        Swapchain::Swapchain(Device& refDevice, VkExtent2D winExtent, PresentPolicy policy):
+            PRESENT_POLICY{policy},
+            VSYNC{policy != PresentPolicy::IMMEDIATE},
             device{refDevice},
-            windowExtent{windowExtent}
+            windowExtent{winExtent}
         {
             init();
         }
         Swapchain::Swapchain(
-            Device& refDevice, VkExtent2D winExtent, bool vsync, std::shared_ptr<Swapchain> previous
+            Device& refDevice, VkExtent2D winExtent, PresentPolicy policy,
+            std::shared_ptr<Swapchain> previous
         ):
-            VSYNC{vsync},
+            PRESENT_POLICY{policy},
+            VSYNC{policy != PresentPolicy::IMMEDIATE},
             device{refDevice},
-            windowExtent{windowExtent},
+            windowExtent{winExtent},
             oldSwapchain{previous}
         {
+            assert(oldSwapchain != nullptr);
+            // Frame fences track queue submissions, not swapchain images, so they carry
+            // over to the new swapchain. This lets the old one be retired through the
+            // device's deletion queue instead of waiting for the device to go idle.
+            inFlightFences = std::move(oldSwapchain->inFlightFences);
+            fenceFrameValues = oldSwapchain->fenceFrameValues;
+            currentFrame = oldSwapchain->currentFrame;
+            oldSwapchain->inFlightFences.clear();
+
             init();
             oldSwapchain = nullptr;
         }
@@ -37,10 +50,14 @@ namespace shard{
 
             vkDestroyRenderPass(device.device(), _renderPass, nullptr);
 
-            for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-                vkDestroySemaphore(device.device(), renderFinishedSemaphores[i], nullptr);
-                vkDestroySemaphore(device.device(), imageAvailableSemaphores[i], nullptr);
-                vkDestroyFence(device.device(), inFlightFences[i], nullptr);
+            for (auto semaphore : renderFinishedSemaphores) {
+                vkDestroySemaphore(device.device(), semaphore, nullptr);
+            }
+            for (auto semaphore : imageAvailableSemaphores) {
+                vkDestroySemaphore(device.device(), semaphore, nullptr);
+            }
+            for (auto fence : inFlightFences) {
+                vkDestroyFence(device.device(), fence, nullptr);
             }
         }
 
@@ -114,6 +131,7 @@ namespace shard{
 
             _swapchainImageFormat = surfaceFormat.format;
             _swapchainExtent = extent;
+            _presentMode = presentMode;
         }
         void Swapchain::createImageViews(){
             swapchainImageViews.resize(swapchainImages.size());
@@ -223,9 +241,12 @@ namespace shard{
         void Swapchain::createSyncObjects(){
             imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
             renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-            inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
             imagesInFlight.resize(imageCount(), VK_NULL_HANDLE);
 
+            // Fences are adopted when recreating from a previous swapchain
+            bool createFences = inFlightFences.empty();
+            if(createFences) inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+
             VkSemaphoreCreateInfo semaphoreInfo = {};
             semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
@@ -244,11 +265,13 @@ namespace shard{
                         device.device(), &semaphoreInfo, nullptr, &renderFinishedSemaphores[i])
                         == VK_SUCCESS
                 );
-                shard_abort_ifnot(
-                    vkCreateFence(
-                        device.device(), &fenceInfo, nullptr, &inFlightFences[i])
-                        == VK_SUCCESS
-                );
+                if(createFences){
+                    shard_abort_ifnot(
+                        vkCreateFence(
+                            device.device(), &fenceInfo, nullptr, &inFlightFences[i])
+                            == VK_SUCCESS
+                    );
+                }
             }
         }
 
@@ -268,19 +291,24 @@ namespace shard{
         VkPresentModeKHR Swapchain::chooseSwapPresentMode(
             const std::vector<VkPresentModeKHR> &availablePresentModes
         ){
-            if(VSYNC){
-                for (const auto &availablePresentMode : availablePresentModes) {
-                    if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-                        //std::cout << "Present mode: Mailbox" << std::endl;
-                        return availablePresentMode;
-                    }
-                }
-            } else {
-                for (const auto &availablePresentMode : availablePresentModes) {
-                    if (availablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR) {
-                        //std::cout << "Present mode: Immediate" << std::endl;
-                        return availablePresentMode;
-                    }
+            std::vector<VkPresentModeKHR> preferred = {};
+            switch(PRESENT_POLICY){
+                case PresentPolicy::IMMEDIATE:
+                    preferred = {VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR};
+                    break;
+                case PresentPolicy::MAILBOX:
+                    preferred = {VK_PRESENT_MODE_MAILBOX_KHR};
+                    break;
+                case PresentPolicy::FIFO_RELAXED:
+                    preferred = {VK_PRESENT_MODE_FIFO_RELAXED_KHR};
+                    break;
+                case PresentPolicy::FIFO:
+                    break;
+            }
+
+            for(auto mode : preferred){
+                for(const auto &availablePresentMode : availablePresentModes){
+                    if(availablePresentMode == mode) return mode;
                 }
             }
             return VK_PRESENT_MODE_FIFO_KHR;
@@ -311,19 +339,27 @@ namespace shard{
                 VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
         } 
 
-        VkResult Swapchain::acquireNextImage(uint32_t *imageIndex){
-            vkWaitForFences(
+        VkResult Swapchain::acquireNextImage(uint32_t *imageIndex, uint64_t timeout){
+            auto waitStart = std::chrono::steady_clock::now();
+            VkResult fenceResult = vkWaitForFences(
                 device.device(),
                 1,
                 &inFlightFences[currentFrame],
                 VK_TRUE,
-                std::numeric_limits<uint64_t>::max()
+                timeout
             );
+            fenceWaitTime = std::chrono::duration<float>(
+                std::chrono::steady_clock::now() - waitStart
+            ).count();
+            if(fenceResult != VK_SUCCESS) return fenceResult;
+            // Everything queued for deletion up to the frame that last used this fence
+            // is no longer referenced by the GPU.
+            device.collectGarbage(fenceFrameValues[currentFrame]);
 
             VkResult result = vkAcquireNextImageKHR(
                 device.device(),
                 swapchain,
-                std::numeric_limits<uint64_t>::max(),
+                timeout,
                 imageAvailableSemaphores[currentFrame],  // must be a not signaled semaphore
                 VK_NULL_HANDLE,
                 imageIndex
@@ -357,9 +393,11 @@ namespace shard{
 
             vkResetFences(device.device(), 1, &inFlightFences[currentFrame]);
             shard_abort_ifnot(
-                vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, inFlightFences[currentFrame])
+                device.queueSubmit(device.graphicsQueue(), 1, &submitInfo, inFlightFences[currentFrame])
                 == VK_SUCCESS
             );
+            fenceFrameValues[currentFrame] = device.frameValue();
+            device.advanceFrame();
 
             VkPresentInfoKHR presentInfo = {};
             presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -373,12 +411,28 @@ namespace shard{
 
             presentInfo.pImageIndices = imageIndex;
 
-            auto result = vkQueuePresentKHR(device.presentQueue(), &presentInfo);
+        #if defined(VK_KHR_present_id)
+            VkPresentIdKHR presentIdInfo = {};
+            uint64_t nextPresentId = presentId + 1;
+            if(device.presentWaitSupported()){
+                presentIdInfo.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+                presentIdInfo.swapchainCount = 1;
+                presentIdInfo.pPresentIds = &nextPresentId;
+                presentInfo.pNext = &presentIdInfo;
+                presentId = nextPresentId;
+            }
+        #endif
+
+            auto result = device.queuePresent(&presentInfo);
 
             currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 
             return result;
         }
+        VkResult Swapchain::waitForPresent(uint64_t id, uint64_t timeout){
+            assert(id <= presentId);
+            return device.waitForPresent(swapchain, id, timeout);
+        }
     } // namespace gfx
 } // namespace shard
 
@@ -0,0 +1,115 @@
+#include <shard/job/threadPool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <latch>
+
+namespace shard{
+    namespace job{
+        ThreadPool::ThreadPool(uint32_t threadCount){
+            if(threadCount == 0){
+                threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+            }
+            threads.reserve(threadCount);
+            for(uint32_t i = 0; i < threadCount; i++){
+                threads.emplace_back(&ThreadPool::worker, this);
+            }
+        }
+        ThreadPool::~ThreadPool(){
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            jobCondition.notify_all();
+            for(auto& thread : threads) thread.join();
+        }
+
+        void ThreadPool::submit(std::function<void()>&& job){
+            assert(job);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                jobs.push_back(std::move(job));
+            }
+            jobCondition.notify_one();
+        }
+        void ThreadPool::wait(){
+            std::unique_lock<std::mutex> lock(mutex);
+            idleCondition.wait(lock, [this](){
+                return jobs.empty() && activeCount == 0;
+            });
+        }
+        void ThreadPool::parallelFor(
+            uint32_t count, uint32_t batchSize,
+            const std::function<void(uint32_t, uint32_t)>& f
+        ){
+            assert(batchSize > 0);
+            uint32_t batchCount = (count + batchSize - 1) / batchSize;
+            if(batchCount == 0) return;
+
+            std::atomic<uint32_t> next = 0;
+            auto run = [&](){
+                for(uint32_t batch; (batch = next.fetch_add(1)) < batchCount;){
+                    uint32_t begin = batch * batchSize;
+                    f(begin, std::min(begin + batchSize, count));
+                }
+            };
+
+            // Helpers that start late find every batch taken and return straight away
+            uint32_t helperCount = std::min(threadCount(), batchCount - 1);
+            std::latch done(helperCount);
+            for(uint32_t i = 0; i < helperCount; i++){
+                submit([&run, &done](){
+                    run();
+                    done.count_down();
+                });
+            }
+            run();
+            done.wait();
+        }
+        uint32_t ThreadPool::pendingCount(){
+            std::lock_guard<std::mutex> lock(mutex);
+            return static_cast<uint32_t>(jobs.size()) + activeCount;
+        }
+
+        void ThreadPool::worker(){
+            while(true){
+                std::function<void()> job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    jobCondition.wait(lock, [this](){
+                        return stopping || !jobs.empty();
+                    });
+                    // Queued jobs are drained before the pool shuts down
+                    if(jobs.empty()) return;
+
+                    job = std::move(jobs.front());
+                    jobs.pop_front();
+                    activeCount++;
+                }
+
+                job();
+
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    activeCount--;
+                    if(jobs.empty() && activeCount == 0) idleCondition.notify_all();
+                }
+            }
+        }
+    } // namespace job
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
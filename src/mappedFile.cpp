@@ -0,0 +1,113 @@
+#include <shard/mappedFile.hpp>
+
+#include <utility>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace shard{
+    MappedFile::MappedFile(const char* filePath){
+    #if defined(_WIN32)
+        HANDLE file = CreateFileA(
+            filePath, GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr
+        );
+        if(file == INVALID_HANDLE_VALUE) return;
+
+        LARGE_INTEGER fileSize;
+        if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0){
+            CloseHandle(file);
+            return;
+        }
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(!mapping){
+            CloseHandle(file);
+            return;
+        }
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if(!view){
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return;
+        }
+
+        fileHandle = file;
+        mappingHandle = mapping;
+        _data = static_cast<const uint8_t*>(view);
+        _size = static_cast<size_t>(fileSize.QuadPart);
+    #else
+        int fd = open(filePath, O_RDONLY);
+        if(fd < 0) return;
+
+        struct stat st;
+        if(fstat(fd, &st) != 0 || st.st_size == 0){
+            ::close(fd);
+            return;
+        }
+        void* view = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        // The mapping keeps its own reference to the file
+        ::close(fd);
+        if(view == MAP_FAILED) return;
+
+        madvise(view, size_t(st.st_size), MADV_SEQUENTIAL);
+        _data = static_cast<const uint8_t*>(view);
+        _size = size_t(st.st_size);
+    #endif
+    }
+    MappedFile::MappedFile(MappedFile&& f){
+        *this = std::move(f);
+    }
+    MappedFile::~MappedFile(){
+        close();
+    }
+
+    MappedFile& MappedFile::operator = (MappedFile&& f){
+        if(this == &f) return *this;
+        close();
+        std::swap(_data, f._data);
+        std::swap(_size, f._size);
+    #if defined(_WIN32)
+        std::swap(fileHandle, f.fileHandle);
+        std::swap(mappingHandle, f.mappingHandle);
+    #endif
+        return *this;
+    }
+
+    void MappedFile::close(){
+        if(!_data) return;
+    #if defined(_WIN32)
+        UnmapViewOfFile(_data);
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        fileHandle = nullptr;
+        mappingHandle = nullptr;
+    #else
+        munmap(const_cast<uint8_t*>(_data), _size);
+    #endif
+        _data = nullptr;
+        _size = 0;
+    }
+} // namespace shard
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,442 @@
+#include <shard/r2d/atlas.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace shard{
+    namespace r2d{
+        SkylinePacker::SkylinePacker(uint32_t w, uint32_t h):
+            _width{w},
+            _height{h}
+        {
+            reset();
+        }
+
+        void SkylinePacker::reset(){
+            skyline.clear();
+            skyline.push_back({0, 0, static_cast<int32_t>(_width)});
+            usedArea = 0;
+        }
+
+        bool SkylinePacker::insert(uint32_t w, uint32_t h, glm::uvec2& pos){
+            if(w > _width || h > _height) return false;
+
+            int32_t width = static_cast<int32_t>(w);
+            int32_t height = static_cast<int32_t>(h);
+
+            // Lowest resulting top edge wins, ties go to the narrowest segment
+            size_t bestIndex = skyline.size();
+            int32_t bestTop = INT32_MAX;
+            int32_t bestWidth = INT32_MAX;
+            int32_t bestY = 0;
+            for(size_t i = 0; i < skyline.size(); i++){
+                int32_t y;
+                if(!fits(i, width, height, y)) continue;
+                if(y + height < bestTop || (y + height == bestTop && skyline[i].width < bestWidth)){
+                    bestIndex = i;
+                    bestTop = y + height;
+                    bestWidth = skyline[i].width;
+                    bestY = y;
+                }
+            }
+            if(bestIndex == skyline.size()) return false;
+
+            pos = {static_cast<uint32_t>(skyline[bestIndex].x), static_cast<uint32_t>(bestY)};
+            addLevel(bestIndex, skyline[bestIndex].x, bestY, width, height);
+            usedArea += uint64_t(w) * uint64_t(h);
+            return true;
+        }
+
+        bool SkylinePacker::fits(size_t index, int32_t w, int32_t h, int32_t& y) const {
+            int32_t x = skyline[index].x;
+            if(x + w > static_cast<int32_t>(_width)) return false;
+
+            // The rectangle rests on the highest segment it spans
+            int32_t widthLeft = w;
+            y = skyline[index].y;
+            for(size_t i = index; widthLeft > 0; i++){
+                if(i == skyline.size()) return false;
+                y = std::max(y, skyline[i].y);
+                if(y + h > static_cast<int32_t>(_height)) return false;
+                widthLeft -= skyline[i].width;
+            }
+            return true;
+        }
+
+        void SkylinePacker::addLevel(size_t index, int32_t x, int32_t y, int32_t w, int32_t h){
+            skyline.insert(skyline.begin() + index, {x, y + h, w});
+
+            // Cut away the segments now covered by the new one
+            for(size_t i = index + 1; i < skyline.size(); i++){
+                const Node& prev = skyline[i - 1];
+                int32_t prevEnd = prev.x + prev.width;
+                if(skyline[i].x >= prevEnd) break;
+
+                int32_t shrink = prevEnd - skyline[i].x;
+                skyline[i].x += shrink;
+                skyline[i].width -= shrink;
+                if(skyline[i].width > 0) break;
+
+                skyline.erase(skyline.begin() + i);
+                i--;
+            }
+
+            // Merge neighbouring segments of the same height
+            for(size_t i = 0; i + 1 < skyline.size(); i++){
+                if(skyline[i].y == skyline[i + 1].y){
+                    skyline[i].width += skyline[i + 1].width;
+                    skyline.erase(skyline.begin() + i + 1);
+                    i--;
+                }
+            }
+        }
+
+        Atlas::Atlas(gfx::Graphics& _gfx, Renderer& _renderer, uint32_t size, uint32_t maxPageCount):
+            gfx{_gfx},
+            renderer{_renderer},
+            _pageSize{size},
+            _maxPages{maxPageCount},
+            sampler{
+                _gfx.createSampler(
+                    VK_FILTER_LINEAR, VK_FILTER_LINEAR,
+                    VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                    VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                    VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                    VK_FALSE, VK_BORDER_COLOR_INT_OPAQUE_BLACK,
+                    VK_SAMPLER_MIPMAP_MODE_NEAREST,
+                    1
+                )
+            }
+        {
+            assert(_pageSize > 0 && _maxPages > 0);
+        }
+        Atlas::~Atlas(){
+            for(auto& page : pages){
+                renderer.removeTexture(page.texture);
+            }
+        }
+
+        AtlasHandle Atlas::insert(uint32_t w, uint32_t h, const void* pixels){
+            assert(w > 0 && h > 0 && pixels != nullptr);
+
+            uint32_t page;
+            glm::uvec2 pos;
+            if(!allocate(w + PADDING, h + PADDING, page, pos)) return INVALID_HANDLE;
+
+            uint32_t index;
+            if(!freeEntries.empty()){
+                index = freeEntries.back();
+                freeEntries.pop_back();
+            } else{
+                index = static_cast<uint32_t>(entries.size());
+                entries.push_back({});
+            }
+            Entry& entry = entries[index];
+            entry.generation++;
+            entry.alive = true;
+            entry.page = page;
+            entry.pos = pos;
+            entry.size = {w, h};
+
+            pages[page].entries.push_back(index);
+            pages[page].lastUsed = gfx.device().frameValue();
+
+            size_t dataSize = size_t(w) * size_t(h) * 4;
+            size_t dataOffset = stagingData.size();
+            stagingData.resize(dataOffset + dataSize);
+            memcpy(stagingData.data() + dataOffset, pixels, dataSize);
+            pendingUploads.push_back({page, pos, {w, h}, dataOffset});
+
+            return (static_cast<AtlasHandle>(entry.generation) << 32) | index;
+        }
+        AtlasHandle Atlas::insert(const char* filePath){
+            int w, h, channels;
+            stbi_uc* pixels = stbi_load(filePath, &w, &h, &channels, STBI_rgb_alpha);
+            assert(pixels != nullptr && "File does not exist!");
+
+            AtlasHandle handle = insert(uint32_t(w), uint32_t(h), pixels);
+            stbi_image_free(pixels);
+            return handle;
+        }
+        void Atlas::remove(AtlasHandle handle){
+            Entry* entry = lookup(handle);
+            assert(entry != nullptr && "Invalid atlas handle!");
+            entry->alive = false;
+        }
+        bool Atlas::contains(AtlasHandle handle) const {
+            return lookup(handle) != nullptr;
+        }
+
+        bool Atlas::resolve(AtlasHandle handle, AtlasRegion& region){
+            Entry* entry = lookup(handle);
+            if(!entry) return false;
+
+            Page& page = pages[entry->page];
+            page.lastUsed = gfx.device().frameValue();
+
+            float size = static_cast<float>(_pageSize);
+            region.texture = page.texture;
+            region.page = entry->page;
+            region.srcSize = glm::vec2(entry->size) / size;
+            region.srcPos = glm::vec2(entry->pos) / size + region.srcSize * 0.5f;
+            return true;
+        }
+        bool Atlas::apply(AtlasHandle handle, Sprite& sprite){
+            AtlasRegion region;
+            if(!resolve(handle, region)) return false;
+            sprite.texture = region.texture;
+            sprite.srcPos = region.srcPos;
+            sprite.srcSize = region.srcSize;
+            return true;
+        }
+
+        void Atlas::recordUploads(VkCommandBuffer commandBuffer){
+            assert(commandBuffer != VK_NULL_HANDLE);
+            // A page is only evicted to make room for an insert, so clears come with uploads
+            if(pendingUploads.empty()) return;
+
+            // Kept alive by the device deletion queue until this frame has completed
+            gfx::Buffer staging = gfx.createBuffer(
+                stagingData.size(),
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VMA_MEMORY_USAGE_CPU_ONLY,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                VK_SHARING_MODE_EXCLUSIVE,
+                stagingData.data()
+            );
+
+            std::stable_sort(
+                pendingUploads.begin(), pendingUploads.end(),
+                [](const PendingUpload& a, const PendingUpload& b){ return a.page < b.page; }
+            );
+
+            VkImageMemoryBarrier barrier = {};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            barrier.subresourceRange.baseMipLevel = 0;
+            barrier.subresourceRange.levelCount = 1;
+            barrier.subresourceRange.baseArrayLayer = 0;
+            barrier.subresourceRange.layerCount = 1;
+
+            std::vector<uint32_t> touched = pendingClears;
+            for(auto& upload : pendingUploads) touched.push_back(upload.page);
+            std::sort(touched.begin(), touched.end());
+            touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+            std::vector<VkImageMemoryBarrier> toTransfer;
+            std::vector<VkImageMemoryBarrier> toShaderRead;
+            for(uint32_t page : touched){
+                barrier.image = pages[page].image.image();
+
+                // Earlier frames may still be sampling regions of an evicted page
+                barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                barrier.srcAccessMask = 0;
+                barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                toTransfer.push_back(barrier);
+
+                barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+                toShaderRead.push_back(barrier);
+            }
+
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                0,
+                0, nullptr,
+                0, nullptr,
+                static_cast<uint32_t>(toTransfer.size()), toTransfer.data()
+            );
+
+            // Evicted pages go back to fully transparent before their new regions land
+            if(!pendingClears.empty()){
+                VkClearColorValue clear = {};
+                VkImageSubresourceRange range = {};
+                range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                range.levelCount = 1;
+                range.layerCount = 1;
+                for(uint32_t page : pendingClears){
+                    vkCmdClearColorImage(
+                        commandBuffer, pages[page].image.image(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                        &clear, 1, &range
+                    );
+                }
+
+                VkMemoryBarrier clearBarrier = {};
+                clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+                clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                clearBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+                vkCmdPipelineBarrier(
+                    commandBuffer,
+                    VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                    0,
+                    1, &clearBarrier,
+                    0, nullptr,
+                    0, nullptr
+                );
+            }
+
+            std::vector<VkBufferImageCopy> regions;
+            for(size_t i = 0; i < pendingUploads.size(); i++){
+                const PendingUpload& upload = pendingUploads[i];
+
+                VkBufferImageCopy region = {};
+                region.bufferOffset = upload.dataOffset;
+                region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                region.imageSubresource.mipLevel = 0;
+                region.imageSubresource.baseArrayLayer = 0;
+                region.imageSubresource.layerCount = 1;
+                region.imageOffset = {
+                    static_cast<int32_t>(upload.pos.x),
+                    static_cast<int32_t>(upload.pos.y),
+                    0
+                };
+                region.imageExtent = {upload.size.x, upload.size.y, 1};
+                regions.push_back(region);
+
+                bool lastOfPage =
+                    i + 1 == pendingUploads.size() || pendingUploads[i + 1].page != upload.page;
+                if(lastOfPage){
+                    vkCmdCopyBufferToImage(
+                        commandBuffer,
+                        staging.buffer(),
+                        pages[upload.page].image.image(),
+                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                        static_cast<uint32_t>(regions.size()),
+                        regions.data()
+                    );
+                    regions.clear();
+                }
+            }
+
+            vkCmdPipelineBarrier(
+                commandBuffer,
+                VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                0,
+                0, nullptr,
+                0, nullptr,
+                static_cast<uint32_t>(toShaderRead.size()), toShaderRead.data()
+            );
+
+            pendingUploads.clear();
+            pendingClears.clear();
+            stagingData.clear();
+        }
+
+        bool Atlas::allocate(uint32_t w, uint32_t h, uint32_t& page, glm::uvec2& pos){
+            if(w > _pageSize || h > _pageSize) return false;
+
+            for(uint32_t i = 0; i < pages.size(); i++){
+                if(pages[i].packer.insert(w, h, pos)){
+                    page = i;
+                    return true;
+                }
+            }
+
+            if(pages.size() < _maxPages){
+                page = createPage();
+            } else if(!evictPage(page)){
+                return false;
+            }
+            return pages[page].packer.insert(w, h, pos);
+        }
+        uint32_t Atlas::createPage(){
+            gfx::Image image = gfx.createImage(
+                _pageSize, _pageSize, 1,
+                VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
+                VK_SAMPLE_COUNT_1_BIT,
+                VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                0,
+                VMA_MEMORY_USAGE_GPU_ONLY,
+                VK_IMAGE_ASPECT_COLOR_BIT,
+                VK_SHARING_MODE_EXCLUSIVE
+            );
+
+            // Start out fully transparent so padding never shows garbage
+            image.transition(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+            VkCommandBuffer commandBuffer = gfx.device().beginSingleTimeCommands();
+            VkClearColorValue clear = {};
+            VkImageSubresourceRange range = {};
+            range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            range.levelCount = 1;
+            range.layerCount = 1;
+            vkCmdClearColorImage(
+                commandBuffer, image.image(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                &clear, 1, &range
+            );
+            gfx.device().endSingleTimeCommands(commandBuffer);
+            image.transition(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+            pages.emplace_back(std::move(image), _pageSize);
+            pages.back().texture = renderer.addTexture(pages.back().image, sampler);
+            return static_cast<uint32_t>(pages.size() - 1);
+        }
+        bool Atlas::evictPage(uint32_t& page){
+            uint64_t currentFrame = gfx.device().frameValue();
+
+            bool found = false;
+            for(uint32_t i = 0; i < pages.size(); i++){
+                if(pages[i].lastUsed >= currentFrame) continue;
+                if(!found || pages[i].lastUsed < pages[page].lastUsed){
+                    page = i;
+                    found = true;
+                }
+            }
+            if(!found) return false;
+
+            Page& victim = pages[page];
+            for(uint32_t index : victim.entries){
+                entries[index].alive = false;
+                freeEntries.push_back(index);
+            }
+            victim.entries.clear();
+            victim.packer.reset();
+
+            // Uploads of the evicted entries would overlap the new ones
+            pendingUploads.erase(
+                std::remove_if(
+                    pendingUploads.begin(), pendingUploads.end(),
+                    [page](const PendingUpload& upload){ return upload.page == page; }
+                ),
+                pendingUploads.end()
+            );
+            pendingClears.push_back(page);
+            _evictionCount++;
+            return true;
+        }
+
+        Atlas::Entry* Atlas::lookup(AtlasHandle handle){
+            return const_cast<Entry*>(static_cast<const Atlas*>(this)->lookup(handle));
+        }
+        const Atlas::Entry* Atlas::lookup(AtlasHandle handle) const {
+            uint32_t index = static_cast<uint32_t>(handle & 0xffffffff);
+            uint32_t generation = static_cast<uint32_t>(handle >> 32);
+            if(index >= entries.size()) return nullptr;
+
+            const Entry& entry = entries[index];
+            if(!entry.alive || entry.generation != generation) return nullptr;
+            return &entry;
+        }
+    } // namespace r2d
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
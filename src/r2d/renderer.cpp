@@ -0,0 +1,288 @@
+#include <shard/r2d/renderer.hpp>
+
+#include <algorithm>
+
+namespace shard{
+    namespace r2d{
+        namespace{
+            constexpr size_t MIN_INSTANCE_CAPACITY = 1024;
+
+            TextureID keyTexture(uint64_t key){
+                return static_cast<TextureID>(key & 0xffffffff);
+            }
+        }
+
+        Renderer::Renderer(gfx::Graphics& _gfx):
+            gfx{_gfx},
+            descriptorPool{
+                _gfx.createDescriptorPoolBuilder()
+                    .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_TEXTURES)
+                    .setMaxSets(MAX_TEXTURES)
+                    .build()
+            },
+            descriptorLayout{
+                _gfx.createDescriptorSetLayoutBuilder()
+                    .addBinding(
+                        0,
+                        VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                        VK_SHADER_STAGE_FRAGMENT_BIT
+                    ).build()
+            },
+            pipeline{_gfx.device()},
+            whiteImage{_gfx.device()},
+            whiteSampler{
+                _gfx.createSampler(
+                    VK_FILTER_NEAREST, VK_FILTER_NEAREST,
+                    VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                    VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                    VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                    VK_FALSE, VK_BORDER_COLOR_INT_OPAQUE_BLACK,
+                    VK_SAMPLER_MIPMAP_MODE_NEAREST,
+                    1
+                )
+            }
+        {
+            pipelineLayout = gfx.createPipelineLayout({CameraPush::range()}, {&descriptorLayout});
+            createPipeline();
+
+            for(uint32_t i = 0; i < gfx::Swapchain::MAX_FRAMES_IN_FLIGHT; i++){
+                frames.emplace_back(gfx.device());
+            }
+
+            uint32_t white = 0xffffffff;
+            whiteImage = gfx.createTexture(1, 1, &white);
+            shard_abort_ifnot(addTexture(whiteImage, whiteSampler) == WHITE_TEXTURE);
+        }
+        Renderer::~Renderer(){
+            gfx.destroyPipelineLayout(pipelineLayout);
+        }
+
+        void Renderer::createPipeline(){
+            gfx::PipelineConfigInfo config;
+            config.makeDefault();
+            // Draw order is decided by the layer sort
+            config.depthStencilInfo.depthTestEnable = VK_FALSE;
+            config.depthStencilInfo.depthWriteEnable = VK_FALSE;
+
+            pipeline = gfx.createPipeline(
+                pipelineLayout,
+                "shaders/r2d/batch.vert.spv",
+                "shaders/r2d/batch.frag.spv",
+                {bindingDesc()}, attributeDescs(),
+                config
+            );
+        }
+
+        TextureID Renderer::addTexture(gfx::Image& image, gfx::Sampler& sampler){
+            auto imageInfo = image.descriptorInfo(sampler);
+
+            uint64_t completed = gfx.device().completedFrameValue();
+            auto retired = std::find_if(
+                retiredTextures.begin(), retiredTextures.end(),
+                [completed](const RetiredTexture& t){ return t.frameValue <= completed; }
+            );
+            if(retired != retiredTextures.end()){
+                TextureID id = retired->id;
+                retiredTextures.erase(retired);
+
+                gfx::DescriptorWriter(descriptorLayout, descriptorPool)
+                    .writeImage(0, &imageInfo)
+                    .overwrite(textures[id]);
+                textureAlive[id] = true;
+                return id;
+            }
+
+            shard_abort_ifnot(textures.size() < MAX_TEXTURES && "Too many r2d textures!");
+            TextureID id = static_cast<TextureID>(textures.size());
+            textures.push_back(VK_NULL_HANDLE);
+            textureAlive.push_back(true);
+            gfx::DescriptorWriter(descriptorLayout, descriptorPool)
+                .writeImage(0, &imageInfo)
+                .build(textures[id]);
+            return id;
+        }
+        void Renderer::removeTexture(TextureID texture){
+            assert(texture != WHITE_TEXTURE && "Cannot remove the white texture!");
+            assert(texture < textures.size() && textureAlive[texture]);
+            textureAlive[texture] = false;
+            retiredTextures.push_back({texture, gfx.device().frameValue()});
+        }
+
+        void Renderer::setCamera(const glm::mat4& _projection, const glm::mat4& _view){
+            projection = _projection;
+            view = _view;
+            pixelCamera = false;
+        }
+        void Renderer::resetCamera(){
+            pixelCamera = true;
+        }
+
+        void Renderer::drawSprite(const Sprite& sprite){
+            Instance instance = {};
+            instance.position = sprite.position;
+            instance.size = sprite.size;
+            instance.uvRect = {
+                sprite.srcPos - sprite.srcSize * 0.5f,
+                sprite.srcPos + sprite.srcSize * 0.5f
+            };
+            instance.color = packColor(sprite.color);
+            instance.borderColor = 0;
+            instance.rotation = sprite.rotation;
+            instance.borderSize = 0.0f;
+            push(instance, sprite.layer, sprite.texture);
+        }
+        void Renderer::drawRect(const Rect& rect){
+            Instance instance = {};
+            instance.position = rect.position;
+            instance.size = rect.size;
+            instance.uvRect = {0.0f, 0.0f, 1.0f, 1.0f};
+            instance.color = packColor(rect.color);
+            instance.borderColor = packColor(rect.borderColor);
+            instance.rotation = rect.rotation;
+            instance.borderSize = rect.borderSize;
+            push(instance, rect.layer, WHITE_TEXTURE);
+        }
+        void Renderer::push(const Instance& instance, int32_t layer, TextureID texture){
+            assert(texture < textures.size() && textureAlive[texture] && "Invalid r2d texture!");
+
+            // Flip the sign bit so negative layers sort first
+            uint64_t key =
+                (static_cast<uint64_t>(static_cast<uint32_t>(layer) ^ 0x80000000u) << 32) |
+                static_cast<uint64_t>(texture);
+            entries.push_back({key, static_cast<uint32_t>(instances.size())});
+            instances.push_back(instance);
+        }
+
+        void Renderer::reserve(FrameBuffer& frame, size_t count){
+            if(frame.cursor + count <= frame.capacity) return;
+
+            // Draws recorded earlier this frame keep the old buffer alive through the
+            // device deletion queue, so start the new one from the beginning
+            size_t capacity = std::max({frame.capacity * 2, count, MIN_INSTANCE_CAPACITY});
+            frame.buffer = gfx.createBuffer(
+                capacity * sizeof(Instance),
+                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                VMA_MEMORY_USAGE_CPU_TO_GPU,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                VK_SHARING_MODE_EXCLUSIVE
+            );
+            frame.buffer.map();
+            frame.capacity = capacity;
+            frame.cursor = 0;
+        }
+
+        void Renderer::flush(VkCommandBuffer commandBuffer){
+            assert(commandBuffer != VK_NULL_HANDLE);
+
+            _drawCallCount = 0;
+            _instanceCount = static_cast<uint32_t>(instances.size());
+            if(instances.empty()) return;
+
+            // UI is usually submitted in order already
+            if(!std::is_sorted(entries.begin(), entries.end())){
+                std::sort(entries.begin(), entries.end());
+            }
+
+            FrameBuffer& frame = frames[gfx.frameIndex()];
+            uint64_t frameValue = gfx.device().frameValue();
+            if(frame.frameValue != frameValue){
+                frame.frameValue = frameValue;
+                frame.cursor = 0;
+            }
+            reserve(frame, entries.size());
+
+            Instance* dst = static_cast<Instance*>(frame.buffer.mappedMemory()) + frame.cursor;
+            for(size_t i = 0; i < entries.size(); i++){
+                dst[i] = instances[entries[i].index];
+            }
+
+            glm::mat4 viewProjection;
+            if(pixelCamera){
+                VkExtent2D extent = gfx.swapchain().swapchainExtent();
+                viewProjection = glm::ortho(
+                    0.0f, static_cast<float>(extent.width),
+                    0.0f, static_cast<float>(extent.height),
+                    -1.0f, 1.0f
+                );
+            } else{
+                viewProjection = projection * view;
+            }
+
+            pipeline.bind(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS);
+            CameraPush::push(commandBuffer, pipelineLayout, viewProjection);
+            frame.buffer.bindVertex(commandBuffer);
+
+            // One instanced draw per run of instances sharing a texture
+            uint32_t firstInstance = static_cast<uint32_t>(frame.cursor);
+            TextureID boundTexture = MAX_TEXTURES;
+            size_t runStart = 0;
+            for(size_t i = 1; i <= entries.size(); i++){
+                TextureID texture = keyTexture(entries[runStart].key);
+                if(i < entries.size() && keyTexture(entries[i].key) == texture) continue;
+
+                if(texture != boundTexture){
+                    vkCmdBindDescriptorSets(
+                        commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                        pipelineLayout, 0, 1, &textures[texture],
+                        0, nullptr
+                    );
+                    boundTexture = texture;
+                }
+                vkCmdDraw(
+                    commandBuffer, 6, static_cast<uint32_t>(i - runStart),
+                    0, firstInstance + static_cast<uint32_t>(runStart)
+                );
+                _drawCallCount++;
+                runStart = i;
+            }
+
+            frame.cursor += entries.size();
+            instances.clear();
+            entries.clear();
+        }
+
+        uint32_t Renderer::packColor(const gfx::Color& color){
+            auto channel = [](float v){
+                return static_cast<uint32_t>(std::clamp(v, 0.0f, 255.0f) + 0.5f);
+            };
+            return channel(color.r)       |
+                   channel(color.g) << 8  |
+                   channel(color.b) << 16 |
+                   channel(color.a) << 24;
+        }
+        VkVertexInputBindingDescription Renderer::bindingDesc(){
+            VkVertexInputBindingDescription binding = {};
+            binding.binding = 0;
+            binding.stride = sizeof(Instance);
+            binding.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+            return binding;
+        }
+        std::vector<VkVertexInputAttributeDescription> Renderer::attributeDescs(){
+            return {
+                {0, 0, VK_FORMAT_R32G32_SFLOAT,       offsetof(Instance, position)},
+                {1, 0, VK_FORMAT_R32G32_SFLOAT,       offsetof(Instance, size)},
+                {2, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(Instance, uvRect)},
+                {3, 0, VK_FORMAT_R8G8B8A8_UNORM,      offsetof(Instance, color)},
+                {4, 0, VK_FORMAT_R8G8B8A8_UNORM,      offsetof(Instance, borderColor)},
+                {5, 0, VK_FORMAT_R32_SFLOAT,          offsetof(Instance, rotation)},
+                {6, 0, VK_FORMAT_R32_SFLOAT,          offsetof(Instance, borderSize)},
+            };
+        }
+    } // namespace r2d
+} // namespace shard
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
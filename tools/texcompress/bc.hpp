@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+// Block compressors used by texcompress. Every encoder takes a 4x4 block of RGBA8 texels
+// in row major order.
+namespace bc{
+    inline uint16_t to565(const float c[3]){
+        auto q = [](float v, float maxValue){
+            return static_cast<uint16_t>(std::clamp(v, 0.0f, 255.0f) / 255.0f * maxValue + 0.5f);
+        };
+        return static_cast<uint16_t>(q(c[0], 31.0f) << 11 | q(c[1], 63.0f) << 5 | q(c[2], 31.0f));
+    }
+    inline void from565(uint16_t c, float out[3]){
+        out[0] = float((c >> 11) & 31) * 255.0f / 31.0f;
+        out[1] = float((c >> 5)  & 63) * 255.0f / 63.0f;
+        out[2] = float( c        & 31) * 255.0f / 31.0f;
+    }
+
+    // BC1 in 4 color mode, endpoints are the extremes along the principal axis
+    inline void encodeBC1(const uint8_t block[64], uint8_t out[8]){
+        float mean[3] = {0.0f, 0.0f, 0.0f};
+        for(int i = 0; i < 16; i++){
+            for(int c = 0; c < 3; c++) mean[c] += block[i*4 + c];
+        }
+        for(int c = 0; c < 3; c++) mean[c] /= 16.0f;
+
+        float cov[6] = {0.0f};
+        for(int i = 0; i < 16; i++){
+            float r = block[i*4 + 0] - mean[0];
+            float g = block[i*4 + 1] - mean[1];
+            float b = block[i*4 + 2] - mean[2];
+            cov[0] += r*r; cov[1] += r*g; cov[2] += r*b;
+            cov[3] += g*g; cov[4] += g*b; cov[5] += b*b;
+        }
+
+        // Power iteration for the principal axis
+        float axis[3] = {1.0f, 1.0f, 1.0f};
+        for(int iteration = 0; iteration < 8; iteration++){
+            float x = cov[0]*axis[0] + cov[1]*axis[1] + cov[2]*axis[2];
+            float y = cov[1]*axis[0] + cov[3]*axis[1] + cov[4]*axis[2];
+            float z = cov[2]*axis[0] + cov[4]*axis[1] + cov[5]*axis[2];
+            float length = std::max({std::fabs(x), std::fabs(y), std::fabs(z)});
+            if(length == 0.0f) break;
+            axis[0] = x/length; axis[1] = y/length; axis[2] = z/length;
+        }
+
+        float minT = 0.0f, maxT = 0.0f;
+        float axisLengthSq = axis[0]*axis[0] + axis[1]*axis[1] + axis[2]*axis[2];
+        for(int i = 0; i < 16; i++){
+            float t =
+                (block[i*4 + 0] - mean[0]) * axis[0] +
+                (block[i*4 + 1] - mean[1]) * axis[1] +
+                (block[i*4 + 2] - mean[2]) * axis[2];
+            t /= axisLengthSq;
+            minT = std::min(minT, t);
+            maxT = std::max(maxT, t);
+        }
+
+        float end0[3], end1[3];
+        for(int c = 0; c < 3; c++){
+            end0[c] = mean[c] + axis[c] * maxT;
+            end1[c] = mean[c] + axis[c] * minT;
+        }
+        uint16_t c0 = to565(end0);
+        uint16_t c1 = to565(end1);
+        if(c0 < c1) std::swap(c0, c1);
+
+        uint32_t indices = 0;
+        if(c0 != c1){
+            float palette[4][3];
+            from565(c0, palette[0]);
+            from565(c1, palette[1]);
+            for(int c = 0; c < 3; c++){
+                palette[2][c] = (2.0f*palette[0][c] + palette[1][c]) / 3.0f;
+                palette[3][c] = (palette[0][c] + 2.0f*palette[1][c]) / 3.0f;
+            }
+            for(int i = 0; i < 16; i++){
+                uint32_t best = 0;
+                float bestError = INFINITY;
+                for(uint32_t p = 0; p < 4; p++){
+                    float error = 0.0f;
+                    for(int c = 0; c < 3; c++){
+                        float d = block[i*4 + c] - palette[p][c];
+                        error += d*d;
+                    }
+                    if(error < bestError){
+                        bestError = error;
+                        best = p;
+                    }
+                }
+                indices |= best << (i*2);
+            }
+        }
+        // c0 == c1 selects 3 color mode, index 0 is still c0
+
+        out[0] = uint8_t(c0 & 0xff); out[1] = uint8_t(c0 >> 8);
+        out[2] = uint8_t(c1 & 0xff); out[3] = uint8_t(c1 >> 8);
+        memcpy(out + 4, &indices, 4);
+    }
+
+    // Single channel block in 8 value mode, channel selects the RGBA component
+    inline void encodeBC4(const uint8_t block[64], int channel, uint8_t out[8]){
+        uint8_t minValue = 255, maxValue = 0;
+        for(int i = 0; i < 16; i++){
+            minValue = std::min(minValue, block[i*4 + channel]);
+            maxValue = std::max(maxValue, block[i*4 + channel]);
+        }
+
+        out[0] = maxValue;
+        out[1] = minValue;
+        uint64_t indices = 0;
+        if(maxValue != minValue){
+            float range = float(maxValue - minValue);
+            for(int i = 0; i < 16; i++){
+                // Level 0 is the minimum, 7 the maximum
+                float t = float(block[i*4 + channel] - minValue) / range;
+                uint64_t level = static_cast<uint64_t>(t * 7.0f + 0.5f);
+                uint64_t index = level == 7 ? 0 : level == 0 ? 1 : 8 - level;
+                indices |= index << (i*3);
+            }
+        }
+        for(int i = 0; i < 6; i++) out[2 + i] = uint8_t(indices >> (i*8));
+    }
+
+    inline void encodeBC3(const uint8_t block[64], uint8_t out[16]){
+        encodeBC4(block, 3, out);
+        encodeBC1(block, out + 8);
+    }
+    inline void encodeBC5(const uint8_t block[64], uint8_t out[16]){
+        encodeBC4(block, 0, out);
+        encodeBC4(block, 1, out + 8);
+    }
+} // namespace bc
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file
@@ -0,0 +1,312 @@
+#include <shard/gfx/ktx2.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <algorithm>
+#include <vector>
+#include <fstream>
+#include <iostream>
+
+#include <stb_image.h>
+
+#include "bc.hpp"
+
+// Builds KTX2 files with block compressed, precomputed mip chains from PNG/JPG/TGA images
+//
+// usage: texcompress <input> <output.ktx2> [--format auto|bc1|bc3|bc4|bc5|rgba8] [--linear] [--no-mips]
+
+using namespace shard;
+
+enum class Format{ AUTO, BC1, BC3, BC4, BC5, RGBA8 };
+
+struct Level{
+    uint32_t width, height;
+    std::vector<float> texels; // linear RGBA
+};
+
+float srgbToLinear(float c){
+    return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+float linearToSrgb(float c){
+    return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+}
+
+// 2x2 box filter, odd edges repeat the last texel
+Level downsample(const Level& src){
+    Level dst;
+    dst.width = std::max(src.width / 2, 1u);
+    dst.height = std::max(src.height / 2, 1u);
+    dst.texels.resize(size_t(dst.width) * dst.height * 4);
+
+    for(uint32_t y = 0; y < dst.height; y++){
+        for(uint32_t x = 0; x < dst.width; x++){
+            for(uint32_t c = 0; c < 4; c++){
+                float sum = 0.0f;
+                for(uint32_t j = 0; j < 2; j++){
+                    for(uint32_t i = 0; i < 2; i++){
+                        uint32_t sx = std::min(x*2 + i, src.width - 1);
+                        uint32_t sy = std::min(y*2 + j, src.height - 1);
+                        sum += src.texels[(size_t(sy) * src.width + sx) * 4 + c];
+                    }
+                }
+                dst.texels[(size_t(y) * dst.width + x) * 4 + c] = sum * 0.25f;
+            }
+        }
+    }
+    return dst;
+}
+
+std::vector<uint8_t> quantize(const Level& level, bool srgb){
+    std::vector<uint8_t> rgba(level.texels.size());
+    for(size_t i = 0; i < rgba.size(); i++){
+        float v = level.texels[i];
+        if(srgb && i % 4 != 3) v = linearToSrgb(v);
+        rgba[i] = static_cast<uint8_t>(std::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+    return rgba;
+}
+
+std::vector<uint8_t> encodeLevel(const Level& level, Format format, bool srgb){
+    std::vector<uint8_t> rgba = quantize(level, srgb);
+    if(format == Format::RGBA8) return rgba;
+
+    uint32_t blockSize = (format == Format::BC1 || format == Format::BC4) ? 8 : 16;
+    uint32_t blocksX = (level.width + 3) / 4;
+    uint32_t blocksY = (level.height + 3) / 4;
+    std::vector<uint8_t> out(size_t(blocksX) * blocksY * blockSize);
+
+    uint8_t block[64];
+    for(uint32_t by = 0; by < blocksY; by++){
+        for(uint32_t bx = 0; bx < blocksX; bx++){
+            // Partial blocks repeat the edge texels
+            for(uint32_t j = 0; j < 4; j++){
+                for(uint32_t i = 0; i < 4; i++){
+                    uint32_t x = std::min(bx*4 + i, level.width - 1);
+                    uint32_t y = std::min(by*4 + j, level.height - 1);
+                    memcpy(block + (j*4 + i)*4, rgba.data() + (size_t(y) * level.width + x) * 4, 4);
+                }
+            }
+
+            uint8_t* dst = out.data() + (size_t(by) * blocksX + bx) * blockSize;
+            switch(format){
+                case Format::BC1: bc::encodeBC1(block, dst); break;
+                case Format::BC3: bc::encodeBC3(block, dst); break;
+                case Format::BC4: bc::encodeBC4(block, 0, dst); break;
+                case Format::BC5: bc::encodeBC5(block, dst); break;
+                default: break;
+            }
+        }
+    }
+    return out;
+}
+
+VkFormat vkFormat(Format format, bool srgb){
+    switch(format){
+        case Format::BC1:   return srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+        case Format::BC3:   return srgb ? VK_FORMAT_BC3_SRGB_BLOCK     : VK_FORMAT_BC3_UNORM_BLOCK;
+        case Format::BC4:   return VK_FORMAT_BC4_UNORM_BLOCK;
+        case Format::BC5:   return VK_FORMAT_BC5_UNORM_BLOCK;
+        case Format::RGBA8: return srgb ? VK_FORMAT_R8G8B8A8_SRGB      : VK_FORMAT_R8G8B8A8_UNORM;
+        default:            return VK_FORMAT_UNDEFINED;
+    }
+}
+
+// Basic data format descriptor, required by the KTX2 spec
+std::vector<uint32_t> buildDfd(Format format, bool srgb){
+    struct Sample{
+        uint32_t bitOffset, bitLength;
+        uint8_t channel;
+        uint32_t upper;
+    };
+    constexpr uint8_t CHANNEL_ALPHA = 15;
+    constexpr uint8_t QUALIFIER_LINEAR = 0x10;
+
+    uint32_t colorModel;
+    uint32_t blockDim;
+    uint32_t bytesPlane;
+    std::vector<Sample> samples;
+    switch(format){
+        case Format::BC1:
+            colorModel = 128; blockDim = 3; bytesPlane = 8;
+            samples = {{0, 64, 0, UINT32_MAX}};
+            break;
+        case Format::BC3:
+            colorModel = 130; blockDim = 3; bytesPlane = 16;
+            samples = {{0, 64, CHANNEL_ALPHA, UINT32_MAX}, {64, 64, 0, UINT32_MAX}};
+            break;
+        case Format::BC4:
+            colorModel = 131; blockDim = 3; bytesPlane = 8;
+            samples = {{0, 64, 0, UINT32_MAX}};
+            break;
+        case Format::BC5:
+            colorModel = 132; blockDim = 3; bytesPlane = 16;
+            samples = {{0, 64, 0, UINT32_MAX}, {64, 64, 1, UINT32_MAX}};
+            break;
+        default:
+            colorModel = 1; blockDim = 0; bytesPlane = 4;
+            samples = {{0, 8, 0, 255}, {8, 8, 1, 255}, {16, 8, 2, 255}, {24, 8, CHANNEL_ALPHA, 255}};
+            break;
+    }
+
+    uint32_t blockSize = 24 + 16 * uint32_t(samples.size());
+    std::vector<uint32_t> dfd;
+    dfd.push_back(4 + blockSize);                               // total size
+    dfd.push_back(0);                                           // vendor Khronos, basic descriptor
+    dfd.push_back(2 | blockSize << 16);                         // version 1.3, block size
+    dfd.push_back(colorModel | 1 << 8 | (srgb ? 2 : 1) << 16);  // BT.709 primaries, transfer
+    dfd.push_back(blockDim | blockDim << 8);                    // texel block dimensions - 1
+    dfd.push_back(bytesPlane);
+    dfd.push_back(0);
+    for(const auto& sample : samples){
+        uint8_t channelType = sample.channel;
+        if(srgb && sample.channel == CHANNEL_ALPHA) channelType |= QUALIFIER_LINEAR;
+        dfd.push_back(sample.bitOffset | (sample.bitLength - 1) << 16 | uint32_t(channelType) << 24);
+        dfd.push_back(0);
+        dfd.push_back(0);
+        dfd.push_back(sample.upper);
+    }
+    return dfd;
+}
+
+bool writeKtx2(
+    const char* filePath, Format format, bool srgb,
+    uint32_t width, uint32_t height,
+    const std::vector<std::vector<uint8_t>>& levels
+){
+    uint32_t levelCount = static_cast<uint32_t>(levels.size());
+    std::vector<uint32_t> dfd = buildDfd(format, srgb);
+    uint32_t alignment = (format == Format::BC1 || format == Format::BC4) ? 8 :
+                         (format == Format::RGBA8) ? 4 : 16;
+
+    gfx::ktx2::Header header = {};
+    memcpy(header.identifier, gfx::ktx2::IDENTIFIER, sizeof(header.identifier));
+    header.vkFormat = vkFormat(format, srgb);
+    header.typeSize = 1;
+    header.pixelWidth = width;
+    header.pixelHeight = height;
+    header.faceCount = 1;
+    header.levelCount = levelCount;
+    header.dfdByteOffset = static_cast<uint32_t>(
+        sizeof(gfx::ktx2::Header) + levelCount * sizeof(gfx::ktx2::LevelIndex)
+    );
+    header.dfdByteLength = static_cast<uint32_t>(dfd.size() * sizeof(uint32_t));
+
+    // Levels are stored smallest first
+    std::vector<gfx::ktx2::LevelIndex> index(levelCount);
+    uint64_t offset = header.dfdByteOffset + header.dfdByteLength;
+    for(uint32_t i = levelCount; i-- > 0;){
+        offset = (offset + alignment - 1) / alignment * alignment;
+        index[i].byteOffset = offset;
+        index[i].byteLength = levels[i].size();
+        index[i].uncompressedByteLength = levels[i].size();
+        offset += levels[i].size();
+    }
+
+    std::ofstream fp(filePath, std::ios::binary);
+    if(!fp.is_open()) return false;
+
+    std::vector<uint8_t> file(offset, 0);
+    memcpy(file.data(), &header, sizeof(header));
+    memcpy(file.data() + sizeof(header), index.data(), index.size() * sizeof(gfx::ktx2::LevelIndex));
+    memcpy(file.data() + header.dfdByteOffset, dfd.data(), header.dfdByteLength);
+    for(uint32_t i = 0; i < levelCount; i++){
+        memcpy(file.data() + index[i].byteOffset, levels[i].data(), levels[i].size());
+    }
+    fp.write(reinterpret_cast<const char*>(file.data()), file.size());
+    return fp.good();
+}
+
+int main(int argc, char** argv){
+    if(argc < 3){
+        std::cerr << "usage: " << argv[0]
+                  << " <input> <output.ktx2> [--format auto|bc1|bc3|bc4|bc5|rgba8] [--linear] [--no-mips]\n";
+        return 1;
+    }
+
+    Format format = Format::AUTO;
+    bool srgb = true;
+    bool mips = true;
+    for(int i = 3; i < argc; i++){
+        std::string arg = argv[i];
+        if(arg == "--linear") srgb = false;
+        else if(arg == "--no-mips") mips = false;
+        else if(arg == "--format" && i + 1 < argc){
+            std::string name = argv[++i];
+            if(name == "auto") format = Format::AUTO;
+            else if(name == "bc1") format = Format::BC1;
+            else if(name == "bc3") format = Format::BC3;
+            else if(name == "bc4") format = Format::BC4;
+            else if(name == "bc5") format = Format::BC5;
+            else if(name == "rgba8") format = Format::RGBA8;
+            else{
+                std::cerr << "Unknown format " << name << "\n";
+                return 1;
+            }
+        } else{
+            std::cerr << "Unknown argument " << arg << "\n";
+            return 1;
+        }
+    }
+
+    int w, h, channels;
+    stbi_uc* pixels = stbi_load(argv[1], &w, &h, &channels, STBI_rgb_alpha);
+    if(!pixels){
+        std::cerr << "Failed to load " << argv[1] << "\n";
+        return 1;
+    }
+
+    // Single and dual channel data is never color
+    if(format == Format::BC4 || format == Format::BC5) srgb = false;
+
+    Level base;
+    base.width = uint32_t(w);
+    base.height = uint32_t(h);
+    base.texels.resize(size_t(w) * size_t(h) * 4);
+    bool opaque = true;
+    for(size_t i = 0; i < base.texels.size(); i++){
+        float v = pixels[i] / 255.0f;
+        if(i % 4 == 3) opaque = opaque && pixels[i] == 255;
+        else if(srgb) v = srgbToLinear(v);
+        base.texels[i] = v;
+    }
+    stbi_image_free(pixels);
+
+    if(format == Format::AUTO) format = opaque ? Format::BC1 : Format::BC3;
+
+    uint32_t levelCount = mips ? calculateMipmapLevels(base.width, base.height) : 1;
+    std::vector<std::vector<uint8_t>> encoded;
+    size_t encodedSize = 0;
+    Level level = std::move(base);
+    for(uint32_t i = 0; i < levelCount; i++){
+        if(i > 0) level = downsample(level);
+        encoded.push_back(encodeLevel(level, format, srgb));
+        encodedSize += encoded.back().size();
+    }
+
+    if(!writeKtx2(argv[2], format, srgb, uint32_t(w), uint32_t(h), encoded)){
+        std::cerr << "Failed to write " << argv[2] << "\n";
+        return 1;
+    }
+
+    size_t rgbaSize = size_t(w) * size_t(h) * 4;
+    std::cout << argv[2] << ": " << w << "x" << h << ", " << levelCount << " levels, "
+              << encodedSize << " bytes (level 0 RGBA8 is " << rgbaSize << " bytes)\n";
+    return 0;
+}
+
+/**
+    Copyright 2022 Nongus Studios (https://github.com/NongusStudios/shard)
+    
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+    
+        http://www.apache.org/licenses/LICENSE-2.0
+    
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
\ No newline at end of file